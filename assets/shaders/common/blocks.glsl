@@ -0,0 +1,23 @@
+// std140 blocks shared with render/ubo.h, same bindings on GL and Vulkan (set 0)
+layout(std140, binding = 0) uniform FrameBlock
+{
+    float time;
+    float deltaTime;
+    uint  frameIndex;
+} uFrame;
+
+layout(std140, binding = 1) uniform ViewBlock
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPos;
+} uView;
+
+layout(std140, binding = 2) uniform ObjectBlock
+{
+    mat4 model;
+    mat4 mvp;
+    mat4 normalMatrix;
+    vec4 color;
+} uObject;
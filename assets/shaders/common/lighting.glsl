@@ -0,0 +1,9 @@
+// Lighting helpers shared by the forward shaders
+
+const vec3 kLightDir = vec3(0.57735, 0.57735, 0.57735);
+
+vec3 lambert(vec3 normal, vec3 albedo)
+{
+    float diffuse = max(dot(normalize(normal), kLightDir), 0.0);
+    return (0.3 + 0.7 * diffuse) * albedo;
+}
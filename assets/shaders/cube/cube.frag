@@ -1,19 +1,21 @@
 #version 450
 
+#pragma coda_feature(LIT)
+
 in vec3 fragPos;
 in vec3 fragNormal;
 in vec3 fragColor;
 
-// /layout(binding = 0) uniform UniformBufferObject 
-// /{
-// mat4 uMVP;
-// mat4 uModel;
-// /} ubo;
-
 uniform sampler2D texSampler;
 
 out vec4 outColor;
 
+#include "../common/lighting.glsl"
+
 void main() {
+#ifdef LIT
+    outColor = vec4(lambert(fragNormal, fragColor), 1.0);
+#else
     outColor = vec4(fragColor, 1.0);
+#endif
 }
\ No newline at end of file
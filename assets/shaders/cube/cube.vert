@@ -1,25 +1,56 @@
 #version 450
 
+#pragma coda_feature(INSTANCED)
+#pragma coda_feature(INDIRECT)
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec3 inColor;
 
-//layout(binding = 0) uniform UniformBufferObject
-//{
-//    mat4 uMVP;
-//    mat4 uModel;
-//} ubo;
+#ifdef INSTANCED
+// Per instance, streamed by render/instance.c
+layout(location = 8)  in mat4 inModel;
+layout(location = 12) in vec4 inInstanceColor;
+#elif defined(INDIRECT)
+// Per draw, render/indirect.c passes the draw index as baseInstance
+layout(location = 13) in uint inDrawIndex;
+
+struct DrawData
+{
+    mat4 model;
+    vec4 color;
+};
+
+layout(std430, binding = 0) readonly buffer DrawBlock
+{
+    DrawData uDraws[];
+};
+#endif
 
-uniform mat4 uMVP;
-uniform mat4 uModel;
+#include "../common/blocks.glsl"
 
 out vec3 fragPos;
 out vec3 fragNormal;
 out vec3 fragColor;
 
 void main() {
-    gl_Position = uMVP * vec4(inPosition, 1.0);
-    fragPos = vec3(uModel * vec4(inPosition, 1.0));
-    fragNormal = mat3(uModel) * inNormal;
-    fragColor = inColor;
+#if defined(INSTANCED) || defined(INDIRECT)
+#ifdef INSTANCED
+    mat4 model = inModel;
+    vec4 tint = inInstanceColor;
+#else
+    mat4 model = uDraws[inDrawIndex].model;
+    vec4 tint = uDraws[inDrawIndex].color;
+#endif
+    vec4 worldPos = model * vec4(inPosition, 1.0);
+    gl_Position = uView.viewProjection * worldPos;
+    fragPos = worldPos.xyz;
+    fragNormal = mat3(model) * inNormal;
+    fragColor = inColor * tint.rgb;
+#else
+    gl_Position = uObject.mvp * vec4(inPosition, 1.0);
+    fragPos = vec3(uObject.model * vec4(inPosition, 1.0));
+    fragNormal = mat3(uObject.normalMatrix) * inNormal;
+    fragColor = inColor * uObject.color.rgb;
+#endif
 }
\ No newline at end of file
@@ -30,6 +30,7 @@ OBJ_DIR="$BUILD_DIR/obj"
 DEP_DIR="$BUILD_DIR/deps"
 LIB_DIR="$BUILD_DIR/lib"
 BIN_DIR="$BUILD_DIR/bin"
+SHADER_DIR="assets/shaders"
 
 ################################################################################################################
 
@@ -153,6 +154,44 @@ compile_source() {
 
 ################################################################################################################
 
+# Vulkan reads SPIR-V, rebuilt from the GLSL next to it whenever a stage or a shared include is newer
+compile_shaders() {
+    local compiler
+    compiler=$(command -v glslc || true)
+
+    if [ -z "$compiler" ]; then
+        print "${RED}Error: glslc not found, it is needed to build SPIR-V for the Vulkan renderer${RESET}"
+        exit 1
+    fi
+
+    print "${BLUE}${BOLD}Compiling shaders...${RESET}"
+
+    local stage spv
+    while IFS= read -r stage; do
+        spv="$stage.spv"
+
+        if [ -f "$spv" ] && [ "$spv" -nt "$stage" ] && \
+           [ -z "$(find "$SHADER_DIR/common" -newer "$spv" 2>/dev/null)" ]; then
+            print "${GREEN}Cached${RESET} ${stage#$SHADER_DIR/}"
+            continue
+        fi
+
+        print "${YELLOW}Compile${RESET} ${stage#$SHADER_DIR/}"
+
+        # The GLSL targets GL, locations and bindings it leaves implicit are assigned here
+        if ! "$compiler" --target-env=vulkan1.0 -fauto-map-locations -fauto-bind-uniforms \
+                "$stage" -o "$spv"; then
+            print "${RED}${BOLD}✗ Shader compilation failed: $stage${RESET}"
+            exit 1
+        fi
+    done < <(find "$SHADER_DIR" -type f \( -name "*.vert" -o -name "*.frag" \))
+
+    print "${GREEN}${BOLD}✓ All shaders compiled${RESET}"
+    print
+}
+
+################################################################################################################
+
 print
 print "${CYAN}${BOLD}════════════════════════════════════════${RESET}"
 print "${CYAN}${BOLD}     Coda Build System${RESET}"
@@ -175,6 +214,10 @@ if [ ! -d "$SRC_DIR" ]; then
     exit 1
 fi
 
+if [ "$GLX" = "Vulkan" ]; then
+    compile_shaders
+fi
+
 # Compile all sources
 print "${BLUE}${BOLD}Compiling source files...${RESET}"
 
@@ -5,7 +5,24 @@
 #include <core/debug.h>
 #include <core/types.h>
 #include <core/math.h>
+#include <core/memory.h>
+#include <core/arena.h>
+#include <core/profiler.h>
+#include <core/recorder.h>
+#include <core/strid.h>
 #include <render/shader.h>
+#include <render/gpu_timer.h>
+#include <render/resource.h>
+#include <render/ubo.h>
+#include <render/instance.h>
+#include <render/indirect.h>
+#include <render/shader_cache.h>
+#include <render/shader_variant.h>
+#include <render/prewarm.h>
+#include <render/hot_reload.h>
+#include <render/shader_source.h>
+#include <render/gl_state.h>
+#include <render/gl_debug.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -24,6 +41,7 @@
 static struct
 {
     u8 EventsInitialized;
+    u8 ProfilerInitialized;
     u8 WindowInitialized;
     u8 CallbacksRegistered;
     u8 RenderInitialized;
@@ -31,20 +49,16 @@ static struct
 
 static struct
 {
-    Shader*        shader;
+    ShaderHandle   shader;
     ShaderLibrary* shaderLib;
+    ShaderVariantSet* cubeVariants;
+    ShaderFeatureMask instancedMask;
+    ShaderFeatureMask indirectMask;
+    MeshHandle     cube;
+    u32            indirectCube;
     
-    #ifdef GLX_OPENGL
-    u32 vao;
-    u32 vbo;
-    u32 ebo;
-    #elif defined(GLX_VULKAN)
+    #ifdef GLX_VULKAN
     /* Vulkan resources */
-    VkBuffer       vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
-    VkBuffer       indexBuffer;
-    VkDeviceMemory indexBufferMemory;
-    
     VkCommandBuffer commandBuffer;
     VkSemaphore     imageAvailableSemaphore;
     VkSemaphore     renderFinishedSemaphore;
@@ -52,6 +66,8 @@ static struct
     #endif
 
     f32 dt;
+    f32 time;
+    u64 lastFrameTime;
     
 } RenderState = {0};
 
@@ -111,6 +127,23 @@ static u32 cubeIndices[] = {
     20, 21, 22,  22, 23, 20   /* Inferior */
 };
 
+static MeshDesc coda_CubeMeshDesc(void)
+{
+    MeshDesc desc = {0};
+    desc.vertices    = cubeVertices;
+    desc.vertexCount = sizeof(cubeVertices) / sizeof(cubeVertices[0]);
+    desc.indices     = cubeIndices;
+    desc.indexCount  = sizeof(cubeIndices) / sizeof(cubeIndices[0]);
+
+    /* 0: Posição, 1: Normal, 2: Cor */
+    desc.layout.stride = sizeof(Vertex);
+    desc.layout.count  = 3;
+    desc.layout.attributes[0] = (VertexAttribute){ 0, 3, offsetof(Vertex, position) };
+    desc.layout.attributes[1] = (VertexAttribute){ 1, 3, offsetof(Vertex, normal) };
+    desc.layout.attributes[2] = (VertexAttribute){ 2, 3, offsetof(Vertex, color) };
+    return desc;
+}
+
 #define RESOLUTION_W 1920 
 #define RESOLUTION_H 1044
 
@@ -184,60 +217,7 @@ extern VkQueue vk_get_graphics_queue(void);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/* Find memory type */
-static u32 vk_find_memory_type(u32 typeFilter, VkMemoryPropertyFlags properties)
-{
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(vk_get_physical_device(), &memProperties);
-    
-    for (u32 i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) &&
-            (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
-    }
-    
-    LOG_ERROR("Failed to find suitable memory type!");
-    return 0;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/* Create buffer */
-static u8 vk_create_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
-    VkMemoryPropertyFlags properties,
-    VkBuffer* buffer, VkDeviceMemory* bufferMemory)
-{
-    VkDevice device = vk_get_device();
-    
-    VkBufferCreateInfo bufferInfo = {0};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size;
-    bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    
-    if (vkCreateBuffer(device, &bufferInfo, NULL, buffer) != VK_SUCCESS) {
-        LOG_ERROR("Failed to create Vulkan buffer!");
-        return 0;
-    }
-    
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, *buffer, &memRequirements);
-    
-    VkMemoryAllocateInfo allocInfo = {0};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = vk_find_memory_type(memRequirements.memoryTypeBits, properties);
-    
-    if (vkAllocateMemory(device, &allocInfo, NULL, bufferMemory) != VK_SUCCESS) {
-        LOG_ERROR("Failed to allocate Vulkan buffer memory!");
-        return 0;
-    }
-    
-    vkBindBufferMemory(device, *buffer, *bufferMemory, 0);
-    
-    return 1;
-}
+/* Buffers go through vk_create_buffer / vk_copy_buffer in platform/glx/vulkan/helpers.c */
 
 #endif /* GLX_VULKAN */
 
@@ -246,46 +226,24 @@ static u8 vk_create_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
 #ifdef GLX_OPENGL
 static u8 coda_InitOpenGL(void)
 {
-    /* Habilita depth test */
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    
-    /* Face culling */
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
-    
-    /* Cria VAO */
-    glGenVertexArrays(1, &RenderState.vao);
-    glBindVertexArray(RenderState.vao);
-    
-    /* Cria VBO */
-    glGenBuffers(1, &RenderState.vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, RenderState.vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
-    
-    /* Cria EBO */
-    glGenBuffers(1, &RenderState.ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, RenderState.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeIndices), cubeIndices, GL_STATIC_DRAW);
-    
-    /* Atributo 0: Posição */
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-    glEnableVertexAttribArray(0);
-    
-    /* Atributo 1: Normal */
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-    glEnableVertexAttribArray(1);
-    
-    /* Atributo 2: Cor */
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
-    glEnableVertexAttribArray(2);
+    /* Driver messages arrive through the callback on debug contexts, nothing is polled */
+    renderer_GlDebugInit();
+
+    /* Depth test e face culling */
+    RenderStateDesc opaque = RENDER_STATE_OPAQUE;
+    renderer_ResourceApplyState(&opaque);
     
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    /* Cria VAO, VBO e EBO */
+    MeshDesc desc = coda_CubeMeshDesc();
+    RenderState.cube = renderer_ResourceMeshCreate(&desc);
+    if (RESOURCE_HANDLE_IS_NULL(RenderState.cube)) {
+        return False;
+    }
     
-    LOG_INFO("OpenGL resources created (VAO: %u, VBO: %u, EBO: %u)",
-        RenderState.vao, RenderState.vbo, RenderState.ebo);
+    const MeshResource* mesh = renderer_ResourceMeshGet(RenderState.cube);
+    LOG_INFO("OpenGL resources created (VAO: %u, VBO: %u, EBO: %u)", mesh->vao,
+        renderer_ResourceBufferGet(mesh->vertexBuffer)->glName,
+        renderer_ResourceBufferGet(mesh->indexBuffer)->glName);
     
     return True;
 }
@@ -300,85 +258,17 @@ static u8 coda_InitVulkan(void)
     
     LOG_INFO("Initializing Vulkan resources...");
     
-    /* 1. Cria Vertex Buffer */
-    VkDeviceSize vertexBufferSize = sizeof(cubeVertices);
-    
-    /* Staging buffer (CPU -> GPU) */
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    
-    if (!vk_create_buffer(vertexBufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &stagingBuffer, &stagingBufferMemory))
-    {
-        LOG_ERROR("Failed to create vertex staging buffer!");
-        return False;
-    }
-    
-    /* Copia dados para staging buffer */
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, vertexBufferSize, 0, &data);
-    memcpy(data, cubeVertices, (size_t)vertexBufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
-    
-    /* Cria vertex buffer final (device local - mais rápido) */
-    if (!vk_create_buffer(vertexBufferSize,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        &RenderState.vertexBuffer, &RenderState.vertexBufferMemory))
-    {
-        LOG_ERROR("Failed to create vertex buffer!");
-        vkDestroyBuffer(device, stagingBuffer, NULL);
-        vkFreeMemory(device, stagingBufferMemory, NULL);
-        return False;
-    }
-    
-    /* Copy staging -> device local (você precisa implementar copy_buffer) */
-    /* vk_copy_buffer(stagingBuffer, RenderState.vertexBuffer, vertexBufferSize); */
-    
-    /* Cleanup staging */
-    vkDestroyBuffer(device, stagingBuffer, NULL);
-    vkFreeMemory(device, stagingBufferMemory, NULL);
-    
-    LOG_INFO("Vertex buffer created");
-    
-    /* 2. Cria Index Buffer */
-    VkDeviceSize indexBufferSize = sizeof(cubeIndices);
-    
-    if (!vk_create_buffer(indexBufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &stagingBuffer, &stagingBufferMemory))
-    {
-        LOG_ERROR("Failed to create index staging buffer!");
-        return False;
-    }
-    
-    vkMapMemory(device, stagingBufferMemory, 0, indexBufferSize, 0, &data);
-    memcpy(data, cubeIndices, (size_t)indexBufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
-    
-    if (!vk_create_buffer(indexBufferSize,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        &RenderState.indexBuffer, &RenderState.indexBufferMemory))
-    {
-        LOG_ERROR("Failed to create index buffer!");
-        vkDestroyBuffer(device, stagingBuffer, NULL);
-        vkFreeMemory(device, stagingBufferMemory, NULL);
+    /* 1. Cria Vertex e Index Buffers (staging -> device local) */
+    MeshDesc desc = coda_CubeMeshDesc();
+    RenderState.cube = renderer_ResourceMeshCreate(&desc);
+    if (RESOURCE_HANDLE_IS_NULL(RenderState.cube)) {
+        LOG_ERROR("Failed to create cube buffers!");
         return False;
     }
     
-    /* Copy staging -> device local */
-    /* vk_copy_buffer(stagingBuffer, RenderState.indexBuffer, indexBufferSize); */
-    
-    vkDestroyBuffer(device, stagingBuffer, NULL);
-    vkFreeMemory(device, stagingBufferMemory, NULL);
+    LOG_INFO("Vertex and index buffers created");
     
-    LOG_INFO("Index buffer created");
-    
-    /* 3. Cria Semaphores e Fences */
+    /* 2. Cria Semaphores e Fences */
     VkSemaphoreCreateInfo semaphoreInfo = {0};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
     
@@ -405,8 +295,57 @@ static u8 coda_InitVulkan(void)
 
 #define PI		3.14159265358979323846	/* pi */
 
+/* Floor of small cubes under the main one, all drawn with a single instanced call */
+#define INSTANCE_GRID         64
+#define INSTANCE_GRID_SPACING 0.25f
+
+/* Ring of cubes around the main one, queued as indirect commands and submitted in one call */
+#define INDIRECT_RING        256
+#define INDIRECT_RING_RADIUS 2.5f
+
 static Mat4 model;
 
+/* Every instance shares the spin of the main cube, only the translation and the tint differ */
+static u32 coda_FillInstanceGrid(u32* first)
+{
+    const u32 count = INSTANCE_GRID * INSTANCE_GRID;
+
+    InstanceData* data = renderer_InstanceReserve(count, first);
+    if (!data) return 0;
+
+    Mat4 spin = core_MathMat4Multiply(core_MathMat4Scale(core_MathVec3Create(0.15f, 0.15f, 0.15f)), model);
+    f32  half = (INSTANCE_GRID - 1) * INSTANCE_GRID_SPACING * 0.5f;
+
+    for (u32 z = 0; z < INSTANCE_GRID; z++) {
+        for (u32 x = 0; x < INSTANCE_GRID; x++) {
+            InstanceData* instance = &data[z * INSTANCE_GRID + x];
+            instance->model = spin;
+            instance->model.m[12] = x * INSTANCE_GRID_SPACING - half;
+            instance->model.m[13] = -1.5f;
+            instance->model.m[14] = z * INSTANCE_GRID_SPACING - half * 2.0f + 2.0f;
+            instance->color = core_MathVec4Create((f32)x / INSTANCE_GRID, 0.6f, (f32)z / INSTANCE_GRID, 1.0f);
+        }
+    }
+    return count;
+}
+
+/* Each draw has its own transform, a heterogeneous scene would also pick a different mesh per draw */
+static void coda_PushIndirectRing(void)
+{
+    for (u32 i = 0; i < INDIRECT_RING; i++) {
+        f32 angle = (f32)i / INDIRECT_RING * 2.0f * PI + RenderState.time * 0.25f;
+
+        IndirectDrawData draw;
+        draw.model = core_MathMat4Multiply(core_MathMat4Scale(core_MathVec3Create(0.08f, 0.08f, 0.08f)), model);
+        draw.model.m[12] = cosf(angle) * INDIRECT_RING_RADIUS;
+        draw.model.m[13] = sinf(angle * 3.0f) * 0.25f;
+        draw.model.m[14] = sinf(angle) * INDIRECT_RING_RADIUS - 2.0f;
+        draw.color = core_MathVec4Create(1.0f, (f32)i / INDIRECT_RING, 0.3f, 1.0f);
+
+        renderer_IndirectPush(RenderState.indirectCube, &draw);
+    }
+}
+
 static void coda_RenderFrame(void)
 {
 
@@ -431,43 +370,119 @@ static void coda_RenderFrame(void)
     f32 aspect = (f32)platform_WindowGetWidth() / platform_WindowGetHeight();
     Mat4 proj = core_MathMat4Perspective(45.0f * PI / 180.0f, aspect, 0.1f, 100.0f);
     
+    /* Per-frame and per-view blocks are written once, each object gets a slot in the uniform ring */
+    u64 now = core_ProfilerNow();
+    f32 deltaTime = RenderState.lastFrameTime ? (f32)((now - RenderState.lastFrameTime) * 1e-9) : 0.0f;
+    RenderState.lastFrameTime = now;
+    RenderState.time += deltaTime;
+
+    FrameBlock frame = {
+        .time       = RenderState.time,
+        .deltaTime  = deltaTime,
+        .frameIndex = (u32)core_ProfilerGetFrameIndex(),
+    };
+
+    ViewBlock viewBlock = {
+        .view           = view,
+        .projection     = proj,
+        .viewProjection = core_MathMat4Multiply(view, proj),
+        .cameraPos      = core_MathVec4Create(0.0f, 0.0f, 4.0f, 1.0f),
+    };
+
+    /* Rigid model, the rotation part is its own inverse transpose */
+    Mat4 normal = model;
+    normal.m[12] = normal.m[13] = normal.m[14] = 0.0f;
+
+    ObjectBlock object = {
+        .model        = model,
+        .mvp          = core_MathMat4Multiply(model, viewBlock.viewProjection),
+        .normalMatrix = normal,
+        .color        = core_MathVec4Create(1.0f, 1.0f, 1.0f, 1.0f),
+    };
+
+    renderer_UboBeginFrame(&frame);
+    renderer_UboSetView(&viewBlock);
+    u32 cubeObject = renderer_UboPushObject(&object);
+
+    renderer_InstanceBeginFrame();
+    renderer_IndirectBeginFrame();
+
     #ifdef GLX_OPENGL
+        renderer_GlDebugPushGroup("Clear");
+        renderer_GpuTimerBeginPass("Clear");
         glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        renderer_GpuTimerEndPass();
+        renderer_GlDebugPopGroup();
 
-        Mat4 vp = core_MathMat4Multiply(view, proj);
-        Mat4 mvp = core_MathMat4Multiply(model, vp);
-        
         /* Bind shader e define uniforms */
-        renderer_ShaderBind(RenderState.shader);
+        renderer_HotReloadUpdate(RenderState.shaderLib);
+        renderer_ShaderLibraryPoll(RenderState.shaderLib);
+        renderer_ShaderVariantPoll();
+        renderer_GlDebugPushGroup("Cube");
+        renderer_GpuTimerBeginPass("Cube");
+        renderer_ShaderBind(renderer_ResourceShaderGet(RenderState.shader));
+        renderer_UboBindObject(cubeObject);
         
-        renderer_ShaderSetMat4(RenderState.shader, "uMVP", &mvp);
-        renderer_ShaderSetMat4(RenderState.shader, "uModel", &model);
+        renderer_ResourceMeshDraw(RenderState.cube);
         
-        glBindVertexArray(RenderState.vao);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-        
-        renderer_ShaderUbind();
+        /* Program and VAO stay bound, next frame's binds are filtered by the state cache */
+        renderer_GpuTimerEndPass();
+        renderer_GlDebugPopGroup();
+
+        /* Skipped until the instanced variant links, the fallback does not read the instance attributes */
+        Shader* instanced = RenderState.instancedMask ?
+            renderer_ShaderVariantGet(RenderState.cubeVariants, RenderState.instancedMask) : NULL;
+        if (instanced && renderer_ShaderBind(instanced) == instanced) {
+            renderer_GlDebugPushGroup("Instances");
+            renderer_GpuTimerBeginPass("Instances");
+            u32 first;
+            u32 count = coda_FillInstanceGrid(&first);
+            renderer_InstanceDrawMesh(RenderState.cube, first, count);
+            renderer_GpuTimerEndPass();
+            renderer_GlDebugPopGroup();
+        }
+
+        Shader* indirect = RenderState.indirectMask ?
+            renderer_ShaderVariantGet(RenderState.cubeVariants, RenderState.indirectMask) : NULL;
+        if (indirect && renderer_ShaderBind(indirect) == indirect) {
+            renderer_GlDebugPushGroup("Indirect");
+            renderer_GpuTimerBeginPass("Indirect");
+            coda_PushIndirectRing();
+            renderer_IndirectSubmit();
+            renderer_GpuTimerEndPass();
+            renderer_GlDebugPopGroup();
+        }
     
     #elif defined(GLX_VULKAN)
         /* Aguarda frame anterior */
         vkWaitForFences(vk_get_device(), 1, &RenderState.inFlightFence, VK_TRUE, UINT64_MAX);
         vkResetFences(vk_get_device(), 1, &RenderState.inFlightFence);
         
-        /* Atualiza uniforms (UBO) */
-        renderer_ShaderSetMvp(RenderState.shader, &model, &view, &proj);
-        
         /* Acquire swapchain image */
         u32 imageIndex;
         /* vkAcquireNextImageKHR(..., RenderState.imageAvailableSemaphore, ..., &imageIndex); */
         
         /* Record command buffer */
         /* vkBeginCommandBuffer(RenderState.commandBuffer, ...); */
+        /* renderer_GpuTimerSetCommandBuffer(RenderState.commandBuffer); */
+        /* renderer_GpuTimerBeginPass("Cube"); */
         /* vkCmdBindPipeline(RenderState.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline); */
-        /* vkCmdBindVertexBuffers(RenderState.commandBuffer, 0, 1, &RenderState.vertexBuffer, offsets); */
-        /* vkCmdBindIndexBuffer(RenderState.commandBuffer, RenderState.indexBuffer, 0, VK_INDEX_TYPE_UINT32); */
+        /* renderer_UboSetCommandBuffer(RenderState.commandBuffer, shader->pipelineLayout); */
+        /* renderer_UboBindObject(cubeObject); */
+        /* const MeshResource* mesh = renderer_ResourceMeshGet(RenderState.cube); */
+        /* vkCmdBindVertexBuffers(RenderState.commandBuffer, 0, 1, &renderer_ResourceBufferGet(mesh->vertexBuffer)->buffer, offsets); */
+        /* vkCmdBindIndexBuffer(RenderState.commandBuffer, renderer_ResourceBufferGet(mesh->indexBuffer)->buffer, 0, VK_INDEX_TYPE_UINT32); */
         /* vkCmdDrawIndexed(RenderState.commandBuffer, 36, 1, 0, 0, 0); */
+        /* vkCmdBindPipeline(RenderState.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, instancedPipeline); */
+        /* renderer_InstanceSetCommandBuffer(RenderState.commandBuffer); */
+        /* u32 first; */
+        /* renderer_InstanceDrawMesh(RenderState.cube, first, coda_FillInstanceGrid(&first)); */
+        /* vkCmdBindPipeline(RenderState.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, indirectPipeline); */
+        /* renderer_IndirectSetCommandBuffer(RenderState.commandBuffer, indirectPipelineLayout); */
+        /* coda_PushIndirectRing(); */
+        /* renderer_IndirectSubmit(); */
+        /* renderer_GpuTimerEndPass(); */
         /* vkEndCommandBuffer(RenderState.commandBuffer); */
         
         /* Submit */
@@ -476,12 +491,21 @@ static void coda_RenderFrame(void)
         /* Present */
         /* vkQueuePresentKHR(..., RenderState.renderFinishedSemaphore, ...); */
         
+        UNUSED(cubeObject);
+        UNUSED(coda_FillInstanceGrid);
+        UNUSED(coda_PushIndirectRing);
         LOG_TRACE("Vulkan frame rendered");
     #endif
+
+    renderer_IndirectEndFrame();
+    renderer_InstanceEndFrame();
+    renderer_UboEndFrame();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#define FRAME_ARENA_SIZE MB(4)     /* GL staging of the uniform, instance and indirect rings, about 600 KB */
+
 void coda_load(void)
 {
     /* Eventos */
@@ -489,6 +513,23 @@ void coda_load(void)
         LOG_FATAL("Failed to initialize event system");
     }
     ClearUpState.EventsInitialized = True;
+
+    /* Profiler */
+    if (!core_ProfilerInit()) {
+        LOG_FATAL("Failed to initialize profiler");
+    }
+    ClearUpState.ProfilerInitialized = True;
+
+    /* Loading is profiled as its own frame, shader prewarm shows up there instead of on the first rendered one */
+    core_ProfilerBeginFrame();
+
+    /* Flight recorder, dumps a trace when a frame takes twice the median */
+    core_RecorderInit(NULL);
+
+    /* Per-frame temporary memory */
+    if (!core_ArenaFrameInit(FRAME_ARENA_SIZE)) {
+        LOG_FATAL("Failed to initialize frame arenas");
+    }
     
     core_EventRegisterCallback(EVENT_TYPE_KEYBOARD, onKeyboardEvent);
     core_EventRegisterCallback(EVENT_TYPE_WINDOW, onWindowEvent);
@@ -503,6 +544,11 @@ void coda_load(void)
     LOG_INFO("Name: %s", platform_WindowGetCaption());
     LOG_INFO("Window size: %dx%d", platform_WindowGetWidth(), platform_WindowGetHeight());
     
+    /* GPU resources are addressed through handles */
+    if (!renderer_ResourceInit()) {
+        LOG_FATAL("Failed to initialize resource tables!");
+    }
+    
     #ifdef GLX_OPENGL
         LOG_INFO("Render Backend: OpenGL");
         if (!coda_InitOpenGL()) {
@@ -517,35 +563,96 @@ void coda_load(void)
     
     ClearUpState.RenderInitialized = True;
 
+    /* GPU zones are optional, the engine runs without them */
+    renderer_GpuTimerInit();
+
+    /* Matrices reach the shaders through std140 blocks */
+    if (!renderer_UboInit()) {
+        LOG_FATAL("Failed to initialize uniform buffers!");
+    }
+
+    /* Per-instance transforms for the instanced floor, streamed like the uniform blocks */
+    if (!renderer_InstanceInit(INSTANCE_GRID * INSTANCE_GRID)) {
+        LOG_WARN("Instancing unavailable, the floor is not drawn");
+    }
+
+    /* Shared geometry for the indirect ring, the cube is copied in once */
+    MeshDesc ringDesc = coda_CubeMeshDesc();
+    RenderState.indirectCube = INDIRECT_MESH_INVALID;
+    if (renderer_IndirectInit(&ringDesc.layout, 1024, 4096, INDIRECT_RING)) {
+        RenderState.indirectCube = renderer_IndirectAddMesh(&ringDesc);
+    } else {
+        LOG_WARN("Multi-draw indirect unavailable, the ring is not drawn");
+    }
+
     /* Shaders */
+    core_MemorySetBudget(MEMORY_TAG_SHADER, MB(1));
+    #ifdef GLX_OPENGL
+        renderer_ShaderCacheInit(SHADER_CACHE_DEFAULT_DIR);
+    #endif
     RenderState.shaderLib = renderer_ShaderLibraryCreate();
 
+    Shader* shader = NULL;
+
     #ifdef GLX_OPENGL
         renderer_ShaderLibraryLoadDefaults(RenderState.shaderLib);
-        RenderState.shader = renderer_ShaderLoadFromFile("cube", 
+        Shader* basic = renderer_ShaderLibraryGetById(RenderState.shaderLib, SID("basic"));
+        renderer_ShaderSetFallback(basic);
+
+        /* Variants compile in the background, the cube draws with the basic shader until its variant links */
+        RenderState.cubeVariants = renderer_ShaderVariantLoadFromFile("cube", 
             "assets/shaders/cube/cube.vert", 
             "assets/shaders/cube/cube.frag");
+        RenderState.instancedMask = renderer_ShaderVariantMask(RenderState.cubeVariants, SID("INSTANCED"));
+        RenderState.indirectMask  = renderer_ShaderVariantMask(RenderState.cubeVariants, SID("INDIRECT"));
+
+        /* Every combination in the manifest is drawn once offscreen so the first visible frame does not hitch */
+        MeshDesc cubeDesc = coda_CubeMeshDesc();
+        RenderStateDesc opaque = RENDER_STATE_OPAQUE;
+        renderer_PrewarmRegisterLayout("cube", &cubeDesc.layout);
+        renderer_PrewarmRegisterState("opaque", &opaque);
+        renderer_PrewarmRun("assets/shaders/variants.manifest");
+
+        /* Edits under assets/shaders are rebuilt in the background and swapped in when they link */
+        renderer_HotReloadInit(HOT_RELOAD_DEFAULT_DIR);
         
-        if (!RenderState.shader) {
-            RenderState.shader = renderer_ShaderLibraryGet(RenderState.shaderLib, "basic");
+        shader = renderer_ShaderVariantGet(RenderState.cubeVariants, 0);
+        if (!shader) {
+            shader = basic;
         }
+
+        /* Locations 0/1/2 of the cube mesh against what the linked program actually reads */
+        if (renderer_ShaderPoll(shader) == SHADER_STATUS_READY)
+            renderer_ResourceLayoutValidate(&cubeDesc.layout, shader);
     #elif defined(GLX_VULKAN)
-        RenderState.shader = renderer_ShaderLoadFromFile("cube",
+        /* build/build.sh compiles the SPIR-V from cube.vert and cube.frag for Vulkan builds */
+        shader = renderer_ShaderLoadFromFile("cube",
             "assets/shaders/cube/cube.vert.spv",
             "assets/shaders/cube/cube.frag.spv");
         
-        if (!RenderState.shader) {
-            LOG_FATAL("Failed to load Vulkan shaders!");
+        /* The library may keep an existing shader of that name, register the one it holds */
+        if (shader) shader = renderer_ShaderLibraryAdd(RenderState.shaderLib, shader);
+        if (!shader) {
+            LOG_FATAL("Failed to load Vulkan shaders, build with CODA_GLX=Vulkan to compile the SPIR-V!");
         }
-        renderer_ShaderLibraryAdd(RenderState.shaderLib, RenderState.shader);
+
+        /* Reflected from the SPIR-V, the same check the GL path runs on the linked program */
+        MeshDesc cubeDesc = coda_CubeMeshDesc();
+        renderer_ResourceLayoutValidate(&cubeDesc.layout, shader);
     #endif
     
-    LOG_INFO("Shader '%s' loaded", RenderState.shader->name);
+    RenderState.shader = renderer_ResourceShaderRegister(shader);
+    LOG_INFO("Shader '%s' loaded", shader->name);
     LOG_INFO("Resources loaded successfully");
+
+    core_ProfilerEndFrame();
+    core_ProfilerLogFrame(core_ProfilerGetFrame(core_ProfilerGetFrameIndex()));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#define PROFILER_REPORT_INTERVAL 300
+
 static inline Bool coda_runtime(void)
 {
  
@@ -554,9 +661,40 @@ static inline Bool coda_runtime(void)
         
         RenderState.dt += 0.3;
 
+        core_ProfilerBeginFrame();
+        core_ArenaFrameBegin(core_ProfilerGetFrameIndex());
+        renderer_GpuTimerBeginFrame(core_ProfilerGetFrameIndex());
+
+        PROFILE_BEGIN("Poll");
         platform_WindowPoll();
+        PROFILE_END();
+
+        PROFILE_BEGIN("Render");
         coda_RenderFrame();
+        PROFILE_END();
+
+        PROFILE_BEGIN("Swap");
         platform_WindowSwapBuffers();
+        PROFILE_END();
+
+        renderer_GpuTimerEndFrame();
+        #ifdef GLX_OPENGL
+            renderer_GlStateEndFrame();
+        #endif
+        core_ProfilerEndFrame();
+        core_RecorderEndFrame();
+        core_MemoryEndFrame();
+
+        /* GPU results for this frame land a few frames later */
+        u64 frameIndex = core_ProfilerGetFrameIndex();
+        if (frameIndex % PROFILER_REPORT_INTERVAL == 0) {
+            core_ProfilerLogFrame(core_ProfilerGetFrame(frameIndex - GPU_TIMER_LATENCY));
+
+            #ifdef GLX_OPENGL
+                GlStateStats stats = renderer_GlStateGetStats();
+                LOG_INFO("GL state: %u calls issued, %u filtered", stats.issued, stats.filtered);
+            #endif
+        }
 
         usleep(16666); /* ~60 FPS */
     }
@@ -573,11 +711,9 @@ static void cleanUp(char* _cleanup_var)
     
     if (ClearUpState.RenderInitialized)
     {
-        #ifdef GLX_OPENGL
-            if (RenderState.ebo) glDeleteBuffers(1, &RenderState.ebo);
-            if (RenderState.vbo) glDeleteBuffers(1, &RenderState.vbo);
-            if (RenderState.vao) glDeleteVertexArrays(1, &RenderState.vao);
-        #elif defined(GLX_VULKAN)
+        renderer_GpuTimerShutdown();
+
+        #ifdef GLX_VULKAN
             VkDevice device = vk_get_device();
             
             vkDeviceWaitIdle(device);
@@ -588,21 +724,30 @@ static void cleanUp(char* _cleanup_var)
                 vkDestroySemaphore(device, RenderState.renderFinishedSemaphore, NULL);
             if (RenderState.imageAvailableSemaphore) 
                 vkDestroySemaphore(device, RenderState.imageAvailableSemaphore, NULL);
-            
-            if (RenderState.indexBuffer) 
-                vkDestroyBuffer(device, RenderState.indexBuffer, NULL);
-            if (RenderState.indexBufferMemory) 
-                vkFreeMemory(device, RenderState.indexBufferMemory, NULL);
-            
-            if (RenderState.vertexBuffer) 
-                vkDestroyBuffer(device, RenderState.vertexBuffer, NULL);
-            if (RenderState.vertexBufferMemory) 
-                vkFreeMemory(device, RenderState.vertexBufferMemory, NULL);
         #endif
         
+        renderer_IndirectShutdown();
+        renderer_InstanceShutdown();
+        renderer_UboShutdown();
+        renderer_ResourceMeshDestroy(RenderState.cube);
+        renderer_ResourceShaderRelease(RenderState.shader);
+        renderer_ResourceShutdown();
+        
+        #ifdef GLX_OPENGL
+            renderer_HotReloadShutdown();
+        #endif
+        renderer_PrewarmShutdown();
+        renderer_ShaderVariantDestroy(RenderState.cubeVariants);
         if (RenderState.shaderLib) {
             renderer_ShaderLibraryDestroy(RenderState.shaderLib);
         }
+
+        renderer_ShaderSourceShutdown();
+
+        #ifdef GLX_OPENGL
+            renderer_ShaderCacheShutdown();
+            renderer_GlDebugShutdown();
+        #endif
     }
     
     if (ClearUpState.CallbacksRegistered) {
@@ -615,9 +760,22 @@ static void cleanUp(char* _cleanup_var)
         platform_WindowFree();
     }
     
+    core_ArenaFrameShutdown();
+    core_ArenaScratchRelease();
+
+    if (ClearUpState.ProfilerInitialized) {
+        core_RecorderShutdown();
+        core_ProfilerShutdown();
+    }
+    
     if (ClearUpState.EventsInitialized) {
         core_EventShutdown();
     }
+
+    core_StrIdShutdown();
+
+    /* Anything still live here is a leak */
+    core_MemoryLogReport();
     
     LOG_INFO("Cleanup complete");
 }
@@ -0,0 +1,262 @@
+#include "arena.h"
+#include <string.h>
+
+#include <core/debug.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Arena##func_name
+
+#define ARENA_MIN_OVERFLOW_BLOCK KB(64)
+
+struct ArenaBlock
+{
+    ArenaBlock* next;
+    usize       capacity;
+    usize       offset;
+};
+
+/* Block data starts after the header, padded to the default alignment */
+#define ARENA_BLOCK_HEADER ( ( sizeof( ArenaBlock ) + ARENA_DEFAULT_ALIGN - 1 ) & ~( usize )( ARENA_DEFAULT_ALIGN - 1 ) )
+
+static struct
+{
+    Arena  arenas[FRAME_ARENA_COUNT];
+    Arena* current;
+    u8     initialized;
+} frameArenas = {0};
+
+static _Thread_local Arena scratchArenas[2];
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline usize AlignOffset( const u8* base, usize offset, usize align )
+{
+    uintptr_t address = ( uintptr_t )( base + offset );
+    uintptr_t aligned = ( address + ( align - 1 ) ) & ~( uintptr_t )( align - 1 );
+    return offset + ( usize )( aligned - address );
+}
+
+static void* PushOverflow( Arena* arena, usize size, usize align )
+{
+    ArenaBlock* block = arena->overflow;
+
+    if ( block )
+    {
+        u8*   data   = ( u8* )block + ARENA_BLOCK_HEADER;
+        usize offset = AlignOffset( data, block->offset, align );
+        if ( offset + size <= block->capacity )
+        {
+            block->offset = offset + size;
+            arena->overflowBytes += size;
+            return data + offset;
+        }
+    }
+
+    usize capacity = MAX( size + align, MAX( arena->capacity / 4, ( usize )ARENA_MIN_OVERFLOW_BLOCK ) );
+
+    block = ( ArenaBlock* )core_MemoryAlloc( ARENA_BLOCK_HEADER + capacity, arena->tag );
+    if ( !block ) return NULL;
+
+    block->next     = arena->overflow;
+    block->capacity = capacity;
+    block->offset   = 0;
+    arena->overflow = block;
+
+    u8*   data   = ( u8* )block + ARENA_BLOCK_HEADER;
+    usize offset = AlignOffset( data, 0, align );
+    block->offset = offset + size;
+    arena->overflowBytes += size;
+    return data + offset;
+}
+
+static void FreeOverflowUntil( Arena* arena, ArenaBlock* keep )
+{
+    while ( arena->overflow && arena->overflow != keep )
+    {
+        ArenaBlock* next = arena->overflow->next;
+        core_MemoryFree( arena->overflow );
+        arena->overflow = next;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Create ) ( Arena* arena, usize capacity, MemoryTag tag )
+{
+    CHECK_NULL( arena );
+
+    void* buffer = core_MemoryAlloc( capacity, tag );
+    if ( !buffer ) return False;
+
+    __namespace( InitBuffer )( arena, buffer, capacity, tag );
+    arena->ownsMemory = True;
+    return True;
+}
+
+void __namespace( InitBuffer ) ( Arena* arena, void* buffer, usize capacity, MemoryTag tag )
+{
+    memset( arena, 0, sizeof( *arena ) );
+    arena->base     = ( u8* )buffer;
+    arena->capacity = capacity;
+    arena->tag      = tag;
+}
+
+void __namespace( Destroy ) ( Arena* arena )
+{
+    if ( !arena ) return;
+
+    FreeOverflowUntil( arena, NULL );
+    if ( arena->ownsMemory )
+        core_MemoryFree( arena->base );
+
+    memset( arena, 0, sizeof( *arena ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void* __namespace( Push ) ( Arena* arena, usize size, usize align )
+{
+    ASSERT( align && ( align & ( align - 1 ) ) == 0, "alignment must be a power of two" );
+
+    usize offset = AlignOffset( arena->base, arena->offset, align );
+    if ( arena->base && offset + size <= arena->capacity )
+    {
+        arena->offset = offset + size;
+        arena->peak   = MAX( arena->peak, arena->offset );
+        return arena->base + offset;
+    }
+
+    return PushOverflow( arena, size, align );
+}
+
+void* __namespace( PushZero ) ( Arena* arena, usize size, usize align )
+{
+    void* block = __namespace( Push )( arena, size, align );
+    if ( block )
+        memset( block, 0, size );
+    return block;
+}
+
+/* Only report when overflow grows, the fix is a bigger arena */
+static void ReportOverflow( Arena* arena )
+{
+    if ( arena->overflowBytes > arena->overflowPeak )
+    {
+        LOG_WARN( "Arena (%s): overflowed by %zu bytes past %zu, falling back to heap",
+            core_MemoryTagName( arena->tag ), arena->overflowBytes, arena->capacity );
+        arena->overflowPeak = arena->overflowBytes;
+    }
+}
+
+void __namespace( Reset ) ( Arena* arena )
+{
+    ReportOverflow( arena );
+
+    FreeOverflowUntil( arena, NULL );
+    arena->offset        = 0;
+    arena->overflowBytes = 0;
+}
+
+ArenaMark __namespace( GetMark ) ( Arena* arena )
+{
+    ArenaMark mark;
+    mark.offset         = arena->offset;
+    mark.overflow       = arena->overflow;
+    mark.overflowOffset = arena->overflow ? arena->overflow->offset : 0;
+    mark.overflowBytes  = arena->overflowBytes;
+    return mark;
+}
+
+void __namespace( Rewind ) ( Arena* arena, ArenaMark mark )
+{
+    /* The scope being dropped may hold the peak, report it before the count goes back */
+    ReportOverflow( arena );
+
+    FreeOverflowUntil( arena, mark.overflow );
+
+    arena->offset        = mark.offset;
+    arena->overflowBytes = mark.overflowBytes;
+    if ( arena->overflow )
+        arena->overflow->offset = mark.overflowOffset;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( FrameInit ) ( usize bytesPerFrame )
+{
+    ASSERT( frameArenas.initialized != True );
+
+    for ( u32 i = 0; i < FRAME_ARENA_COUNT; i++ )
+    {
+        if ( !__namespace( Create )( &frameArenas.arenas[i], bytesPerFrame, MEMORY_TAG_FRAME ) )
+        {
+            __namespace( FrameShutdown )();
+            return False;
+        }
+    }
+
+    frameArenas.current     = &frameArenas.arenas[0];
+    frameArenas.initialized = True;
+    return True;
+}
+
+void __namespace( FrameShutdown ) ( void )
+{
+    for ( u32 i = 0; i < FRAME_ARENA_COUNT; i++ )
+        __namespace( Destroy )( &frameArenas.arenas[i] );
+
+    frameArenas.current     = NULL;
+    frameArenas.initialized = False;
+}
+
+void __namespace( FrameBegin ) ( u64 frameIndex )
+{
+    if ( !frameArenas.initialized ) return;
+
+    frameArenas.current = &frameArenas.arenas[frameIndex % FRAME_ARENA_COUNT];
+    __namespace( Reset )( frameArenas.current );
+}
+
+void* __namespace( FrameAlloc ) ( usize size, usize align )
+{
+    ASSERT( frameArenas.initialized, "frame arenas not initialized" );
+    return __namespace( Push )( frameArenas.current, size, align );
+}
+
+Arena* __namespace( FrameGet ) ( void )
+{
+    return frameArenas.current;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ArenaTemp __namespace( ScratchBegin ) ( const Arena* conflict )
+{
+    Arena* arena = ( conflict == &scratchArenas[0] ) ? &scratchArenas[1] : &scratchArenas[0];
+
+    if ( !arena->base )
+        __namespace( Create )( arena, ARENA_SCRATCH_SIZE, MEMORY_TAG_ARENA );
+
+    ArenaTemp temp;
+    temp.arena = arena;
+    temp.mark  = __namespace( GetMark )( arena );
+    return temp;
+}
+
+void __namespace( ScratchEnd ) ( ArenaTemp temp )
+{
+    __namespace( Rewind )( temp.arena, temp.mark );
+}
+
+void __namespace( ScratchRelease ) ( void )
+{
+    __namespace( Destroy )( &scratchArenas[0] );
+    __namespace( Destroy )( &scratchArenas[1] );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,85 @@
+#ifndef __arena_h__
+#define __arena_h__
+
+#include <core/types.h>
+#include <core/memory.h>
+
+#define __namespace( func_name ) core##_##Arena##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define ARENA_DEFAULT_ALIGN  16
+#define ARENA_SCRATCH_SIZE   MB(1)
+#define FRAME_ARENA_COUNT    3          /* frames the GPU may still be reading from */
+
+/* Heap blocks taken when the arena runs out, released on Reset */
+typedef struct ArenaBlock ArenaBlock;
+
+struct_name ( Arena )
+{
+    u8*         base;
+    usize       capacity;
+    usize       offset;
+    usize       peak;
+    ArenaBlock* overflow;
+    usize       overflowBytes;
+    usize       overflowPeak;
+    MemoryTag   tag;
+    u8          ownsMemory;
+};
+
+struct_name ( ArenaMark )
+{
+    usize       offset;
+    ArenaBlock* overflow;
+    usize       overflowOffset;
+    usize       overflowBytes;
+};
+
+struct_name ( ArenaTemp )
+{
+    Arena*      arena;
+    ArenaMark   mark;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern u8    __namespace( Create )     ( Arena* arena, usize capacity, MemoryTag tag );
+extern void  __namespace( InitBuffer ) ( Arena* arena, void* buffer, usize capacity, MemoryTag tag );
+extern void  __namespace( Destroy )    ( Arena* arena );
+
+/* align must be a power of two, never returns NULL unless the heap fallback fails */
+extern void* __namespace( Push )       ( Arena* arena, usize size, usize align );
+extern void* __namespace( PushZero )   ( Arena* arena, usize size, usize align );
+extern void  __namespace( Reset )      ( Arena* arena );
+
+extern ArenaMark __namespace( GetMark ) ( Arena* arena );
+extern void      __namespace( Rewind )  ( Arena* arena, ArenaMark mark );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Frame arenas: everything allocated during frame N is released when frame N + FRAME_ARENA_COUNT begins */
+extern u8     __namespace( FrameInit )     ( usize bytesPerFrame );
+extern void   __namespace( FrameShutdown ) ( void );
+extern void   __namespace( FrameBegin )    ( u64 frameIndex );
+extern void*  __namespace( FrameAlloc )    ( usize size, usize align );
+extern Arena* __namespace( FrameGet )      ( void );
+
+/* Per thread scratch, pass the arena you are allocating results into so scratch never aliases it */
+extern ArenaTemp __namespace( ScratchBegin )   ( const Arena* conflict );
+extern void      __namespace( ScratchEnd )     ( ArenaTemp temp );
+extern void      __namespace( ScratchRelease ) ( void );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define ARENA_PUSH_TYPE( arena, Type )         ( ( Type* )core_ArenaPush( arena, sizeof( Type ), _Alignof( Type ) ) )
+#define ARENA_PUSH_ARRAY( arena, Type, count ) ( ( Type* )core_ArenaPush( arena, sizeof( Type ) * ( count ), _Alignof( Type ) ) )
+#define FRAME_ALLOC_ARRAY( Type, count )       ( ( Type* )core_ArenaFrameAlloc( sizeof( Type ) * ( count ), _Alignof( Type ) ) )
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __arena_h__ */
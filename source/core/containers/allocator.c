@@ -0,0 +1,142 @@
+#include "allocator.h"
+#include <string.h>
+
+#include <core/debug.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Allocator##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Heap blocks are 16 byte aligned by core_MemoryAlloc, enough for every container element */
+static void* HeapAlloc( void* context, usize size, usize align )
+{
+    ASSERT( align <= 16, "heap allocator alignment above 16" );
+    return core_MemoryAlloc( size, ( MemoryTag )( uintptr_t )context );
+}
+
+static void* HeapRealloc( void* context, void* block, usize oldSize, usize newSize, usize align )
+{
+    UNUSED( oldSize );
+    ASSERT( align <= 16, "heap allocator alignment above 16" );
+    return core_MemoryRealloc( block, newSize, ( MemoryTag )( uintptr_t )context );
+}
+
+static void HeapFree( void* context, void* block, usize size )
+{
+    UNUSED( context );
+    UNUSED( size );
+    core_MemoryFree( block );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void* ArenaAlloc( void* context, usize size, usize align )
+{
+    return core_ArenaPush( ( Arena* )context, size, align );
+}
+
+static void* ArenaRealloc( void* context, void* block, usize oldSize, usize newSize, usize align )
+{
+    Arena* arena = ( Arena* )context;
+
+    /* The last block grows in place */
+    if ( block && ( u8* )block + oldSize == arena->base + arena->offset &&
+         ( u8* )block - arena->base + newSize <= arena->capacity )
+    {
+        arena->offset = ( usize )( ( u8* )block - arena->base ) + newSize;
+        arena->peak   = MAX( arena->peak, arena->offset );
+        return block;
+    }
+
+    void* grown = core_ArenaPush( arena, newSize, align );
+    if ( grown && block )
+        memcpy( grown, block, MIN( oldSize, newSize ) );
+    return grown;
+}
+
+static void ArenaFree( void* context, void* block, usize size )
+{
+    UNUSED( context );
+    UNUSED( block );
+    UNUSED( size );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void* PoolAlloc( void* context, usize size, usize align )
+{
+    Pool* pool = ( Pool* )context;
+    if ( size > pool->objectSize || align > pool->align )
+    {
+        LOG_ERROR( "Pool allocator: %zu byte block does not fit %zu byte objects", size, pool->objectSize );
+        return NULL;
+    }
+    return core_PoolAlloc( pool );
+}
+
+static void* PoolRealloc( void* context, void* block, usize oldSize, usize newSize, usize align )
+{
+    Pool* pool = ( Pool* )context;
+    UNUSED( oldSize );
+
+    if ( !block ) return PoolAlloc( context, newSize, align );
+    if ( newSize <= pool->objectSize ) return block;
+
+    LOG_ERROR( "Pool allocator: can not grow past %zu bytes", pool->objectSize );
+    return NULL;
+}
+
+static void PoolFree( void* context, void* block, usize size )
+{
+    UNUSED( size );
+    core_PoolFree( ( Pool* )context, block );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Allocator __namespace( Heap ) ( MemoryTag tag )
+{
+    Allocator allocator = { HeapAlloc, HeapRealloc, HeapFree, ( void* )( uintptr_t )tag };
+    return allocator;
+}
+
+Allocator __namespace( Arena ) ( Arena* arena )
+{
+    Allocator allocator = { ArenaAlloc, ArenaRealloc, ArenaFree, arena };
+    return allocator;
+}
+
+Allocator __namespace( Pool ) ( Pool* pool )
+{
+    Allocator allocator = { PoolAlloc, PoolRealloc, PoolFree, pool };
+    return allocator;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void* __namespace( Alloc ) ( const Allocator* allocator, usize size, usize align )
+{
+    if ( !allocator ) return HeapAlloc( ( void* )( uintptr_t )MEMORY_TAG_CORE, size, align );
+    return allocator->alloc( allocator->context, size, align );
+}
+
+void* __namespace( Realloc ) ( const Allocator* allocator, void* block, usize oldSize, usize newSize, usize align )
+{
+    if ( !allocator ) return HeapRealloc( ( void* )( uintptr_t )MEMORY_TAG_CORE, block, oldSize, newSize, align );
+    return allocator->realloc( allocator->context, block, oldSize, newSize, align );
+}
+
+void __namespace( Free ) ( const Allocator* allocator, void* block, usize size )
+{
+    if ( !block ) return;
+    if ( !allocator ) { HeapFree( NULL, block, size ); return; }
+    allocator->free( allocator->context, block, size );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,42 @@
+#ifndef __allocator_h__
+#define __allocator_h__
+
+#include <core/types.h>
+#include <core/memory.h>
+#include <core/arena.h>
+#include <core/pool.h>
+
+#define __namespace( func_name ) core##_##Allocator##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Containers grow through this, a NULL allocator means the tagged heap under MEMORY_TAG_CORE */
+struct_name ( Allocator )
+{
+    void* ( *alloc )   ( void* context, usize size, usize align );
+    void* ( *realloc ) ( void* context, void* block, usize oldSize, usize newSize, usize align );
+    void  ( *free )    ( void* context, void* block, usize size );
+    void* context;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern Allocator __namespace( Heap )  ( MemoryTag tag );
+
+/* Frees are ignored, memory goes back when the arena is reset or rewound */
+extern Allocator __namespace( Arena ) ( Arena* arena );
+
+/* Blocks up to the pool object size, for containers whose capacity never exceeds one object */
+extern Allocator __namespace( Pool )  ( Pool* pool );
+
+extern void* __namespace( Alloc )   ( const Allocator* allocator, usize size, usize align );
+extern void* __namespace( Realloc ) ( const Allocator* allocator, void* block, usize oldSize, usize newSize, usize align );
+extern void  __namespace( Free )    ( const Allocator* allocator, void* block, usize size );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __allocator_h__ */
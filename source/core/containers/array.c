@@ -0,0 +1,174 @@
+#include "array.h"
+#include <string.h>
+
+#include <core/debug.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Array##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static u8 Grow( Array* array, u32 capacity )
+{
+    if ( capacity <= array->capacity ) return True;
+
+    usize oldBytes = ( usize )array->capacity * array->stride;
+    usize newBytes = ( usize )capacity * array->stride;
+    u8*   data;
+
+    /* Inline storage is never handed to the allocator, the first spill copies out of it */
+    if ( array->data == array->inlineData )
+    {
+        data = ( u8* )core_AllocatorAlloc( &array->allocator, newBytes, array->align );
+        if ( data && array->count )
+            memcpy( data, array->data, ( usize )array->count * array->stride );
+    }
+    else
+    {
+        data = ( u8* )core_AllocatorRealloc( &array->allocator, array->data, oldBytes, newBytes, array->align );
+    }
+
+    if ( !data )
+    {
+        LOG_ERROR( "Array: failed to grow to %u elements", capacity );
+        return False;
+    }
+
+    array->data     = data;
+    array->capacity = capacity;
+    return True;
+}
+
+static inline u8 GrowFor( Array* array, u32 count )
+{
+    if ( count <= array->capacity ) return True;
+
+    u32 capacity = array->capacity ? array->capacity : ARRAY_MIN_CAPACITY;
+    while ( capacity < count ) capacity *= 2;
+    return Grow( array, capacity );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Init ) ( Array* array, u32 stride, u32 align, u32 capacity, const Allocator* allocator )
+{
+    CHECK_NULL( array );
+    memset( array, 0, sizeof( *array ) );
+
+    array->stride    = stride;
+    array->align     = align;
+    array->allocator = allocator ? *allocator : core_AllocatorHeap( MEMORY_TAG_CORE );
+
+    return capacity ? Grow( array, capacity ) : True;
+}
+
+void __namespace( InitInline ) ( Array* array, u32 stride, u32 align, void* storage, u32 capacity, const Allocator* allocator )
+{
+    __namespace( Init )( array, stride, align, 0, allocator );
+    array->data           = ( u8* )storage;
+    array->inlineData     = ( u8* )storage;
+    array->inlineCapacity = capacity;
+    array->capacity       = capacity;
+}
+
+void __namespace( Free ) ( Array* array )
+{
+    if ( !array ) return;
+
+    if ( array->data != array->inlineData )
+        core_AllocatorFree( &array->allocator, array->data, ( usize )array->capacity * array->stride );
+
+    /* Back to the inline storage, the array stays usable */
+    array->count    = 0;
+    array->data     = array->inlineData;
+    array->capacity = array->inlineCapacity;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Reserve ) ( Array* array, u32 capacity )
+{
+    return Grow( array, capacity );
+}
+
+u8 __namespace( Resize ) ( Array* array, u32 count )
+{
+    if ( !GrowFor( array, count ) ) return False;
+
+    if ( count > array->count )
+        memset( __namespace( Get )( array, array->count ), 0, ( usize )( count - array->count ) * array->stride );
+
+    array->count = count;
+    return True;
+}
+
+void __namespace( Clear ) ( Array* array )
+{
+    array->count = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void* __namespace( Push ) ( Array* array )
+{
+    if ( !GrowFor( array, array->count + 1 ) ) return NULL;
+
+    void* element = __namespace( Get )( array, array->count++ );
+    memset( element, 0, array->stride );
+    return element;
+}
+
+u8 __namespace( PushValue ) ( Array* array, const void* value )
+{
+    if ( !GrowFor( array, array->count + 1 ) ) return False;
+
+    memcpy( __namespace( Get )( array, array->count++ ), value, array->stride );
+    return True;
+}
+
+void* __namespace( Insert ) ( Array* array, u32 index )
+{
+    ASSERT( index <= array->count, "array insert out of range" );
+    if ( !GrowFor( array, array->count + 1 ) ) return NULL;
+
+    u8* element = ( u8* )__namespace( Get )( array, index );
+    memmove( element + array->stride, element, ( usize )( array->count - index ) * array->stride );
+    memset( element, 0, array->stride );
+    array->count++;
+    return element;
+}
+
+u8 __namespace( Pop ) ( Array* array, void* out )
+{
+    if ( !array->count ) return False;
+
+    array->count--;
+    if ( out )
+        memcpy( out, __namespace( Get )( array, array->count ), array->stride );
+    return True;
+}
+
+void __namespace( RemoveSwap ) ( Array* array, u32 index )
+{
+    ASSERT( index < array->count, "array remove out of range" );
+
+    u32 last = --array->count;
+    if ( index != last )
+        memcpy( __namespace( Get )( array, index ), __namespace( Get )( array, last ), array->stride );
+}
+
+void __namespace( RemoveOrdered ) ( Array* array, u32 index )
+{
+    ASSERT( index < array->count, "array remove out of range" );
+
+    u8* element = ( u8* )__namespace( Get )( array, index );
+    memmove( element, element + array->stride, ( usize )( array->count - index - 1 ) * array->stride );
+    array->count--;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
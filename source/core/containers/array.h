@@ -0,0 +1,73 @@
+#ifndef __array_h__
+#define __array_h__
+
+#include <core/types.h>
+#include <core/containers/allocator.h>
+
+#define __namespace( func_name ) core##_##Array##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define ARRAY_MIN_CAPACITY 8
+
+/* Growable array of fixed stride elements, doubles on overflow */
+struct_name ( Array )
+{
+    u8*       data;
+    u32       count;
+    u32       capacity;
+    u32       stride;
+    u32       align;
+    u8*       inlineData;   /* small vector storage, data points here until the first spill */
+    u32       inlineCapacity;
+    Allocator allocator;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern u8    __namespace( Init )       ( Array* array, u32 stride, u32 align, u32 capacity, const Allocator* allocator );
+extern void  __namespace( InitInline ) ( Array* array, u32 stride, u32 align, void* storage, u32 capacity, const Allocator* allocator );
+extern void  __namespace( Free )       ( Array* array );
+
+extern u8    __namespace( Reserve )    ( Array* array, u32 capacity );
+extern u8    __namespace( Resize )     ( Array* array, u32 count );
+extern void  __namespace( Clear )      ( Array* array );
+
+/* Returns the new zeroed element, NULL when growing fails */
+extern void* __namespace( Push )       ( Array* array );
+extern u8    __namespace( PushValue )  ( Array* array, const void* value );
+extern void* __namespace( Insert )     ( Array* array, u32 index );
+extern u8    __namespace( Pop )        ( Array* array, void* out );
+
+/* RemoveSwap is O(1) but moves the last element into index */
+extern void  __namespace( RemoveSwap )    ( Array* array, u32 index );
+extern void  __namespace( RemoveOrdered ) ( Array* array, u32 index );
+
+static inline void* __namespace( Get ) ( const Array* array, u32 index )
+{
+    return array->data + ( usize )index * array->stride;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define ARRAY_INIT_TYPE( array, Type, capacity, allocator ) \
+    core_ArrayInit( array, sizeof( Type ), _Alignof( Type ), capacity, allocator )
+
+#define ARRAY_AT( array, Type, index )      ( ( ( Type* )( array )->data )[index] )
+#define ARRAY_PUSH_TYPE( array, Type )      ( ( Type* )core_ArrayPush( array ) )
+#define ARRAY_FOR_EACH( array, Type, it ) \
+    for ( Type* it = ( Type* )( array )->data; it < ( Type* )( array )->data + ( array )->count; it++ )
+
+/* Array with N elements of inline storage, only spills to the allocator past N. Must not be moved once initialized */
+#define SMALL_VEC( Type, N )                struct { Array array; Type storage[N]; }
+#define SMALL_VEC_INIT( vec, Type, allocator ) \
+    core_ArrayInitInline( &( vec )->array, sizeof( Type ), _Alignof( Type ), ( vec )->storage, \
+                          ARRAY_SIZE( ( vec )->storage ), allocator )
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __array_h__ */
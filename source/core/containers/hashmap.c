@@ -0,0 +1,326 @@
+#include "hashmap.h"
+#include <string.h>
+
+#include <core/debug.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+    #define HASHMAP_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define HASHMAP_SSE2 0
+#endif
+
+#if COMPILER_MSVC
+    #include <intrin.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##HashMap##func_name
+
+/* Full slots store the low 7 hash bits, the two special values have the high bit set */
+#define CTRL_EMPTY   ( ( u8 )0x80 )
+#define CTRL_DELETED ( ( u8 )0xFE )
+
+typedef u32 GroupMask;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline u32 LowestBit( GroupMask mask )
+{
+    #if COMPILER_MSVC
+    unsigned long index;
+    _BitScanForward( &index, mask );
+    return ( u32 )index;
+    #else
+    return ( u32 )__builtin_ctz( mask );
+    #endif
+}
+
+#if HASHMAP_SSE2
+
+static inline GroupMask MatchByte( const u8* group, u8 value )
+{
+    __m128i ctrl = _mm_loadu_si128( ( const __m128i* )group );
+    return ( GroupMask )_mm_movemask_epi8( _mm_cmpeq_epi8( ctrl, _mm_set1_epi8( ( char )value ) ) );
+}
+
+/* Empty and deleted are the only bytes with the sign bit set */
+static inline GroupMask MatchFree( const u8* group )
+{
+    return ( GroupMask )_mm_movemask_epi8( _mm_loadu_si128( ( const __m128i* )group ) );
+}
+
+#else
+
+static inline GroupMask MatchByte( const u8* group, u8 value )
+{
+    GroupMask mask = 0;
+    for ( u32 i = 0; i < HASHMAP_GROUP_SIZE; i++ )
+        mask |= ( GroupMask )( group[i] == value ) << i;
+    return mask;
+}
+
+static inline GroupMask MatchFree( const u8* group )
+{
+    GroupMask mask = 0;
+    for ( u32 i = 0; i < HASHMAP_GROUP_SIZE; i++ )
+        mask |= ( GroupMask )( group[i] >> 7 ) << i;
+    return mask;
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline usize AlignUp( usize value, usize align )
+{
+    return ( value + align - 1 ) & ~( align - 1 );
+}
+
+/* Keys, values and control bytes share one block */
+static usize LayoutSize( u32 capacity, u32 valueSize, u32 valueAlign, usize* valuesOffset, usize* ctrlOffset )
+{
+    usize values = AlignUp( ( usize )capacity * sizeof( u64 ), valueAlign );
+    usize ctrl   = values + ( usize )capacity * valueSize;
+    if ( valuesOffset ) *valuesOffset = values;
+    if ( ctrlOffset )   *ctrlOffset   = ctrl;
+    return ctrl + capacity + HASHMAP_GROUP_SIZE;
+}
+
+static inline u32 MaxLoad( u32 capacity )
+{
+    return capacity - capacity / 8;
+}
+
+static inline void SetCtrl( HashMap* map, u32 slot, u8 value )
+{
+    map->ctrl[slot] = value;
+    if ( slot < HASHMAP_GROUP_SIZE )
+        map->ctrl[map->capacity + slot] = value;
+}
+
+static inline void* ValueAt( const HashMap* map, u32 slot )
+{
+    return map->values + ( usize )slot * map->valueSize;
+}
+
+/* Triangular probing over groups reaches every group when the capacity is a power of two */
+static i64 Find( const HashMap* map, u64 key, u64 hash )
+{
+    if ( !map->capacity ) return -1;
+
+    u32 mask   = map->capacity - 1;
+    u32 pos    = ( u32 )( hash >> 7 ) & mask;
+    u8  h2     = ( u8 )( hash & 0x7F );
+    u32 stride = 0;
+
+    for ( ;; )
+    {
+        const u8* group = map->ctrl + pos;
+
+        for ( GroupMask match = MatchByte( group, h2 ); match; match &= match - 1 )
+        {
+            u32 slot = ( pos + LowestBit( match ) ) & mask;
+            if ( map->keys[slot] == key ) return slot;
+        }
+
+        if ( MatchByte( group, CTRL_EMPTY ) ) return -1;
+
+        stride += HASHMAP_GROUP_SIZE;
+        if ( stride > map->capacity ) return -1;
+        pos = ( pos + stride ) & mask;
+    }
+}
+
+static u32 FindFree( const HashMap* map, u64 hash )
+{
+    u32 mask   = map->capacity - 1;
+    u32 pos    = ( u32 )( hash >> 7 ) & mask;
+    u32 stride = 0;
+
+    for ( ;; )
+    {
+        GroupMask free = MatchFree( map->ctrl + pos );
+        if ( free ) return ( pos + LowestBit( free ) ) & mask;
+
+        stride += HASHMAP_GROUP_SIZE;
+        pos = ( pos + stride ) & mask;
+    }
+}
+
+static u8 Rehash( HashMap* map, u32 capacity )
+{
+    usize valuesOffset, ctrlOffset;
+    usize bytes = LayoutSize( capacity, map->valueSize, map->valueAlign, &valuesOffset, &ctrlOffset );
+
+    u8* block = ( u8* )core_AllocatorAlloc( &map->allocator, bytes, MAX( map->valueAlign, ( u32 )sizeof( u64 ) ) );
+    if ( !block )
+    {
+        LOG_ERROR( "HashMap: failed to grow to %u slots", capacity );
+        return False;
+    }
+
+    HashMap old = *map;
+
+    map->keys       = ( u64* )block;
+    map->values     = block + valuesOffset;
+    map->ctrl       = block + ctrlOffset;
+    map->capacity   = capacity;
+    map->growthLeft = MaxLoad( capacity ) - map->count;
+    memset( map->ctrl, CTRL_EMPTY, capacity + HASHMAP_GROUP_SIZE );
+
+    for ( u32 slot = 0; slot < old.capacity; slot++ )
+    {
+        if ( old.ctrl[slot] & 0x80 ) continue;
+
+        u64 hash = __namespace( Hash )( old.keys[slot] );
+        u32 dest = FindFree( map, hash );
+
+        SetCtrl( map, dest, ( u8 )( hash & 0x7F ) );
+        map->keys[dest] = old.keys[slot];
+        memcpy( ValueAt( map, dest ), ValueAt( &old, slot ), map->valueSize );
+    }
+
+    if ( old.keys )
+        core_AllocatorFree( &map->allocator, old.keys, LayoutSize( old.capacity, old.valueSize, old.valueAlign, NULL, NULL ) );
+    return True;
+}
+
+static u32 CapacityFor( u32 count )
+{
+    u32 capacity = HASHMAP_MIN_CAPACITY;
+    while ( MaxLoad( capacity ) < count ) capacity *= 2;
+    return capacity;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u64 __namespace( Hash ) ( u64 key )
+{
+    /* murmur3 finalizer, keys are often small integers or already hashed ids */
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+u8 __namespace( Init ) ( HashMap* map, u32 valueSize, u32 valueAlign, u32 capacity, const Allocator* allocator )
+{
+    CHECK_NULL( map );
+    memset( map, 0, sizeof( *map ) );
+
+    map->valueSize  = valueSize;
+    map->valueAlign = valueAlign ? valueAlign : 1;
+    map->allocator  = allocator ? *allocator : core_AllocatorHeap( MEMORY_TAG_CORE );
+
+    return capacity ? Rehash( map, CapacityFor( capacity ) ) : True;
+}
+
+void __namespace( Free ) ( HashMap* map )
+{
+    if ( !map || !map->keys ) return;
+
+    core_AllocatorFree( &map->allocator, map->keys,
+        LayoutSize( map->capacity, map->valueSize, map->valueAlign, NULL, NULL ) );
+
+    map->keys     = NULL;
+    map->values   = NULL;
+    map->ctrl     = NULL;
+    map->capacity = 0;
+    map->count    = 0;
+    map->growthLeft = 0;
+}
+
+void __namespace( Clear ) ( HashMap* map )
+{
+    if ( !map->capacity ) return;
+
+    memset( map->ctrl, CTRL_EMPTY, map->capacity + HASHMAP_GROUP_SIZE );
+    map->count      = 0;
+    map->growthLeft = MaxLoad( map->capacity );
+}
+
+u8 __namespace( Reserve ) ( HashMap* map, u32 count )
+{
+    u32 capacity = CapacityFor( count );
+    return capacity > map->capacity ? Rehash( map, capacity ) : True;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void* __namespace( Get ) ( const HashMap* map, u64 key )
+{
+    i64 slot = Find( map, key, __namespace( Hash )( key ) );
+    return slot < 0 ? NULL : ValueAt( map, ( u32 )slot );
+}
+
+void* __namespace( Insert ) ( HashMap* map, u64 key, u8* inserted )
+{
+    u64 hash = __namespace( Hash )( key );
+
+    if ( inserted ) *inserted = False;
+
+    i64 found = Find( map, key, hash );
+    if ( found >= 0 ) return ValueAt( map, ( u32 )found );
+
+    /* Out of growth: rehash in place when tombstones are the problem, double otherwise */
+    if ( !map->growthLeft )
+    {
+        u32 capacity = map->capacity;
+        if ( !capacity || map->count >= MaxLoad( capacity ) / 2 )
+            capacity = capacity ? capacity * 2 : HASHMAP_MIN_CAPACITY;
+
+        if ( !Rehash( map, capacity ) ) return NULL;
+    }
+
+    u32 slot = FindFree( map, hash );
+
+    /* Reusing a tombstone does not use up growth, it was already counted */
+    if ( map->ctrl[slot] == CTRL_EMPTY )
+        map->growthLeft--;
+
+    SetCtrl( map, slot, ( u8 )( hash & 0x7F ) );
+    map->keys[slot] = key;
+    map->count++;
+
+    void* value = ValueAt( map, slot );
+    memset( value, 0, map->valueSize );
+
+    if ( inserted ) *inserted = True;
+    return value;
+}
+
+u8 __namespace( Remove ) ( HashMap* map, u64 key )
+{
+    i64 slot = Find( map, key, __namespace( Hash )( key ) );
+    if ( slot < 0 ) return False;
+
+    SetCtrl( map, ( u32 )slot, CTRL_DELETED );
+    map->count--;
+    return True;
+}
+
+u8 __namespace( Next ) ( const HashMap* map, u32* cursor, u64* key, void** value )
+{
+    for ( u32 slot = *cursor; slot < map->capacity; slot++ )
+    {
+        if ( map->ctrl[slot] & 0x80 ) continue;
+
+        if ( key )   *key   = map->keys[slot];
+        if ( value ) *value = ValueAt( map, slot );
+        *cursor = slot + 1;
+        return True;
+    }
+
+    *cursor = map->capacity;
+    return False;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,62 @@
+#ifndef __hashmap_h__
+#define __hashmap_h__
+
+#include <core/types.h>
+#include <core/containers/allocator.h>
+
+#define __namespace( func_name ) core##_##HashMap##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define HASHMAP_GROUP_SIZE   16
+#define HASHMAP_MIN_CAPACITY 16
+
+/*
+ * Open addressing map from u64 keys to fixed size values, SwissTable layout.
+ * One control byte per slot holds 7 bits of the hash, a group of 16 is matched with one SSE2 compare.
+ */
+struct_name ( HashMap )
+{
+    u8*       ctrl;         /* capacity + HASHMAP_GROUP_SIZE bytes, the tail mirrors the first group */
+    u64*      keys;
+    u8*       values;
+    u32       capacity;     /* power of two */
+    u32       count;
+    u32       growthLeft;   /* inserts before the next rehash, tombstones count against it */
+    u32       valueSize;
+    u32       valueAlign;
+    Allocator allocator;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern u8    __namespace( Init )    ( HashMap* map, u32 valueSize, u32 valueAlign, u32 capacity, const Allocator* allocator );
+extern void  __namespace( Free )    ( HashMap* map );
+extern void  __namespace( Clear )   ( HashMap* map );
+extern u8    __namespace( Reserve ) ( HashMap* map, u32 count );
+
+/* Value pointers stay valid until the next insert */
+extern void* __namespace( Get )     ( const HashMap* map, u64 key );
+
+/* Returns the existing value, or a new zeroed one with *inserted set. NULL when growing fails */
+extern void* __namespace( Insert )  ( HashMap* map, u64 key, u8* inserted );
+extern u8    __namespace( Remove )  ( HashMap* map, u64 key );
+
+/* Start with *cursor = 0, returns False when done */
+extern u8    __namespace( Next )    ( const HashMap* map, u32* cursor, u64* key, void** value );
+
+extern u64   __namespace( Hash )    ( u64 key );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define HASHMAP_INIT_TYPE( map, Type, capacity, allocator ) \
+    core_HashMapInit( map, sizeof( Type ), _Alignof( Type ), capacity, allocator )
+#define HASHMAP_GET_TYPE( map, Type, key )    ( ( Type* )core_HashMapGet( map, key ) )
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __hashmap_h__ */
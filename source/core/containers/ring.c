@@ -0,0 +1,102 @@
+#include "ring.h"
+#include <string.h>
+
+#include <core/debug.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Ring##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Init ) ( Ring* ring, u32 stride, u32 capacity, const Allocator* allocator )
+{
+    CHECK_NULL( ring );
+    ASSERT( capacity && capacity <= ( 1u << 31 ), "invalid ring capacity" );
+
+    memset( ring, 0, sizeof( *ring ) );
+
+    u32 rounded = 1;
+    while ( rounded < capacity ) rounded <<= 1;
+
+    ring->stride    = stride;
+    ring->capacity  = rounded;
+    ring->mask      = rounded - 1;
+    ring->allocator = allocator ? *allocator : core_AllocatorHeap( MEMORY_TAG_CORE );
+
+    ring->data = ( u8* )core_AllocatorAlloc( &ring->allocator, ( usize )rounded * stride, 16 );
+    if ( !ring->data )
+    {
+        LOG_ERROR( "Ring: failed to allocate %u elements", rounded );
+        return False;
+    }
+    return True;
+}
+
+void __namespace( Free ) ( Ring* ring )
+{
+    if ( !ring ) return;
+
+    core_AllocatorFree( &ring->allocator, ring->data, ( usize )ring->capacity * ring->stride );
+    ring->data     = NULL;
+    ring->capacity = 0;
+    ring->mask     = 0;
+    atomic_store_explicit( &ring->head, 0, memory_order_relaxed );
+    atomic_store_explicit( &ring->tail, 0, memory_order_relaxed );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Push ) ( Ring* ring, const void* element )
+{
+    u32 tail = atomic_load_explicit( &ring->tail, memory_order_relaxed );
+    u32 head = atomic_load_explicit( &ring->head, memory_order_acquire );
+
+    if ( tail - head == ring->capacity ) return False;
+
+    memcpy( ring->data + ( usize )( tail & ring->mask ) * ring->stride, element, ring->stride );
+    atomic_store_explicit( &ring->tail, tail + 1, memory_order_release );
+    return True;
+}
+
+u8 __namespace( Pop ) ( Ring* ring, void* out )
+{
+    u32 head = atomic_load_explicit( &ring->head, memory_order_relaxed );
+    u32 tail = atomic_load_explicit( &ring->tail, memory_order_acquire );
+
+    if ( head == tail ) return False;
+
+    if ( out )
+        memcpy( out, ring->data + ( usize )( head & ring->mask ) * ring->stride, ring->stride );
+    atomic_store_explicit( &ring->head, head + 1, memory_order_release );
+    return True;
+}
+
+u8 __namespace( Peek ) ( const Ring* ring, void* out )
+{
+    u32 head = atomic_load_explicit( &ring->head, memory_order_relaxed );
+    u32 tail = atomic_load_explicit( &ring->tail, memory_order_acquire );
+
+    if ( head == tail ) return False;
+
+    memcpy( out, ring->data + ( usize )( head & ring->mask ) * ring->stride, ring->stride );
+    return True;
+}
+
+u32 __namespace( Count ) ( const Ring* ring )
+{
+    return atomic_load_explicit( &ring->tail, memory_order_acquire ) -
+           atomic_load_explicit( &ring->head, memory_order_acquire );
+}
+
+/* Consumer side only */
+void __namespace( Clear ) ( Ring* ring )
+{
+    atomic_store_explicit( &ring->head, atomic_load_explicit( &ring->tail, memory_order_acquire ), memory_order_release );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
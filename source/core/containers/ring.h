@@ -0,0 +1,50 @@
+#ifndef __ring_h__
+#define __ring_h__
+
+#include <core/types.h>
+#include <core/containers/allocator.h>
+#include <stdatomic.h>
+
+#define __namespace( func_name ) core##_##Ring##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Fixed capacity FIFO, capacity rounded up to a power of two so wrapping is a mask.
+ * Head and tail run freely, one producer and one consumer thread may use it without a lock.
+ */
+struct_name ( Ring )
+{
+    u8*         data;
+    u32         capacity;
+    u32         mask;
+    u32         stride;
+    _Atomic u32 head;       /* next read, owned by the consumer */
+    _Atomic u32 tail;       /* next write, owned by the producer */
+    Allocator   allocator;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern u8   __namespace( Init )  ( Ring* ring, u32 stride, u32 capacity, const Allocator* allocator );
+extern void __namespace( Free )  ( Ring* ring );
+
+/* Push fails when full, Pop and Peek fail when empty */
+extern u8   __namespace( Push )  ( Ring* ring, const void* element );
+extern u8   __namespace( Pop )   ( Ring* ring, void* out );
+extern u8   __namespace( Peek )  ( const Ring* ring, void* out );
+
+extern u32  __namespace( Count ) ( const Ring* ring );
+extern void __namespace( Clear ) ( Ring* ring );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define RING_INIT_TYPE( ring, Type, capacity, allocator ) core_RingInit( ring, sizeof( Type ), capacity, allocator )
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __ring_h__ */
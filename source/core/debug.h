@@ -206,27 +206,7 @@ static inline void debug_log(DebugLevel level, const char* format, ...) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// OpenGL error checking
-#ifdef DEBUG_OPENGL
-    #include <GL/gl.h>
-    static inline void debug_checkGLError(const char* file, int line) {
-        GLenum err;
-        while ((err = glGetError()) != GL_NO_ERROR) {
-            const char* error = "Unknown error";
-            switch (err) {
-                case GL_INVALID_ENUM:      error = "GL_INVALID_ENUM"; break;
-                case GL_INVALID_VALUE:     error = "GL_INVALID_VALUE"; break;
-                case GL_INVALID_OPERATION: error = "GL_INVALID_OPERATION"; break;
-                case GL_OUT_OF_MEMORY:     error = "GL_OUT_OF_MEMORY"; break;
-                case GL_INVALID_FRAMEBUFFER_OPERATION: error = "GL_INVALID_FRAMEBUFFER_OPERATION"; break;
-            }
-            LOG_ERROR("OpenGL Error: %s at %s:%d", error, file, line);
-        }
-    }
-    #define CHECK_GL_ERROR() debug_checkGLError(__FILE__, __LINE__)
-#else
-    #define CHECK_GL_ERROR() ((void)0)
-#endif
+// OpenGL error checking lives in render/gl_debug.h, next to the KHR_debug callback that replaces it
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -3,17 +3,19 @@
 #include <string.h>
 
 #include <core/debug.h>
+#include <core/containers/array.h>
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #define __namespace( func_name ) core##_##Event##func_name
 
-#define MAX_CALLBACKS 32
+#define EVENT_INITIAL_CALLBACKS 8
 
+/* One list per type, dispatch only walks the callbacks that care about the event */
 static struct 
 {
-    CallbackEntry callbacks[MAX_CALLBACKS];
-    i32 count;
+    Array callbacks[EVENT_TYPE_COUNT];
+    u64 dispatched[EVENT_TYPE_COUNT];
     u8 initialized;
 } eventSystem = {0};
 
@@ -24,6 +26,17 @@ u8 __namespace( Init ) ( )
     ASSERT( eventSystem.initialized != True );
     
     memset( &eventSystem, 0, sizeof( eventSystem ) );
+
+    Allocator allocator = core_AllocatorHeap( MEMORY_TAG_EVENT );
+    for ( u32 type = 0; type < EVENT_TYPE_COUNT; type++ )
+    {
+        if ( !ARRAY_INIT_TYPE( &eventSystem.callbacks[type], CallbackEntry, EVENT_INITIAL_CALLBACKS, &allocator ) )
+        {
+            __namespace( Shutdown )();
+            return False;
+        }
+    }
+
     eventSystem.initialized = True;
 
     return True;
@@ -33,6 +46,9 @@ void __namespace( Shutdown ) ()
 {
  //   ASSERT( eventSystem.initialized != True );
    
+    for ( u32 type = 0; type < EVENT_TYPE_COUNT; type++ )
+        core_ArrayFree( &eventSystem.callbacks[type] );
+
     memset(&eventSystem, 0, sizeof(eventSystem));
     eventSystem.initialized = False;
 }
@@ -42,43 +58,40 @@ void __namespace( RegisterCallback ) ( EventType type, void ( *callback ) ( cons
     ASSERT( eventSystem.initialized != True || callback );
    
     
-    if (eventSystem.count >= MAX_CALLBACKS) {
-        return; // Max callbacks reached
-    }
-    
+    if ( type >= EVENT_TYPE_COUNT ) return;
+
+    Array* callbacks = &eventSystem.callbacks[type];
+
     // Check if callback already registered for this type
-    for (i32 i = 0; i < eventSystem.count; i++) 
+    ARRAY_FOR_EACH( callbacks, CallbackEntry, entry )
     {
-        if (eventSystem.callbacks[i].type == type && 
-            eventSystem.callbacks[i].callback == callback) {
+        if ( entry->callback == callback ) {
             return; // Already registered
         }
     }
     
     // Add new callback
-    eventSystem.callbacks[eventSystem.count].type = type;
-    eventSystem.callbacks[eventSystem.count].callback = callback;
-    eventSystem.count++;
+    CallbackEntry* entry = ARRAY_PUSH_TYPE( callbacks, CallbackEntry );
+    if ( !entry ) return;
+
+    entry->type = type;
+    entry->callback = callback;
 }
 
 void __namespace( UnregisterCallback ) ( EventType type, void ( *callback ) ( const void* event ) )
 {
     ASSERT( eventSystem.initialized != True || callback  );
 
-    // Find and remove callback
-    for ( i32 i = 0; i < eventSystem.count; i++ ) 
+    if ( type >= EVENT_TYPE_COUNT ) return;
+
+    Array* callbacks = &eventSystem.callbacks[type];
+
+    // Find and remove callback, keeping registration order
+    for ( u32 i = 0; i < callbacks->count; i++ ) 
     {
-        if ( eventSystem.callbacks[i].type == type && 
-            eventSystem.callbacks[i].callback == callback ) 
-            {
-            
-            // Shift remaining callbacks
-            for ( i32 j = i; j < eventSystem.count - 1; j++ ) 
-            {
-                eventSystem.callbacks[j] = eventSystem.callbacks[j + 1];
-            }
-            
-            eventSystem.count--;
+        if ( ARRAY_AT( callbacks, CallbackEntry, i ).callback == callback ) 
+        {
+            core_ArrayRemoveOrdered( callbacks, i );
             return;
         }
     }
@@ -89,17 +102,24 @@ void __namespace( Dispache )  ( const void* event )
     ASSERT( eventSystem.initialized != True || event );
 
     EventType type = *( ( EventType* )event );
+
+    if ( type >= EVENT_TYPE_COUNT ) return;
+
+    eventSystem.dispatched[type]++;
     
     // Call all registered callbacks for this event type
-    for ( i32 i = 0; i < eventSystem.count; i++ )
+    Array* callbacks = &eventSystem.callbacks[type];
+    for ( u32 i = 0; i < callbacks->count; i++ )
     {
-        if ( eventSystem.callbacks[i].type == type ) 
-        {
-            eventSystem.callbacks[i].callback( event );
-        }
+        ARRAY_AT( callbacks, CallbackEntry, i ).callback( event );
     }
 }
 
+u64 __namespace( GetDispatchCount ) ( EventType type )
+{
+    return ( type < EVENT_TYPE_COUNT ) ? eventSystem.dispatched[type] : 0;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #undef __namespace
@@ -13,6 +13,7 @@ typedef enum
     EVENT_TYPE_KEYBOARD   = 1,
     EVENT_TYPE_MOUSE      = 2,
     EVENT_TYPE_WINDOW     = 3,
+    EVENT_TYPE_COUNT,
 } EventType;
 
 typedef enum
@@ -68,6 +69,9 @@ extern void __namespace( Dispache )           ( const void* event );
 extern void __namespace( RegisterCallback )   ( EventType type, void ( *callback ) ( const void* event ) );
 extern void __namespace( UnregisterCallback ) ( EventType type, void ( *callback ) ( const void* event ) );
 
+/* Total number of events dispatched for a type since Init */
+extern u64  __namespace( GetDispatchCount )   ( EventType type );
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #undef __namespace
@@ -0,0 +1,193 @@
+#include "handle.h"
+#include <string.h>
+
+#include <core/debug.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Handle##func_name
+
+#define HANDLE_MIN_CAPACITY 16
+
+/* Live slots hold their dense index, free slots hold the next free slot */
+struct HandleSlot
+{
+    u32 index;
+    u16 generation;
+    u16 live;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline Handle MakeHandle( u32 slot, u32 generation )
+{
+    return ( generation << HANDLE_INDEX_BITS ) | slot;
+}
+
+static const HandleSlot* Resolve( const HandleTable* table, Handle handle )
+{
+    u32 slot = HANDLE_INDEX( handle );
+    if ( !handle || slot >= table->slotCount ) return NULL;
+
+    const HandleSlot* entry = &table->slots[slot];
+    if ( !entry->live || entry->generation != HANDLE_GENERATION( handle ) ) return NULL;
+    return entry;
+}
+
+static u8 Grow( HandleTable* table, u32 capacity )
+{
+    capacity = MIN( MAX( capacity, ( u32 )HANDLE_MIN_CAPACITY ), HANDLE_MAX_SLOTS );
+    if ( capacity <= table->capacity ) return False;
+
+    /* Free slots are reused before new ones, so slots never outnumber the item capacity */
+    u8* items = ( u8* )core_MemoryRealloc( table->items, table->itemSize * capacity, table->tag );
+    if ( !items ) return False;
+    table->items = items;
+
+    Handle* owners = ( Handle* )core_MemoryRealloc( table->owners, sizeof( Handle ) * capacity, table->tag );
+    if ( !owners ) return False;
+    table->owners = owners;
+
+    HandleSlot* slots = ( HandleSlot* )core_MemoryRealloc( table->slots, sizeof( HandleSlot ) * capacity, table->tag );
+    if ( !slots ) return False;
+    table->slots = slots;
+
+    table->capacity = capacity;
+    return True;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( TableCreate ) ( HandleTable* table, usize itemSize, u32 capacity, MemoryTag tag )
+{
+    CHECK_NULL( table );
+    memset( table, 0, sizeof( *table ) );
+
+    table->itemSize = itemSize;
+    table->tag      = tag;
+    table->freeSlot = U32_MAX;
+
+    if ( capacity )
+    {
+        if ( !Grow( table, capacity ) )
+        {
+            __namespace( TableDestroy )( table );
+            return False;
+        }
+    }
+    return True;
+}
+
+void __namespace( TableDestroy ) ( HandleTable* table )
+{
+    if ( !table ) return;
+
+    core_MemoryFree( table->items );
+    core_MemoryFree( table->owners );
+    core_MemoryFree( table->slots );
+    memset( table, 0, sizeof( *table ) );
+    table->freeSlot = U32_MAX;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Handle __namespace( Alloc ) ( HandleTable* table, void** item )
+{
+    if ( table->count == table->capacity && !Grow( table, table->capacity * 2 ) )
+    {
+        LOG_ERROR( "Handle table (%s): out of slots at %u items", core_MemoryTagName( table->tag ), table->count );
+        return HANDLE_NULL;
+    }
+
+    u32 slot;
+    if ( table->freeSlot != U32_MAX )
+    {
+        slot = table->freeSlot;
+        table->freeSlot = table->slots[slot].index;
+    }
+    else
+    {
+        slot = table->slotCount++;
+        table->slots[slot].generation = 0;
+    }
+
+    HandleSlot* entry = &table->slots[slot];
+
+    /* Generation bumps on every reuse and skips 0 so HANDLE_NULL stays invalid */
+    entry->generation = ( u16 )( ( entry->generation + 1 ) & HANDLE_GENERATION_MASK );
+    if ( !entry->generation ) entry->generation = 1;
+    entry->index = table->count;
+    entry->live  = True;
+
+    Handle handle = MakeHandle( slot, entry->generation );
+    void*  data   = table->items + ( usize )table->count * table->itemSize;
+
+    memset( data, 0, table->itemSize );
+    table->owners[table->count++] = handle;
+
+    if ( item ) *item = data;
+    return handle;
+}
+
+u8 __namespace( Free ) ( HandleTable* table, Handle handle )
+{
+    if ( !Resolve( table, handle ) ) return False;
+
+    HandleSlot* entry = &table->slots[HANDLE_INDEX( handle )];
+    u32 removed = entry->index;
+    u32 last    = table->count - 1;
+
+    /* Swap the last item into the hole so the dense array stays packed */
+    if ( removed != last )
+    {
+        memcpy( table->items + ( usize )removed * table->itemSize,
+                table->items + ( usize )last * table->itemSize, table->itemSize );
+
+        Handle moved = table->owners[last];
+        table->owners[removed] = moved;
+        table->slots[HANDLE_INDEX( moved )].index = removed;
+    }
+
+    table->count--;
+
+    entry->live  = False;
+    entry->index = table->freeSlot;
+    table->freeSlot = HANDLE_INDEX( handle );
+    return True;
+}
+
+void* __namespace( Get ) ( const HandleTable* table, Handle handle )
+{
+    const HandleSlot* entry = Resolve( table, handle );
+    return entry ? table->items + ( usize )entry->index * table->itemSize : NULL;
+}
+
+u8 __namespace( IsValid ) ( const HandleTable* table, Handle handle )
+{
+    return Resolve( table, handle ) != NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u32 __namespace( Count ) ( const HandleTable* table )
+{
+    return table->count;
+}
+
+void* __namespace( ItemAt ) ( const HandleTable* table, u32 denseIndex )
+{
+    ASSERT( denseIndex < table->count, "dense index out of range" );
+    return table->items + ( usize )denseIndex * table->itemSize;
+}
+
+Handle __namespace( At ) ( const HandleTable* table, u32 denseIndex )
+{
+    ASSERT( denseIndex < table->count, "dense index out of range" );
+    return table->owners[denseIndex];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,66 @@
+#ifndef __handle_h__
+#define __handle_h__
+
+#include <core/types.h>
+#include <core/memory.h>
+
+#define __namespace( func_name ) core##_##Handle##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* 20 bit slot index + 12 bit generation, generation 0 is never issued so 0 is always invalid */
+#define HANDLE_INDEX_BITS       20
+#define HANDLE_GENERATION_BITS  12
+#define HANDLE_MAX_SLOTS        ( 1u << HANDLE_INDEX_BITS )
+#define HANDLE_INDEX_MASK       ( HANDLE_MAX_SLOTS - 1 )
+#define HANDLE_GENERATION_MASK  ( ( 1u << HANDLE_GENERATION_BITS ) - 1 )
+#define HANDLE_NULL             ( ( Handle )0 )
+
+#define HANDLE_INDEX( handle )      ( ( handle ) & HANDLE_INDEX_MASK )
+#define HANDLE_GENERATION( handle ) ( ( handle ) >> HANDLE_INDEX_BITS )
+
+typedef u32 Handle;
+
+typedef struct HandleSlot HandleSlot;
+
+/* Items are packed in a dense array, slots map a handle to its dense position */
+struct_name ( HandleTable )
+{
+    u8*         items;
+    Handle*     owners;         /* dense index -> handle, used to patch the slot on swap-remove */
+    HandleSlot* slots;
+    usize       itemSize;
+    u32         count;
+    u32         capacity;
+    u32         slotCount;
+    u32         freeSlot;       /* head of the free slot list, U32_MAX when empty */
+    MemoryTag   tag;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern u8     __namespace( TableCreate )  ( HandleTable* table, usize itemSize, u32 capacity, MemoryTag tag );
+extern void   __namespace( TableDestroy ) ( HandleTable* table );
+
+/* Item pointers stay valid until the next Alloc or Free on the same table */
+extern Handle __namespace( Alloc )   ( HandleTable* table, void** item );
+extern u8     __namespace( Free )    ( HandleTable* table, Handle handle );
+extern void*  __namespace( Get )     ( const HandleTable* table, Handle handle );
+extern u8     __namespace( IsValid ) ( const HandleTable* table, Handle handle );
+
+/* Linear iteration over live items, order changes on Free */
+extern u32    __namespace( Count )   ( const HandleTable* table );
+extern void*  __namespace( ItemAt )  ( const HandleTable* table, u32 denseIndex );
+extern Handle __namespace( At )      ( const HandleTable* table, u32 denseIndex );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define HANDLE_GET_TYPE( table, Type, handle ) ( ( Type* )core_HandleGet( table, handle ) )
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __handle_h__ */
@@ -0,0 +1,264 @@
+#include "memory.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <core/debug.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Memory##func_name
+
+#define MEMORY_HEADER_MAGIC 0xC0DA
+
+/* 16 bytes keeps the user block aligned like malloc */
+typedef struct
+{
+    u64 size;
+    u32 tag;
+    u32 magic;
+} MemoryHeader;
+
+typedef struct
+{
+    _Atomic u64 liveBytes;
+    _Atomic u64 peakBytes;
+    _Atomic u64 totalAllocs;
+    _Atomic u64 totalFrees;
+    _Atomic u64 totalResizes;
+    _Atomic u64 totalBytes;
+    _Atomic u64 budget;
+    _Atomic u8  overBudget;
+
+    /* Frame snapshots, only touched by EndFrame */
+    u64         lastAllocs;
+    u64         lastBytes;
+    u64         frameAllocs;
+    u64         frameBytes;
+} MemoryCounters;
+
+static MemoryCounters counters[MEMORY_TAG_COUNT];
+
+static const char* tagNames[MEMORY_TAG_COUNT] =
+{
+    "unknown", "core", "event", "profiler", "render", "shader", "asset", "arena", "frame",
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline MemoryTag ValidTag( MemoryTag tag )
+{
+    return ( ( u32 )tag < MEMORY_TAG_COUNT ) ? tag : MEMORY_TAG_UNKNOWN;
+}
+
+static void AddLive( MemoryTag tag, u64 size )
+{
+    MemoryCounters* c = &counters[tag];
+
+    u64 live = atomic_fetch_add_explicit( &c->liveBytes, size, memory_order_relaxed ) + size;
+    atomic_fetch_add_explicit( &c->totalBytes, size, memory_order_relaxed );
+
+    u64 peak = atomic_load_explicit( &c->peakBytes, memory_order_relaxed );
+    while ( live > peak &&
+            !atomic_compare_exchange_weak_explicit( &c->peakBytes, &peak, live,
+                memory_order_relaxed, memory_order_relaxed ) );
+
+    u64 budget = atomic_load_explicit( &c->budget, memory_order_relaxed );
+    if ( budget && live > budget && !atomic_exchange_explicit( &c->overBudget, True, memory_order_relaxed ) )
+    {
+        LOG_WARN( "Memory: tag '%s' over budget (%llu / %llu bytes)",
+            tagNames[tag], ( unsigned long long )live, ( unsigned long long )budget );
+    }
+}
+
+static void SubLive( MemoryTag tag, u64 size )
+{
+    MemoryCounters* c = &counters[tag];
+
+    u64 live = atomic_fetch_sub_explicit( &c->liveBytes, size, memory_order_relaxed ) - size;
+
+    /* Re-arm the warning once the tag is back under budget */
+    u64 budget = atomic_load_explicit( &c->budget, memory_order_relaxed );
+    if ( budget && live <= budget )
+        atomic_store_explicit( &c->overBudget, False, memory_order_relaxed );
+}
+
+static void OnAlloc( MemoryTag tag, u64 size )
+{
+    atomic_fetch_add_explicit( &counters[tag].totalAllocs, 1, memory_order_relaxed );
+    AddLive( tag, size );
+}
+
+static void OnFree( MemoryTag tag, u64 size )
+{
+    atomic_fetch_add_explicit( &counters[tag].totalFrees, 1, memory_order_relaxed );
+    SubLive( tag, size );
+}
+
+/* Only the difference moves the live bytes, growth counts as allocated bytes for the frame */
+static void OnResize( MemoryTag tag, u64 oldSize, u64 newSize )
+{
+    atomic_fetch_add_explicit( &counters[tag].totalResizes, 1, memory_order_relaxed );
+
+    if ( newSize > oldSize )      AddLive( tag, newSize - oldSize );
+    else if ( newSize < oldSize ) SubLive( tag, oldSize - newSize );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void* __namespace( Alloc ) ( usize size, MemoryTag tag )
+{
+    tag = ValidTag( tag );
+
+    MemoryHeader* header = ( MemoryHeader* )malloc( sizeof( MemoryHeader ) + size );
+    if ( !header )
+    {
+        LOG_ERROR( "Memory: failed to allocate %zu bytes for '%s'", size, tagNames[tag] );
+        return NULL;
+    }
+
+    DEBUG_ALLOC( size );
+
+    header->size  = size;
+    header->tag   = tag;
+    header->magic = MEMORY_HEADER_MAGIC;
+
+    OnAlloc( tag, size );
+    return header + 1;
+}
+
+void* __namespace( Calloc ) ( usize count, usize size, MemoryTag tag )
+{
+    if ( size && count > ( usize )-1 / size ) return NULL;
+
+    void* block = __namespace( Alloc )( count * size, tag );
+    if ( block )
+        memset( block, 0, count * size );
+    return block;
+}
+
+void* __namespace( Realloc ) ( void* block, usize size, MemoryTag tag )
+{
+    if ( !block ) return __namespace( Alloc )( size, tag );
+
+    MemoryHeader* header = ( MemoryHeader* )block - 1;
+    ASSERT( header->magic == MEMORY_HEADER_MAGIC, "block not allocated by core_MemoryAlloc" );
+
+    MemoryTag oldTag  = ( MemoryTag )header->tag;
+    u64       oldSize = header->size;
+
+    MemoryHeader* grown = ( MemoryHeader* )realloc( header, sizeof( MemoryHeader ) + size );
+    if ( !grown )
+    {
+        LOG_ERROR( "Memory: failed to reallocate %zu bytes for '%s'", size, tagNames[oldTag] );
+        return NULL;
+    }
+
+    /* The block keeps its original tag */
+    grown->size = size;
+    OnResize( oldTag, oldSize, size );
+
+    UNUSED( tag );
+    return grown + 1;
+}
+
+void __namespace( Free ) ( void* block )
+{
+    if ( !block ) return;
+
+    MemoryHeader* header = ( MemoryHeader* )block - 1;
+    ASSERT( header->magic == MEMORY_HEADER_MAGIC, "block not allocated by core_MemoryAlloc" );
+
+    DEBUG_FREE( block );
+
+    header->magic = 0;
+    OnFree( ( MemoryTag )header->tag, header->size );
+    free( header );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace( Track ) ( MemoryTag tag, i64 bytes )
+{
+    tag = ValidTag( tag );
+
+    if ( bytes > 0 )      OnAlloc( tag, ( u64 )bytes );
+    else if ( bytes < 0 ) OnFree( tag, ( u64 )-bytes );
+}
+
+void __namespace( SetBudget ) ( MemoryTag tag, u64 bytes )
+{
+    tag = ValidTag( tag );
+    atomic_store_explicit( &counters[tag].budget, bytes, memory_order_relaxed );
+    atomic_store_explicit( &counters[tag].overBudget, False, memory_order_relaxed );
+}
+
+MemoryStats __namespace( GetStats ) ( MemoryTag tag )
+{
+    MemoryCounters* c = &counters[ValidTag( tag )];
+
+    MemoryStats stats;
+    stats.liveBytes   = atomic_load_explicit( &c->liveBytes, memory_order_relaxed );
+    stats.peakBytes   = atomic_load_explicit( &c->peakBytes, memory_order_relaxed );
+    stats.totalAllocs = atomic_load_explicit( &c->totalAllocs, memory_order_relaxed );
+    stats.totalFrees   = atomic_load_explicit( &c->totalFrees, memory_order_relaxed );
+    stats.totalResizes = atomic_load_explicit( &c->totalResizes, memory_order_relaxed );
+    stats.budget      = atomic_load_explicit( &c->budget, memory_order_relaxed );
+    stats.frameAllocs = c->frameAllocs;
+    stats.frameBytes  = c->frameBytes;
+    return stats;
+}
+
+const char* __namespace( TagName ) ( MemoryTag tag )
+{
+    return tagNames[ValidTag( tag )];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace( EndFrame ) ( void )
+{
+    for ( u32 tag = 0; tag < MEMORY_TAG_COUNT; tag++ )
+    {
+        MemoryCounters* c = &counters[tag];
+
+        u64 allocs = atomic_load_explicit( &c->totalAllocs, memory_order_relaxed );
+        u64 bytes  = atomic_load_explicit( &c->totalBytes, memory_order_relaxed );
+
+        c->frameAllocs = allocs - c->lastAllocs;
+        c->frameBytes  = bytes - c->lastBytes;
+        c->lastAllocs  = allocs;
+        c->lastBytes   = bytes;
+    }
+}
+
+void __namespace( LogReport ) ( void )
+{
+    LOG_DEBUG( "Memory report:" );
+
+    u32 leaking = 0;
+    for ( u32 tag = 0; tag < MEMORY_TAG_COUNT; tag++ )
+    {
+        MemoryStats stats = __namespace( GetStats )( ( MemoryTag )tag );
+        if ( stats.totalAllocs == 0 ) continue;
+
+        /* Live bytes this late are leaks */
+        leaking += stats.liveBytes != 0;
+
+        debug_log( stats.liveBytes ? DEBUG_LEVEL_WARN : DEBUG_LEVEL_DEBUG,
+            "  %-10s live %10llu  peak %10llu  allocs %8llu  frees %8llu  resizes %8llu  last frame %llu",
+            tagNames[tag],
+            ( unsigned long long )stats.liveBytes, ( unsigned long long )stats.peakBytes,
+            ( unsigned long long )stats.totalAllocs, ( unsigned long long )stats.totalFrees,
+            ( unsigned long long )stats.totalResizes, ( unsigned long long )stats.frameAllocs );
+    }
+
+    if ( leaking )
+        LOG_WARN( "Memory: %u tags still hold live bytes", leaking );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
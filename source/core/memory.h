@@ -0,0 +1,62 @@
+#ifndef __memory_h__
+#define __memory_h__
+
+#include <core/types.h>
+
+#define __namespace( func_name ) core##_##Memory##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef enum
+{
+    MEMORY_TAG_UNKNOWN  = 0,
+    MEMORY_TAG_CORE     = 1,
+    MEMORY_TAG_EVENT    = 2,
+    MEMORY_TAG_PROFILER = 3,
+    MEMORY_TAG_RENDER   = 4,
+    MEMORY_TAG_SHADER   = 5,
+    MEMORY_TAG_ASSET    = 6,
+    MEMORY_TAG_ARENA    = 7,
+    MEMORY_TAG_FRAME    = 8,
+    MEMORY_TAG_COUNT,
+} MemoryTag;
+
+struct_name ( MemoryStats )
+{
+    u64 liveBytes;
+    u64 peakBytes;
+    u64 totalAllocs;
+    u64 totalFrees;
+    u64 totalResizes;       /* Realloc of an existing block, neither an alloc nor a free */
+    u64 frameAllocs;        /* allocations during the last completed frame */
+    u64 frameBytes;         /* bytes allocated during the last completed frame */
+    u64 budget;             /* 0 when unbounded */
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Blocks carry a small header with size and tag, Free needs no tag */
+extern void* __namespace( Alloc )   ( usize size, MemoryTag tag );
+extern void* __namespace( Calloc )  ( usize count, usize size, MemoryTag tag );
+extern void* __namespace( Realloc ) ( void* block, usize size, MemoryTag tag );
+extern void  __namespace( Free )    ( void* block );
+
+/* Accounts memory the tracker does not own (mapped pages, driver allocations) */
+extern void  __namespace( Track )   ( MemoryTag tag, i64 bytes );
+
+extern void        __namespace( SetBudget ) ( MemoryTag tag, u64 bytes );
+extern MemoryStats __namespace( GetStats )  ( MemoryTag tag );
+extern const char* __namespace( TagName )   ( MemoryTag tag );
+
+extern void __namespace( EndFrame )  ( void );
+
+/* Tags that still hold live bytes are logged as warnings, call it last at shutdown as the leak check */
+extern void __namespace( LogReport ) ( void );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __memory_h__ */
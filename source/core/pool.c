@@ -0,0 +1,282 @@
+#include "pool.h"
+#include <string.h>
+
+#include <core/debug.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Pool##func_name
+
+struct PoolSlab
+{
+    PoolSlab* next;
+};
+
+typedef struct
+{
+    u32   poolId;
+    u32   count;
+    void* objects[POOL_THREAD_CACHE_SIZE];
+} PoolThreadCache;
+
+/* Ids are never reused, so entries left behind by a destroyed pool can never match again */
+static _Atomic u32 nextPoolId = 1;
+
+static _Thread_local PoolThreadCache threadCaches[POOL_MAX_THREAD_CACHES];
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline usize AlignUp( usize value, usize align )
+{
+    return ( value + align - 1 ) & ~( align - 1 );
+}
+
+static inline void Lock( Pool* pool )
+{
+    if ( !( pool->flags & POOL_FLAG_THREAD_SAFE ) ) return;
+    while ( atomic_flag_test_and_set_explicit( &pool->lock, memory_order_acquire ) );
+}
+
+static inline void Unlock( Pool* pool )
+{
+    if ( !( pool->flags & POOL_FLAG_THREAD_SAFE ) ) return;
+    atomic_flag_clear_explicit( &pool->lock, memory_order_release );
+}
+
+static inline void CountAlloc( Pool* pool, u64 count )
+{
+    u64 live = atomic_fetch_add_explicit( &pool->liveCount, count, memory_order_relaxed ) + count;
+    u64 peak = atomic_load_explicit( &pool->peakCount, memory_order_relaxed );
+    while ( live > peak &&
+            !atomic_compare_exchange_weak_explicit( &pool->peakCount, &peak, live,
+                memory_order_relaxed, memory_order_relaxed ) );
+}
+
+/* Caller holds the lock */
+static u8 GrowSlab( Pool* pool )
+{
+    usize bytes = sizeof( PoolSlab ) + POOL_CACHE_LINE + pool->objectSize * pool->objectsPerSlab;
+
+    PoolSlab* slab = ( PoolSlab* )core_MemoryAlloc( bytes, pool->tag );
+    if ( !slab ) return False;
+
+    slab->next  = pool->slabs;
+    pool->slabs = slab;
+    pool->slabCount++;
+
+    /* Link back to front so objects come out in address order */
+    u8* data = ( u8* )AlignUp( ( usize )( slab + 1 ), POOL_CACHE_LINE );
+    for ( u32 i = pool->objectsPerSlab; i-- > 0; )
+    {
+        void** object = ( void** )( data + i * pool->objectSize );
+        *object = pool->freeList;
+        pool->freeList = object;
+    }
+    return True;
+}
+
+/* Caller holds the lock */
+static void* PopFree( Pool* pool )
+{
+    if ( !pool->freeList && !GrowSlab( pool ) )
+        return NULL;
+
+    void** object = ( void** )pool->freeList;
+    pool->freeList = *object;
+    return object;
+}
+
+static inline void PushFree( Pool* pool, void* object )
+{
+    *( void** )object = pool->freeList;
+    pool->freeList = object;
+}
+
+static PoolThreadCache* FindCache( const Pool* pool )
+{
+    if ( !( pool->flags & POOL_FLAG_THREAD_CACHE ) ) return NULL;
+
+    PoolThreadCache* empty = NULL;
+    for ( u32 i = 0; i < POOL_MAX_THREAD_CACHES; i++ )
+    {
+        if ( threadCaches[i].poolId == pool->id ) return &threadCaches[i];
+        if ( !empty && !threadCaches[i].count ) empty = &threadCaches[i];
+    }
+
+    if ( empty )
+        empty->poolId = pool->id;
+    return empty;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Create ) ( Pool* pool, usize objectSize, usize align, u32 objectsPerSlab, MemoryTag tag, u32 flags )
+{
+    CHECK_NULL( pool );
+    ASSERT( align && ( align & ( align - 1 ) ) == 0 && align <= POOL_CACHE_LINE, "invalid pool alignment" );
+
+    memset( pool, 0, sizeof( *pool ) );
+
+    if ( flags & POOL_FLAG_THREAD_CACHE )
+        flags |= POOL_FLAG_THREAD_SAFE;
+
+    /* Every free object has to hold the next pointer */
+    pool->align      = MAX( align, sizeof( void* ) );
+    pool->objectSize = AlignUp( MAX( objectSize, sizeof( void* ) ), pool->align );
+    pool->tag        = tag;
+    pool->flags      = flags;
+    pool->id         = atomic_fetch_add_explicit( &nextPoolId, 1, memory_order_relaxed );
+
+    pool->objectsPerSlab = objectsPerSlab ? objectsPerSlab
+                                          : ( u32 )MAX( POOL_DEFAULT_SLAB_SIZE / pool->objectSize, ( usize )1 );
+    atomic_flag_clear( &pool->lock );
+    return True;
+}
+
+void __namespace( Destroy ) ( Pool* pool )
+{
+    if ( !pool || !pool->objectSize ) return;
+
+    u64 live = atomic_load_explicit( &pool->liveCount, memory_order_relaxed );
+    if ( live )
+    {
+        LOG_WARN( "Pool (%s): destroyed with %llu live objects",
+            core_MemoryTagName( pool->tag ), ( unsigned long long )live );
+    }
+
+    /* The objects live in the slabs freed below, dropping the entries is enough */
+    for ( u32 i = 0; i < POOL_MAX_THREAD_CACHES; i++ )
+    {
+        if ( threadCaches[i].poolId != pool->id ) continue;
+
+        if ( threadCaches[i].count )
+            atomic_fetch_sub_explicit( &pool->filledCaches, 1, memory_order_relaxed );
+        memset( &threadCaches[i], 0, sizeof( threadCaches[i] ) );
+    }
+
+    /* Caches of other threads can not be reached from here and would hand out freed memory */
+    ASSERT( atomic_load_explicit( &pool->filledCaches, memory_order_relaxed ) == 0,
+        "pool destroyed while another thread still caches its objects, flush worker caches first" );
+
+    while ( pool->slabs )
+    {
+        PoolSlab* next = pool->slabs->next;
+        core_MemoryFree( pool->slabs );
+        pool->slabs = next;
+    }
+
+    memset( pool, 0, sizeof( *pool ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void* __namespace( Alloc ) ( Pool* pool )
+{
+    PoolThreadCache* cache = FindCache( pool );
+
+    if ( cache )
+    {
+        if ( !cache->count )
+        {
+            Lock( pool );
+            while ( cache->count < POOL_THREAD_CACHE_SIZE / 2 )
+            {
+                void* object = PopFree( pool );
+                if ( !object ) break;
+                cache->objects[cache->count++] = object;
+            }
+            Unlock( pool );
+
+            if ( !cache->count ) goto failed;
+            atomic_fetch_add_explicit( &pool->filledCaches, 1, memory_order_relaxed );
+        }
+
+        CountAlloc( pool, 1 );
+
+        void* object = cache->objects[--cache->count];
+        if ( !cache->count )
+            atomic_fetch_sub_explicit( &pool->filledCaches, 1, memory_order_relaxed );
+        return object;
+    }
+
+    Lock( pool );
+    void* object = PopFree( pool );
+    Unlock( pool );
+
+    if ( !object ) goto failed;
+
+    CountAlloc( pool, 1 );
+    return object;
+
+failed:
+    LOG_ERROR( "Pool (%s): failed to grow by %u objects", core_MemoryTagName( pool->tag ), pool->objectsPerSlab );
+    return NULL;
+}
+
+void* __namespace( AllocZero ) ( Pool* pool )
+{
+    void* object = __namespace( Alloc )( pool );
+    if ( object )
+        memset( object, 0, pool->objectSize );
+    return object;
+}
+
+void __namespace( Free ) ( Pool* pool, void* object )
+{
+    if ( !object ) return;
+
+    atomic_fetch_sub_explicit( &pool->liveCount, 1, memory_order_relaxed );
+
+    PoolThreadCache* cache = FindCache( pool );
+
+    if ( cache )
+    {
+        /* Keep half so alternating alloc/free on a full cache does not ping-pong the lock */
+        if ( cache->count == POOL_THREAD_CACHE_SIZE )
+        {
+            Lock( pool );
+            while ( cache->count > POOL_THREAD_CACHE_SIZE / 2 )
+                PushFree( pool, cache->objects[--cache->count] );
+            Unlock( pool );
+        }
+
+        if ( !cache->count )
+            atomic_fetch_add_explicit( &pool->filledCaches, 1, memory_order_relaxed );
+        cache->objects[cache->count++] = object;
+        return;
+    }
+
+    Lock( pool );
+    PushFree( pool, object );
+    Unlock( pool );
+}
+
+u64 __namespace( LiveCount ) ( const Pool* pool )
+{
+    return atomic_load_explicit( &pool->liveCount, memory_order_relaxed );
+}
+
+void __namespace( FlushThreadCache ) ( Pool* pool )
+{
+    for ( u32 i = 0; i < POOL_MAX_THREAD_CACHES; i++ )
+    {
+        PoolThreadCache* cache = &threadCaches[i];
+        if ( cache->poolId != pool->id ) continue;
+
+        if ( cache->count )
+            atomic_fetch_sub_explicit( &pool->filledCaches, 1, memory_order_relaxed );
+
+        Lock( pool );
+        while ( cache->count )
+            PushFree( pool, cache->objects[--cache->count] );
+        Unlock( pool );
+
+        cache->poolId = 0;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,74 @@
+#ifndef __pool_h__
+#define __pool_h__
+
+#include <core/types.h>
+#include <core/memory.h>
+#include <stdatomic.h>
+
+#define __namespace( func_name ) core##_##Pool##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define POOL_CACHE_LINE          64
+#define POOL_DEFAULT_SLAB_SIZE   KB(16)
+#define POOL_THREAD_CACHE_SIZE   32     /* objects a thread keeps before handing half back */
+#define POOL_MAX_THREAD_CACHES   8      /* cached pools per thread, extra pools go straight to the free-list */
+
+typedef enum
+{
+    POOL_FLAG_NONE         = 0,
+    POOL_FLAG_THREAD_SAFE  = 1 << 0,    /* free-list and slabs behind a spinlock */
+    POOL_FLAG_THREAD_CACHE = 1 << 1,    /* per thread object cache, implies THREAD_SAFE */
+} PoolFlags;
+
+typedef struct PoolSlab PoolSlab;
+
+/* Fixed-size objects carved out of cache line aligned slabs, free objects form an intrusive list */
+struct_name ( Pool )
+{
+    usize       objectSize;
+    usize       align;
+    u32         objectsPerSlab;
+    u32         slabCount;
+    PoolSlab*   slabs;
+    void*       freeList;
+    _Atomic u64 liveCount;
+    _Atomic u64 peakCount;
+    _Atomic u32 filledCaches;   /* thread caches holding objects, across all threads */
+    MemoryTag   tag;
+    u32         flags;
+    u32         id;
+    atomic_flag lock;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* objectsPerSlab of 0 fills POOL_DEFAULT_SLAB_SIZE */
+extern u8    __namespace( Create )    ( Pool* pool, usize objectSize, usize align, u32 objectsPerSlab, MemoryTag tag, u32 flags );
+
+/* Clears the calling thread's cache only, every other thread must have called FlushThreadCache first */
+extern void  __namespace( Destroy )   ( Pool* pool );
+
+extern void* __namespace( Alloc )     ( Pool* pool );
+extern void* __namespace( AllocZero ) ( Pool* pool );
+extern void  __namespace( Free )      ( Pool* pool, void* object );
+
+extern u64   __namespace( LiveCount ) ( const Pool* pool );
+
+/* Returns the calling thread's cached objects, call before a worker thread exits or the pool is destroyed */
+extern void  __namespace( FlushThreadCache ) ( Pool* pool );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define POOL_CREATE_TYPE( pool, Type, perSlab, tag, flags ) \
+    core_PoolCreate( pool, sizeof( Type ), _Alignof( Type ), perSlab, tag, flags )
+#define POOL_ALLOC_TYPE( pool, Type )       ( ( Type* )core_PoolAlloc( pool ) )
+#define POOL_ALLOC_ZERO_TYPE( pool, Type )  ( ( Type* )core_PoolAllocZero( pool ) )
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __pool_h__ */
@@ -0,0 +1,267 @@
+#include "profiler.h"
+#include <string.h>
+
+#include <core/debug.h>
+
+#if PIPE_LINUX
+    #include <time.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Profiler##func_name
+
+static struct
+{
+    ProfilerFrame frames[PROFILER_FRAME_HISTORY];
+    u64           frameIndex;
+    u32           stack[PROFILER_MAX_DEPTH];
+    u32           stackDepth;
+    u32           overflowDepth;                        /* zones begun with the stack full, nothing to pop */
+    u8            inFrame;
+    u8            initialized;
+
+    #if PIPE_WINDOWS
+    f64           ticksToNs;
+    #endif
+} profiler = {0};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline ProfilerFrame* CurrentFrame( void )
+{
+    return &profiler.frames[profiler.frameIndex % PROFILER_FRAME_HISTORY];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Init ) ( void )
+{
+    ASSERT( profiler.initialized != True );
+
+    memset( &profiler, 0, sizeof( profiler ) );
+
+    #if PIPE_WINDOWS
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency( &freq );
+    profiler.ticksToNs = 1000000000.0 / ( f64 )freq.QuadPart;
+    #endif
+
+    profiler.initialized = True;
+    return True;
+}
+
+void __namespace( Shutdown ) ( void )
+{
+    memset( &profiler, 0, sizeof( profiler ) );
+}
+
+u64 __namespace( Now ) ( void )
+{
+    #if PIPE_LINUX
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( u64 )ts.tv_sec * 1000000000ULL + ( u64 )ts.tv_nsec;
+    #else
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter( &counter );
+    return ( u64 )( ( f64 )counter.QuadPart * profiler.ticksToNs );
+    #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace( BeginFrame ) ( void )
+{
+    if ( !profiler.initialized ) return;
+
+    profiler.frameIndex++;
+    profiler.stackDepth    = 0;
+    profiler.overflowDepth = 0;
+    profiler.inFrame       = True;
+
+    ProfilerFrame* frame = CurrentFrame();
+    frame->index        = profiler.frameIndex;
+    frame->start        = __namespace( Now )();
+    frame->end          = frame->start;
+    frame->cpuTime      = 0;
+    frame->gpuTime      = 0;
+    frame->gpuResolved  = False;
+    frame->zoneCount    = 0;
+    frame->droppedZones = 0;
+}
+
+void __namespace( EndFrame ) ( void )
+{
+    if ( !profiler.inFrame ) return;
+
+    /* Close zones left open so the frame stays well formed */
+    profiler.overflowDepth = 0;
+    while ( profiler.stackDepth > 0 )
+        __namespace( ZoneEnd )();
+
+    ProfilerFrame* frame = CurrentFrame();
+    frame->end     = __namespace( Now )();
+    frame->cpuTime = frame->end - frame->start;
+
+    profiler.inFrame = False;
+}
+
+u64 __namespace( GetFrameIndex ) ( void )
+{
+    return profiler.frameIndex;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace( ZoneBegin ) ( const char* name )
+{
+    if ( !profiler.inFrame ) return;
+
+    ProfilerFrame* frame = CurrentFrame();
+
+    /* Past the deepest level only count it, the matching ZoneEnd then leaves the stack alone */
+    if ( profiler.stackDepth >= PROFILER_MAX_DEPTH )
+    {
+        profiler.overflowDepth++;
+        frame->droppedZones++;
+        return;
+    }
+
+    /* Out of zones, push a placeholder so the matching ZoneEnd stays balanced */
+    if ( frame->zoneCount >= PROFILER_MAX_ZONES )
+    {
+        profiler.stack[profiler.stackDepth++] = U32_MAX;
+        frame->droppedZones++;
+        return;
+    }
+
+    ProfilerZone* zone = &frame->zones[frame->zoneCount];
+    zone->name  = name;
+    zone->start = __namespace( Now )();
+    zone->end   = zone->start;
+    zone->depth = ( u8 )profiler.stackDepth;
+    zone->track = PROFILER_TRACK_CPU;
+
+    profiler.stack[profiler.stackDepth++] = frame->zoneCount++;
+}
+
+void __namespace( ZoneEnd ) ( void )
+{
+    if ( !profiler.inFrame ) return;
+
+    if ( profiler.overflowDepth > 0 )
+    {
+        profiler.overflowDepth--;
+        return;
+    }
+    if ( profiler.stackDepth == 0 ) return;
+
+    u32 index = profiler.stack[--profiler.stackDepth];
+    if ( index == U32_MAX ) return;
+
+    CurrentFrame()->zones[index].end = __namespace( Now )();
+}
+
+void __namespace( ScopeEnd ) ( const char** name )
+{
+    UNUSED( name );
+    __namespace( ZoneEnd )();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace( SubmitGpuZone ) ( u64 frameIndex, const char* name, u64 start, u64 end, u8 depth )
+{
+    ProfilerFrame* frame = &profiler.frames[frameIndex % PROFILER_FRAME_HISTORY];
+
+    /* The slot was already recycled, results came back too late */
+    if ( frame->index != frameIndex ) return;
+
+    if ( frame->zoneCount >= PROFILER_MAX_ZONES )
+    {
+        frame->droppedZones++;
+        return;
+    }
+
+    ProfilerZone* zone = &frame->zones[frame->zoneCount++];
+    zone->name  = name;
+    zone->start = start;
+    zone->end   = end;
+    zone->depth = depth;
+    zone->track = PROFILER_TRACK_GPU;
+
+    if ( depth == 0 )
+        frame->gpuTime += end - start;
+}
+
+void __namespace( ResolveGpu ) ( u64 frameIndex )
+{
+    ProfilerFrame* frame = &profiler.frames[frameIndex % PROFILER_FRAME_HISTORY];
+    if ( frame->index == frameIndex )
+        frame->gpuResolved = True;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const ProfilerFrame* __namespace( GetFrame ) ( u64 frameIndex )
+{
+    const ProfilerFrame* frame = &profiler.frames[frameIndex % PROFILER_FRAME_HISTORY];
+    return ( frameIndex != 0 && frame->index == frameIndex ) ? frame : NULL;
+}
+
+ProfilerBound __namespace( GetBound ) ( const ProfilerFrame* frame, const ProfilerZone** hottest )
+{
+    if ( hottest ) *hottest = NULL;
+    if ( !frame || !frame->gpuResolved ) return PROFILER_BOUND_UNKNOWN;
+
+    ProfilerTrack track = ( frame->gpuTime > frame->cpuTime ) ? PROFILER_TRACK_GPU : PROFILER_TRACK_CPU;
+
+    /* The most expensive top level zone on the limiting track is the one to look at */
+    if ( hottest )
+    {
+        u64 best = 0;
+        for ( u32 i = 0; i < frame->zoneCount; i++ )
+        {
+            const ProfilerZone* zone = &frame->zones[i];
+            if ( zone->track == track && zone->depth == 0 && zone->end - zone->start >= best )
+            {
+                best     = zone->end - zone->start;
+                *hottest = zone;
+            }
+        }
+    }
+
+    return ( track == PROFILER_TRACK_GPU ) ? PROFILER_BOUND_GPU : PROFILER_BOUND_CPU;
+}
+
+void __namespace( LogFrame ) ( const ProfilerFrame* frame )
+{
+    if ( !frame ) return;
+
+    const ProfilerZone* hottest = NULL;
+    ProfilerBound bound = __namespace( GetBound )( frame, &hottest );
+
+    const char* boundStr = ( bound == PROFILER_BOUND_GPU ) ? "GPU" :
+                           ( bound == PROFILER_BOUND_CPU ) ? "CPU" : "?";
+
+    LOG_DEBUG( "Frame %llu: cpu %.3f ms, gpu %.3f ms, %s bound (%s)",
+        ( unsigned long long )frame->index,
+        frame->cpuTime / 1000000.0, frame->gpuTime / 1000000.0,
+        boundStr, hottest ? hottest->name : "-" );
+
+    for ( u32 i = 0; i < frame->zoneCount; i++ )
+    {
+        const ProfilerZone* zone = &frame->zones[i];
+        LOG_TRACE( "  %s %*s%s: %.3f ms",
+            zone->track == PROFILER_TRACK_GPU ? "[GPU]" : "[CPU]",
+            zone->depth * 2, "", zone->name,
+            ( zone->end - zone->start ) / 1000000.0 );
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
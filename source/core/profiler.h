@@ -0,0 +1,92 @@
+#ifndef __profiler_h__
+#define __profiler_h__
+
+#include <core/types.h>
+
+#define __namespace( func_name ) core##_##Profiler##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define PROFILER_MAX_ZONES      128     /* CPU + GPU zones kept per frame */
+#define PROFILER_MAX_DEPTH      16
+#define PROFILER_FRAME_HISTORY  8       /* must cover the GPU readback latency */
+
+typedef enum
+{
+    PROFILER_TRACK_CPU    = 0,
+    PROFILER_TRACK_GPU    = 1,
+} ProfilerTrack;
+
+typedef enum
+{
+    PROFILER_BOUND_UNKNOWN = 0,
+    PROFILER_BOUND_CPU     = 1,
+    PROFILER_BOUND_GPU     = 2,
+} ProfilerBound;
+
+/* All timestamps are nanoseconds on the CPU monotonic clock, GPU zones are converted on submit */
+struct_name ( ProfilerZone )
+{
+    const char* name;
+    u64         start;
+    u64         end;
+    u8          depth;
+    u8          track;
+};
+
+struct_name ( ProfilerFrame )
+{
+    u64          index;
+    u64          start;
+    u64          end;
+    u64          cpuTime;
+    u64          gpuTime;
+    u8           gpuResolved;
+    u32          zoneCount;
+    u32          droppedZones;
+    ProfilerZone zones[PROFILER_MAX_ZONES];
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern u8   __namespace( Init )          ( void );
+extern void __namespace( Shutdown )      ( void );
+extern u64  __namespace( Now )           ( void );
+
+extern void __namespace( BeginFrame )    ( void );
+extern void __namespace( EndFrame )      ( void );
+extern u64  __namespace( GetFrameIndex ) ( void );
+
+/* CPU zones, main thread only */
+extern void __namespace( ZoneBegin )     ( const char* name );
+extern void __namespace( ZoneEnd )       ( void );
+extern void __namespace( ScopeEnd )      ( const char** name );
+
+/* GPU zones arrive a few frames late and are merged into the frame they were recorded in */
+extern void __namespace( SubmitGpuZone ) ( u64 frameIndex, const char* name, u64 start, u64 end, u8 depth );
+extern void __namespace( ResolveGpu )    ( u64 frameIndex );
+
+extern const ProfilerFrame* __namespace( GetFrame ) ( u64 frameIndex );
+extern ProfilerBound        __namespace( GetBound ) ( const ProfilerFrame* frame, const ProfilerZone** hottest );
+extern void                 __namespace( LogFrame ) ( const ProfilerFrame* frame );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define PROFILE_CONCAT_( a, b ) a##b
+#define PROFILE_CONCAT( a, b )  PROFILE_CONCAT_( a, b )
+
+#define PROFILE_BEGIN( name )   core_ProfilerZoneBegin( name )
+#define PROFILE_END()           core_ProfilerZoneEnd()
+
+/* Closes the zone when the enclosing block exits */
+#define PROFILE_SCOPE( name ) \
+    const char* PROFILE_CONCAT( _profile_scope_, __LINE__ ) \
+        __attribute__((cleanup(core_ProfilerScopeEnd))) = ( core_ProfilerZoneBegin( name ), name )
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __profiler_h__ */
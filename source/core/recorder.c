@@ -0,0 +1,291 @@
+#include "recorder.h"
+#include <stdio.h>
+#include <string.h>
+
+#include <core/debug.h>
+#include <core/profiler.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Recorder##func_name
+
+/* Frames are recorded once GPU zones have been merged, the oldest frame in the profiler history */
+#define RECORDER_SETTLE_FRAMES  ( PROFILER_FRAME_HISTORY - 1 )
+#define RECORDER_MEDIAN_INTERVAL 30
+
+static struct
+{
+    RecorderFrame  frames[RECORDER_FRAME_CAPACITY];
+    u64            head;                                /* number of frames ever recorded */
+    RecorderConfig config;
+
+    u32            eventDeltas[PROFILER_FRAME_HISTORY][EVENT_TYPE_COUNT];
+    u64            eventTotals[EVENT_TYPE_COUNT];
+
+    u64            medianFrameTime;
+    u64            scratch[RECORDER_FRAME_CAPACITY];
+
+    u64            spikeIndex;
+    u32            postRemaining;
+    u64            lastDumpIndex;
+    u8             armed;
+    u8             initialized;
+} recorder = {0};
+
+static const char* eventNames[EVENT_TYPE_COUNT] = { "none", "keyboard", "mouse", "window" };
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Zone names are user strings, quote them as a JSON string */
+static void WriteString( FILE* f, const char* text )
+{
+    fputc( '"', f );
+    for ( const char* c = text; *c; c++ )
+    {
+        if ( *c == '"' || *c == '\\' )
+            fprintf( f, "\\%c", *c );
+        else if ( ( unsigned char )*c < 0x20 )
+            fprintf( f, "\\u%04x", ( unsigned char )*c );
+        else
+            fputc( *c, f );
+    }
+    fputc( '"', f );
+}
+
+static u64 SelectMedian( u64* values, u32 count )
+{
+    i64 k = count / 2, lo = 0, hi = ( i64 )count - 1;
+
+    /* Quickselect, partial ordering is all the median needs */
+    while ( lo < hi )
+    {
+        u64 pivot = values[( lo + hi ) / 2];
+        i64 i = lo, j = hi;
+
+        while ( i <= j )
+        {
+            while ( values[i] < pivot ) i++;
+            while ( values[j] > pivot ) j--;
+            if ( i <= j )
+            {
+                u64 tmp = values[i]; values[i] = values[j]; values[j] = tmp;
+                i++; j--;
+            }
+        }
+
+        if ( k <= j )      hi = j;
+        else if ( k >= i ) lo = i;
+        else               break;
+    }
+
+    return values[k];
+}
+
+static void UpdateMedian( void )
+{
+    u32 count = ( u32 )MIN( recorder.head, ( u64 )RECORDER_FRAME_CAPACITY );
+    if ( count == 0 ) return;
+
+    for ( u32 i = 0; i < count; i++ )
+        recorder.scratch[i] = recorder.frames[i].frameTime;
+
+    recorder.medianFrameTime = SelectMedian( recorder.scratch, count );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void RecordFrame( const ProfilerFrame* frame, const ProfilerFrame* next )
+{
+    RecorderFrame* rec = &recorder.frames[recorder.head % RECORDER_FRAME_CAPACITY];
+
+    rec->index     = frame->index;
+    rec->start     = frame->start;
+    rec->frameTime = next->start - frame->start;
+    rec->cpuTime   = frame->cpuTime;
+    rec->gpuTime   = frame->gpuTime;
+
+    memcpy( rec->events, recorder.eventDeltas[frame->index % PROFILER_FRAME_HISTORY], sizeof( rec->events ) );
+
+    rec->zoneCount = 0;
+    for ( u32 i = 0; i < frame->zoneCount && rec->zoneCount < RECORDER_MAX_ZONES; i++ )
+    {
+        const ProfilerZone* zone = &frame->zones[i];
+        RecorderZone* dst = &rec->zones[rec->zoneCount++];
+
+        dst->name     = zone->name;
+        dst->offset   = ( i32 )( ( i64 )zone->start - ( i64 )frame->start );
+        dst->duration = ( u32 )MIN( zone->end - zone->start, ( u64 )U32_MAX );
+        dst->depth    = zone->depth;
+        dst->track    = zone->track;
+    }
+
+    recorder.head++;
+}
+
+static u8 IsSpike( const RecorderFrame* rec )
+{
+    if ( recorder.head < RECORDER_WARMUP_FRAMES || recorder.medianFrameTime == 0 )
+        return False;
+
+    f64 budget = ( f64 )recorder.medianFrameTime * recorder.config.medianFactor;
+    f64 floor  = ( f64 )recorder.config.budgetMs * 1000000.0;
+
+    return ( f64 )rec->frameTime > MAX( budget, floor );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Init ) ( const RecorderConfig* config )
+{
+    ASSERT( recorder.initialized != True );
+
+    memset( &recorder, 0, sizeof( recorder ) );
+
+    recorder.config.medianFactor   = 2.0f;
+    recorder.config.budgetMs       = 0.0f;
+    recorder.config.cooldownFrames = RECORDER_FRAME_CAPACITY;
+    recorder.config.outputDir      = ".";
+
+    if ( config )
+        __namespace( SetConfig )( config );
+
+    for ( u32 type = 0; type < EVENT_TYPE_COUNT; type++ )
+        recorder.eventTotals[type] = core_EventGetDispatchCount( ( EventType )type );
+
+    recorder.initialized = True;
+    return True;
+}
+
+void __namespace( Shutdown ) ( void )
+{
+    memset( &recorder, 0, sizeof( recorder ) );
+}
+
+void __namespace( SetConfig ) ( const RecorderConfig* config )
+{
+    CHECK_NULL_RET( config, );
+
+    recorder.config = *config;
+
+    if ( recorder.config.medianFactor <= 1.0f ) recorder.config.medianFactor = 2.0f;
+    if ( !recorder.config.outputDir )          recorder.config.outputDir = ".";
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace( EndFrame ) ( void )
+{
+    if ( !recorder.initialized ) return;
+
+    u64 current = core_ProfilerGetFrameIndex();
+
+    /* Events are attributed now, the frame itself is recorded once it has settled */
+    u32* deltas = recorder.eventDeltas[current % PROFILER_FRAME_HISTORY];
+    for ( u32 type = 0; type < EVENT_TYPE_COUNT; type++ )
+    {
+        u64 total = core_EventGetDispatchCount( ( EventType )type );
+        deltas[type] = ( u32 )( total - recorder.eventTotals[type] );
+        recorder.eventTotals[type] = total;
+    }
+
+    if ( current <= RECORDER_SETTLE_FRAMES ) return;
+
+    const ProfilerFrame* frame = core_ProfilerGetFrame( current - RECORDER_SETTLE_FRAMES );
+    const ProfilerFrame* next  = core_ProfilerGetFrame( current - RECORDER_SETTLE_FRAMES + 1 );
+    if ( !frame || !next ) return;
+
+    RecordFrame( frame, next );
+
+    if ( recorder.head % RECORDER_MEDIAN_INTERVAL == 0 )
+        UpdateMedian();
+
+    const RecorderFrame* rec = &recorder.frames[( recorder.head - 1 ) % RECORDER_FRAME_CAPACITY];
+
+    if ( !recorder.armed && IsSpike( rec ) &&
+         ( recorder.lastDumpIndex == 0 || rec->index - recorder.lastDumpIndex >= recorder.config.cooldownFrames ) )
+    {
+        LOG_WARN( "Frame spike: frame %llu took %.2f ms (median %.2f ms)",
+            ( unsigned long long )rec->index, rec->frameTime / 1000000.0, recorder.medianFrameTime / 1000000.0 );
+
+        recorder.armed         = True;
+        recorder.spikeIndex    = rec->index;
+        recorder.postRemaining = RECORDER_POST_FRAMES;
+        return;
+    }
+
+    if ( recorder.armed && --recorder.postRemaining == 0 )
+    {
+        char path[512];
+        snprintf( path, sizeof( path ), "%s/coda_spike_%llu.json",
+            recorder.config.outputDir, ( unsigned long long )recorder.spikeIndex );
+
+        if ( __namespace( Dump )( path ) )
+            LOG_INFO( "Frame spike trace written to %s", path );
+
+        recorder.armed         = False;
+        recorder.lastDumpIndex = recorder.spikeIndex;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Dump ) ( const char* path )
+{
+    u64 count = MIN( recorder.head, ( u64 )RECORDER_FRAME_CAPACITY );
+    if ( count == 0 ) return False;
+
+    FILE* f = fopen( path, "w" );
+    if ( !f )
+    {
+        LOG_ERROR( "Recorder: failed to open %s", path );
+        return False;
+    }
+
+    u64 first = recorder.head - count;
+    u64 origin = recorder.frames[first % RECORDER_FRAME_CAPACITY].start;
+
+    fprintf( f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+    fprintf( f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n" );
+    fprintf( f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}},\n" );
+    fprintf( f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":2,\"args\":{\"name\":\"Frames\"}}" );
+
+    for ( u64 n = first; n < recorder.head; n++ )
+    {
+        const RecorderFrame* rec = &recorder.frames[n % RECORDER_FRAME_CAPACITY];
+        f64 ts = ( rec->start - origin ) / 1000.0;
+
+        fprintf( f, ",\n{\"name\":\"Frame %llu\",\"ph\":\"X\",\"pid\":0,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"cpu_ms\":%.3f,\"gpu_ms\":%.3f}}",
+            ( unsigned long long )rec->index, ts, rec->frameTime / 1000.0,
+            rec->cpuTime / 1000000.0, rec->gpuTime / 1000000.0 );
+
+        for ( u32 i = 0; i < rec->zoneCount; i++ )
+        {
+            const RecorderZone* zone = &rec->zones[i];
+            fprintf( f, ",\n{\"name\":" );
+            WriteString( f, zone->name ? zone->name : "?" );
+            fprintf( f, ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                ( u32 )zone->track, ts + zone->offset / 1000.0, zone->duration / 1000.0 );
+        }
+
+        fprintf( f, ",\n{\"name\":\"events\",\"ph\":\"C\",\"pid\":0,\"ts\":%.3f,\"args\":{", ts );
+        for ( u32 type = 1; type < EVENT_TYPE_COUNT; type++ )
+            fprintf( f, "%s\"%s\":%u", type > 1 ? "," : "", eventNames[type], rec->events[type] );
+        fprintf( f, "}}" );
+
+        if ( rec->index == recorder.spikeIndex && recorder.armed )
+            fprintf( f, ",\n{\"name\":\"spike\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":2,\"ts\":%.3f}", ts );
+    }
+
+    fprintf( f, "\n]}\n" );
+
+    u8 ok = !ferror( f );
+    fclose( f );
+    return ok;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,64 @@
+#ifndef __recorder_h__
+#define __recorder_h__
+
+#include <core/types.h>
+#include <core/event.h>
+
+#define __namespace( func_name ) core##_##Recorder##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define RECORDER_FRAME_CAPACITY 512     /* ~8 s at 60 fps */
+#define RECORDER_MAX_ZONES      48
+#define RECORDER_POST_FRAMES    60      /* frames captured after a spike before the dump */
+#define RECORDER_WARMUP_FRAMES  120     /* no spikes reported until the median is meaningful */
+
+struct_name ( RecorderConfig )
+{
+    f32         medianFactor;           /* spike when frame time > median * factor */
+    f32         budgetMs;               /* absolute floor for the budget, 0 disables */
+    u32         cooldownFrames;         /* minimum distance between two dumps */
+    const char* outputDir;
+};
+
+/* Zone names must outlive the recorder, string literals in practice */
+struct_name ( RecorderZone )
+{
+    const char* name;
+    i32         offset;                 /* ns from frame start */
+    u32         duration;               /* ns */
+    u8          depth;
+    u8          track;
+};
+
+struct_name ( RecorderFrame )
+{
+    u64          index;
+    u64          start;
+    u64          frameTime;             /* start to start of the next frame */
+    u64          cpuTime;
+    u64          gpuTime;
+    u32          events[EVENT_TYPE_COUNT];
+    u32          zoneCount;
+    RecorderZone zones[RECORDER_MAX_ZONES];
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern u8   __namespace( Init )      ( const RecorderConfig* config );
+extern void __namespace( Shutdown )  ( void );
+extern void __namespace( SetConfig ) ( const RecorderConfig* config );
+
+/* Call once per frame after core_ProfilerEndFrame */
+extern void __namespace( EndFrame )  ( void );
+
+/* Writes the whole ring as a Chrome trace (chrome://tracing, Perfetto) */
+extern u8   __namespace( Dump )      ( const char* path );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __recorder_h__ */
@@ -0,0 +1,155 @@
+#include "strid.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <core/debug.h>
+#include <core/vmem.h>
+#include <core/containers/hashmap.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##StrId##func_name
+
+#define STRID_STRINGS_RESERVE MB(16)
+#define STRID_INITIAL_NAMES   256
+
+#if STRID_REVERSE_LOOKUP
+static struct
+{
+    HashMap     names;      /* StringId -> const char* */
+    VArena      strings;    /* names never move once recorded, pages are committed as they fill */
+    atomic_flag lock;
+    u8          initialized;
+} strid = { .lock = ATOMIC_FLAG_INIT };
+#endif
+
+static _Thread_local char nameBuffer[24];
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if STRID_REVERSE_LOOKUP
+
+static inline void Lock( void )
+{
+    while ( atomic_flag_test_and_set_explicit( &strid.lock, memory_order_acquire ) );
+}
+
+static inline void Unlock( void )
+{
+    atomic_flag_clear_explicit( &strid.lock, memory_order_release );
+}
+
+/* Caller holds the lock */
+static u8 EnsureInitialized( void )
+{
+    if ( strid.initialized ) return True;
+
+    if ( !core_VmemArenaCreate( &strid.strings, STRID_STRINGS_RESERVE, VMEM_PAGES_DEFAULT, MEMORY_TAG_CORE ) )
+        return False;
+
+    Allocator allocator = core_AllocatorHeap( MEMORY_TAG_CORE );
+    if ( !HASHMAP_INIT_TYPE( &strid.names, const char*, STRID_INITIAL_NAMES, &allocator ) )
+    {
+        core_VmemArenaDestroy( &strid.strings );
+        return False;
+    }
+
+    strid.initialized = True;
+    return True;
+}
+
+static void Record( StringId id, const char* str, usize length )
+{
+    Lock();
+
+    if ( EnsureInitialized() )
+    {
+        u8 inserted;
+        const char** name = ( const char** )core_HashMapInsert( &strid.names, id, &inserted );
+
+        if ( name && inserted )
+        {
+            char* copy = ( char* )core_VmemArenaPush( &strid.strings, length + 1, 1 );
+            if ( copy )
+            {
+                memcpy( copy, str, length );
+                copy[length] = '\0';
+            }
+            *name = copy;
+        }
+        else if ( name && *name && strcmp( *name, str ) != 0 )
+        {
+            LOG_ERROR( "StringId collision: '%s' and '%s' both hash to %016llx", *name, str, ( unsigned long long )id );
+        }
+    }
+
+    Unlock();
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+StringId __namespace( Intern ) ( const char* str )
+{
+    if ( !str ) return STRID_NONE;
+
+    usize    length = strlen( str );
+    StringId id     = __namespace( Hash )( str, length );
+
+    #if STRID_REVERSE_LOOKUP
+    Record( id, str, length );
+    #endif
+
+    return id;
+}
+
+const char* __namespace( Lookup ) ( StringId id )
+{
+    #if STRID_REVERSE_LOOKUP
+    const char* name = NULL;
+
+    Lock();
+    if ( strid.initialized )
+    {
+        const char** entry = HASHMAP_GET_TYPE( &strid.names, const char*, id );
+        if ( entry ) name = *entry;
+    }
+    Unlock();
+
+    return name;
+    #else
+    UNUSED( id );
+    return NULL;
+    #endif
+}
+
+const char* __namespace( Name ) ( StringId id )
+{
+    const char* name = __namespace( Lookup )( id );
+    if ( name ) return name;
+
+    snprintf( nameBuffer, sizeof( nameBuffer ), "#%016llx", ( unsigned long long )id );
+    return nameBuffer;
+}
+
+void __namespace( Shutdown ) ( void )
+{
+    #if STRID_REVERSE_LOOKUP
+    Lock();
+    if ( strid.initialized )
+    {
+        core_HashMapFree( &strid.names );
+        core_VmemArenaDestroy( &strid.strings );
+        strid.initialized = False;
+    }
+    Unlock();
+    #endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
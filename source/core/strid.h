@@ -0,0 +1,75 @@
+#ifndef __strid_h__
+#define __strid_h__
+
+#include <core/types.h>
+
+#define __namespace( func_name ) core##_##StrId##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Reverse lookup keeps a copy of every interned string, on by default outside release builds */
+#ifndef STRID_REVERSE_LOOKUP
+    #ifdef NDEBUG
+        #define STRID_REVERSE_LOOKUP 0
+    #else
+        #define STRID_REVERSE_LOOKUP 1
+    #endif
+#endif
+
+#define STRID_FNV_OFFSET 0xcbf29ce484222325ULL
+#define STRID_FNV_PRIME  0x100000001b3ULL
+#define STRID_NONE       ( ( StringId )0 )
+
+/* 64 bit FNV-1a of a name, compare these instead of strings */
+typedef u64 StringId;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline StringId __namespace( Hash ) ( const char* str, usize length )
+{
+    StringId hash = STRID_FNV_OFFSET;
+    for ( usize i = 0; i < length; i++ )
+    {
+        hash ^= ( u8 )str[i];
+        hash *= STRID_FNV_PRIME;
+    }
+    return hash;
+}
+
+/* Hashes and, with reverse lookup on, records the string so the id can be printed later */
+extern StringId    __namespace( Intern )   ( const char* str );
+
+/* Interned string for an id, NULL when unknown or reverse lookup is off */
+extern const char* __namespace( Lookup )   ( StringId id );
+
+/* Never NULL, falls back to the id in hex. The buffer is reused per thread */
+extern const char* __namespace( Name )     ( StringId id );
+
+extern void        __namespace( Shutdown ) ( void );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Literal only. Literals up to STRID_LITERAL_MAX chars are hashed by an unrolled expression the compiler folds
+ * into a constant, each step past the end xors 0 and multiplies by 1. Longer literals hash at runtime.
+ */
+#define STRID_LITERAL_MAX 64
+
+#define STRID_CHAR( s, i )    ( ( i ) < sizeof( s ) - 1 ? ( u8 )( s )[( i ) < sizeof( s ) ? ( i ) : 0] : 0 )
+#define STRID_MUL( s, i )     ( ( i ) < sizeof( s ) - 1 ? STRID_FNV_PRIME : 1ULL )
+#define STRID_STEP( h, s, i ) ( ( ( h ) ^ STRID_CHAR( s, i ) ) * STRID_MUL( s, i ) )
+#define STRID_4( h, s, i )    STRID_STEP( STRID_STEP( STRID_STEP( STRID_STEP( h, s, i ), s, i + 1 ), s, i + 2 ), s, i + 3 )
+#define STRID_16( h, s, i )   STRID_4( STRID_4( STRID_4( STRID_4( h, s, i ), s, i + 4 ), s, i + 8 ), s, i + 12 )
+#define STRID_64( h, s, i )   STRID_16( STRID_16( STRID_16( STRID_16( h, s, i ), s, i + 16 ), s, i + 32 ), s, i + 48 )
+
+#define SID( literal ) \
+    ( sizeof( "" literal ) - 1 <= STRID_LITERAL_MAX ? ( StringId )STRID_64( STRID_FNV_OFFSET, "" literal, 0 ) \
+                                                    : core_StrIdHash( "" literal, sizeof( literal ) - 1 ) )
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __strid_h__ */
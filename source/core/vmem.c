@@ -0,0 +1,338 @@
+#include "vmem.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <core/debug.h>
+
+#if PIPE_LINUX
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define __namespace( func_name ) core##_##Vmem##func_name
+
+static struct
+{
+    _Atomic u64 reservedBytes;
+    _Atomic u64 committedBytes;
+    _Atomic u64 commitCalls;
+    _Atomic u64 decommitCalls;
+    usize       pageSize;
+    usize       hugePageSize;
+} vmem = {0};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline usize AlignUp( usize value, usize align )
+{
+    return ( value + align - 1 ) & ~( align - 1 );
+}
+
+usize __namespace( PageSize ) ( void )
+{
+    if ( !vmem.pageSize )
+    {
+        #if PIPE_LINUX
+        vmem.pageSize = ( usize )sysconf( _SC_PAGESIZE );
+        #else
+        SYSTEM_INFO info;
+        GetSystemInfo( &info );
+        vmem.pageSize = info.dwPageSize;
+        #endif
+    }
+    return vmem.pageSize;
+}
+
+usize __namespace( HugePageSize ) ( void )
+{
+    if ( !vmem.hugePageSize )
+    {
+        vmem.hugePageSize = MB(2);
+
+        #if PIPE_LINUX
+        FILE* f = fopen( "/proc/meminfo", "r" );
+        if ( f )
+        {
+            char line[128];
+            unsigned long kb = 0;
+            while ( fgets( line, sizeof( line ), f ) )
+            {
+                if ( sscanf( line, "Hugepagesize: %lu kB", &kb ) == 1 && kb )
+                {
+                    vmem.hugePageSize = ( usize )kb * 1024;
+                    break;
+                }
+            }
+            fclose( f );
+        }
+        #else
+        usize large = GetLargePageMinimum();
+        if ( large ) vmem.hugePageSize = large;
+        #endif
+    }
+    return vmem.hugePageSize;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if PIPE_LINUX
+
+static void* ReserveAligned( usize size, usize align )
+{
+    /* Over-reserve and trim so the range starts on a huge page boundary */
+    usize total = size + align;
+    u8* raw = ( u8* )mmap( NULL, total, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+    if ( raw == MAP_FAILED ) return NULL;
+
+    u8* aligned = ( u8* )AlignUp( ( usize )raw, align );
+    usize head = ( usize )( aligned - raw );
+    usize tail = total - head - size;
+
+    if ( head ) munmap( raw, head );
+    if ( tail ) munmap( aligned + size, tail );
+    return aligned;
+}
+
+void* __namespace( Reserve ) ( usize size, VmemPageMode* mode )
+{
+    VmemPageMode requested = mode ? *mode : VMEM_PAGES_DEFAULT;
+    void* address = NULL;
+
+    if ( requested == VMEM_PAGES_EXPLICIT_HUGE )
+    {
+        #ifdef MAP_HUGETLB
+        size    = AlignUp( size, __namespace( HugePageSize )() );
+        address = mmap( NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+        if ( address == MAP_FAILED ) address = NULL;
+        #endif
+
+        if ( !address )
+        {
+            LOG_WARN( "Vmem: no explicit huge pages available for %zu bytes, using transparent huge pages", size );
+            requested = VMEM_PAGES_TRANSPARENT_HUGE;
+        }
+    }
+
+    if ( requested == VMEM_PAGES_TRANSPARENT_HUGE )
+    {
+        usize huge = __namespace( HugePageSize )();
+        size    = AlignUp( size, huge );
+        address = ReserveAligned( size, huge );
+        #ifdef MADV_HUGEPAGE
+        if ( address ) madvise( address, size, MADV_HUGEPAGE );
+        #endif
+    }
+    else if ( requested == VMEM_PAGES_DEFAULT )
+    {
+        size    = AlignUp( size, __namespace( PageSize )() );
+        address = mmap( NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+        if ( address == MAP_FAILED ) address = NULL;
+    }
+
+    if ( !address )
+    {
+        LOG_ERROR( "Vmem: failed to reserve %zu bytes", size );
+        return NULL;
+    }
+
+    if ( mode ) *mode = requested;
+    atomic_fetch_add_explicit( &vmem.reservedBytes, size, memory_order_relaxed );
+    return address;
+}
+
+u8 __namespace( Commit ) ( void* address, usize size )
+{
+    if ( mprotect( address, size, PROT_READ | PROT_WRITE ) != 0 )
+    {
+        LOG_ERROR( "Vmem: failed to commit %zu bytes at %p", size, address );
+        return False;
+    }
+
+    atomic_fetch_add_explicit( &vmem.committedBytes, size, memory_order_relaxed );
+    atomic_fetch_add_explicit( &vmem.commitCalls, 1, memory_order_relaxed );
+    return True;
+}
+
+void __namespace( Decommit ) ( void* address, usize size )
+{
+    /* Drop the physical pages first, then make the range fault again */
+    madvise( address, size, MADV_DONTNEED );
+    mprotect( address, size, PROT_NONE );
+
+    atomic_fetch_sub_explicit( &vmem.committedBytes, size, memory_order_relaxed );
+    atomic_fetch_add_explicit( &vmem.decommitCalls, 1, memory_order_relaxed );
+}
+
+void __namespace( Release ) ( void* address, usize size )
+{
+    if ( !address ) return;
+
+    munmap( address, size );
+    atomic_fetch_sub_explicit( &vmem.reservedBytes, size, memory_order_relaxed );
+}
+
+#else /* PIPE_WINDOWS */
+
+void* __namespace( Reserve ) ( usize size, VmemPageMode* mode )
+{
+    /* Large pages on Windows must be committed up front, reservations always use regular pages */
+    if ( mode && *mode != VMEM_PAGES_DEFAULT )
+    {
+        LOG_WARN( "Vmem: huge pages are not supported for reservations on this platform" );
+        *mode = VMEM_PAGES_DEFAULT;
+    }
+
+    size = AlignUp( size, __namespace( PageSize )() );
+    void* address = VirtualAlloc( NULL, size, MEM_RESERVE, PAGE_NOACCESS );
+    if ( !address )
+    {
+        LOG_ERROR( "Vmem: failed to reserve %zu bytes", size );
+        return NULL;
+    }
+
+    atomic_fetch_add_explicit( &vmem.reservedBytes, size, memory_order_relaxed );
+    return address;
+}
+
+u8 __namespace( Commit ) ( void* address, usize size )
+{
+    if ( !VirtualAlloc( address, size, MEM_COMMIT, PAGE_READWRITE ) )
+    {
+        LOG_ERROR( "Vmem: failed to commit %zu bytes at %p", size, address );
+        return False;
+    }
+
+    atomic_fetch_add_explicit( &vmem.committedBytes, size, memory_order_relaxed );
+    atomic_fetch_add_explicit( &vmem.commitCalls, 1, memory_order_relaxed );
+    return True;
+}
+
+void __namespace( Decommit ) ( void* address, usize size )
+{
+    VirtualFree( address, size, MEM_DECOMMIT );
+
+    atomic_fetch_sub_explicit( &vmem.committedBytes, size, memory_order_relaxed );
+    atomic_fetch_add_explicit( &vmem.decommitCalls, 1, memory_order_relaxed );
+}
+
+void __namespace( Release ) ( void* address, usize size )
+{
+    if ( !address ) return;
+
+    VirtualFree( address, 0, MEM_RELEASE );
+    atomic_fetch_sub_explicit( &vmem.reservedBytes, size, memory_order_relaxed );
+}
+
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VmemStats __namespace( GetStats ) ( void )
+{
+    VmemStats stats;
+    stats.reservedBytes  = atomic_load_explicit( &vmem.reservedBytes, memory_order_relaxed );
+    stats.committedBytes = atomic_load_explicit( &vmem.committedBytes, memory_order_relaxed );
+    stats.commitCalls    = atomic_load_explicit( &vmem.commitCalls, memory_order_relaxed );
+    stats.decommitCalls  = atomic_load_explicit( &vmem.decommitCalls, memory_order_relaxed );
+    return stats;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static usize CommitGranularity( VmemPageMode mode )
+{
+    return ( mode == VMEM_PAGES_DEFAULT )
+        ? MAX( ( usize )VMEM_COMMIT_GRANULARITY, __namespace( PageSize )() )
+        : __namespace( HugePageSize )();
+}
+
+u8 __namespace( ArenaCreate ) ( VArena* arena, usize reserve, VmemPageMode mode, MemoryTag tag )
+{
+    CHECK_NULL( arena );
+    memset( arena, 0, sizeof( *arena ) );
+
+    /* hugetlb pages are taken from the pool at reserve time, a lazily committed arena would drain it */
+    VmemPageMode actual = mode == VMEM_PAGES_EXPLICIT_HUGE ? VMEM_PAGES_TRANSPARENT_HUGE : mode;
+
+    /* The reservation covers whole commit steps, the last Commit never reaches past the mapping */
+    reserve = AlignUp( reserve, CommitGranularity( actual ) );
+
+    void* base = __namespace( Reserve )( reserve, &actual );
+    if ( !base ) return False;
+
+    arena->base        = ( u8* )base;
+    arena->tag         = tag;
+    arena->pageMode    = ( u8 )actual;
+    arena->granularity = CommitGranularity( actual );
+    arena->reserved    = reserve;
+    return True;
+}
+
+void __namespace( ArenaDestroy ) ( VArena* arena )
+{
+    if ( !arena || !arena->base ) return;
+
+    core_MemoryTrack( arena->tag, -( i64 )arena->committed );
+    atomic_fetch_sub_explicit( &vmem.committedBytes, arena->committed, memory_order_relaxed );
+
+    __namespace( Release )( arena->base, arena->reserved );
+    memset( arena, 0, sizeof( *arena ) );
+}
+
+void* __namespace( ArenaPush ) ( VArena* arena, usize size, usize align )
+{
+    ASSERT( align && ( align & ( align - 1 ) ) == 0, "alignment must be a power of two" );
+
+    usize offset = AlignUp( arena->offset, align );
+
+    /* Compared as remaining room, offset + size could wrap and pass a plain end check */
+    if ( offset < arena->offset || offset > arena->reserved || size > arena->reserved - offset )
+    {
+        LOG_ERROR( "Vmem arena (%s): reservation of %zu bytes exhausted",
+            core_MemoryTagName( arena->tag ), arena->reserved );
+        return NULL;
+    }
+
+    usize end = offset + size;
+    if ( end > arena->committed )
+    {
+        usize target = MIN( AlignUp( end, arena->granularity ), arena->reserved );
+        usize grow   = target - arena->committed;
+
+        if ( !__namespace( Commit )( arena->base + arena->committed, grow ) )
+            return NULL;
+
+        core_MemoryTrack( arena->tag, ( i64 )grow );
+        arena->committed = target;
+    }
+
+    arena->offset = end;
+    return arena->base + offset;
+}
+
+void __namespace( ArenaPopTo ) ( VArena* arena, usize offset )
+{
+    if ( offset < arena->offset )
+        arena->offset = offset;
+}
+
+void __namespace( ArenaTrim ) ( VArena* arena )
+{
+    usize keep = AlignUp( arena->offset, arena->granularity );
+    if ( keep >= arena->committed ) return;
+
+    usize shrink = arena->committed - keep;
+    __namespace( Decommit )( arena->base + keep, shrink );
+
+    core_MemoryTrack( arena->tag, -( i64 )shrink );
+    arena->committed = keep;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,70 @@
+#ifndef __vmem_h__
+#define __vmem_h__
+
+#include <core/types.h>
+#include <core/memory.h>
+
+#define __namespace( func_name ) core##_##Vmem##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define VMEM_COMMIT_GRANULARITY KB(64)
+
+typedef enum
+{
+    VMEM_PAGES_DEFAULT          = 0,
+    VMEM_PAGES_TRANSPARENT_HUGE = 1,    /* madvise hint, kernel may or may not back with huge pages */
+    VMEM_PAGES_EXPLICIT_HUGE    = 2,    /* hugetlbfs pool, falls back to transparent when empty */
+} VmemPageMode;
+
+struct_name ( VmemStats )
+{
+    u64 reservedBytes;
+    u64 committedBytes;
+    u64 commitCalls;
+    u64 decommitCalls;
+};
+
+/* Stable address arena, grows by committing pages inside a fixed reservation */
+struct_name ( VArena )
+{
+    u8*       base;
+    usize     reserved;
+    usize     committed;
+    usize     offset;
+    usize     granularity;
+    MemoryTag tag;
+    u8        pageMode;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern usize __namespace( PageSize )     ( void );
+extern usize __namespace( HugePageSize ) ( void );
+
+/* Reserve returns address space only, size is rounded up to the page size of the mode */
+extern void* __namespace( Reserve )  ( usize size, VmemPageMode* mode );
+extern u8    __namespace( Commit )   ( void* address, usize size );
+extern void  __namespace( Decommit ) ( void* address, usize size );
+extern void  __namespace( Release )  ( void* address, usize size );
+
+extern VmemStats __namespace( GetStats ) ( void );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Explicit huge pages are treated as transparent, the hugetlb pool is charged for the whole reservation up front */
+extern u8    __namespace( ArenaCreate )  ( VArena* arena, usize reserve, VmemPageMode mode, MemoryTag tag );
+extern void  __namespace( ArenaDestroy ) ( VArena* arena );
+extern void* __namespace( ArenaPush )    ( VArena* arena, usize size, usize align );
+
+/* Moves the top back, pages past it stay committed until Trim */
+extern void  __namespace( ArenaPopTo )   ( VArena* arena, usize offset );
+extern void  __namespace( ArenaTrim )    ( VArena* arena );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __vmem_h__ */
@@ -16,22 +16,132 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <string.h>
+
+/* Core profile versions tried newest first, a legacy context is the last resort */
+static const i32 glx_versions[][2] = { { 4, 6 }, { 4, 5 }, { 4, 3 }, { 3, 3 } };
+
 static int glx_attribs[] = {
-    GLX_RGBA,
-    GLX_DOUBLEBUFFER,
-    GLX_DEPTH_SIZE,   24,
-    GLX_STENCIL_SIZE, 8,
-    GLX_RED_SIZE,     8,
-    GLX_GREEN_SIZE,   8,
-    GLX_BLUE_SIZE,    8,
-    GLX_ALPHA_SIZE,   8,
+    GLX_X_RENDERABLE,  True,
+    GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT,
+    GLX_RENDER_TYPE,   GLX_RGBA_BIT,
+    GLX_X_VISUAL_TYPE, GLX_TRUE_COLOR,
+    GLX_DOUBLEBUFFER,  True,
+    GLX_DEPTH_SIZE,    24,
+    GLX_STENCIL_SIZE,  8,
+    GLX_RED_SIZE,      8,
+    GLX_GREEN_SIZE,    8,
+    GLX_BLUE_SIZE,     8,
+    GLX_ALPHA_SIZE,    8,
     None
 };
 
+/* Debug contexts report through KHR_debug, release builds drop the driver's error checking altogether */
+#ifdef DEBUG_OPENGL
+    #define GLX_CONTEXT_FLAGS GLX_CONTEXT_DEBUG_BIT_ARB
+#else
+    #define GLX_CONTEXT_FLAGS 0
+#endif
+
+#if defined( NDEBUG ) && !defined( DEBUG_OPENGL )
+    #define GLX_CONTEXT_NO_ERROR True
+#else
+    #define GLX_CONTEXT_NO_ERROR False
+#endif
+
 extern PlatformWindowRendererContext ctx;
 
 GLXContext renderCtx;
 
+static GLXFBConfig glx_config;
+static u8          glx_createFailed;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static u8 HasExtension( const char* extensions, const char* name )
+{
+    usize length = strlen( name );
+
+    for ( const char* at = extensions; at && ( at = strstr( at, name ) ); at += length )
+    {
+        u8 starts = at == extensions || at[-1] == ' ';
+        u8 ends   = at[length] == ' ' || at[length] == '\0';
+        if ( starts && ends ) return True;
+    }
+    return False;
+}
+
+/* A refused version arrives as an X error, which would otherwise end the process */
+static int CatchCreateError( Display* display, XErrorEvent* event )
+{
+    UNUSED( display );
+    UNUSED( event );
+    glx_createFailed = True;
+    return 0;
+}
+
+static GLXContext CreateCore( PFNGLXCREATECONTEXTATTRIBSARBPROC create, i32 major, i32 minor, u8 noError )
+{
+    int attribs[] = {
+        GLX_CONTEXT_MAJOR_VERSION_ARB, major,
+        GLX_CONTEXT_MINOR_VERSION_ARB, minor,
+        GLX_CONTEXT_PROFILE_MASK_ARB,  GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+        GLX_CONTEXT_FLAGS_ARB,         GLX_CONTEXT_FLAGS,
+        noError ? GLX_CONTEXT_OPENGL_NO_ERROR_ARB : None, True,
+        None
+    };
+
+    XSync( ctx.display, False );
+    glx_createFailed = False;
+    int ( *previous )( Display*, XErrorEvent* ) = XSetErrorHandler( CatchCreateError );
+
+    GLXContext context = create( ctx.display, glx_config, NULL, True, attribs );
+
+    XSync( ctx.display, False );
+    XSetErrorHandler( previous );
+
+    if ( glx_createFailed && context )
+    {
+        glXDestroyContext( ctx.display, context );
+        context = NULL;
+    }
+    return context;
+}
+
+static GLXContext CreateContext( void )
+{
+    const char* extensions = glXQueryExtensionsString( ctx.display, ctx.screen );
+
+    PFNGLXCREATECONTEXTATTRIBSARBPROC create = ( PFNGLXCREATECONTEXTATTRIBSARBPROC )
+        glXGetProcAddressARB( ( const GLubyte* )"glXCreateContextAttribsARB" );
+
+    if ( create && HasExtension( extensions, "GLX_ARB_create_context_profile" ) )
+    {
+        u8 noError = GLX_CONTEXT_NO_ERROR && HasExtension( extensions, "GLX_ARB_create_context_no_error" );
+
+        for ( u32 i = 0; i < ARRAY_SIZE( glx_versions ); i++ )
+        {
+            i32 major = glx_versions[i][0], minor = glx_versions[i][1];
+
+            /* Some drivers refuse no-error for a version they otherwise support */
+            GLXContext context = noError ? CreateCore( create, major, minor, True ) : NULL;
+            u8 withoutErrors   = context != NULL;
+            if ( !context ) context = CreateCore( create, major, minor, False );
+
+            if ( context )
+            {
+                LOG_INFO( "GLX: %d.%d core profile%s%s", major, minor,
+                    GLX_CONTEXT_FLAGS & GLX_CONTEXT_DEBUG_BIT_ARB ? ", debug" : "",
+                    withoutErrors ? ", no error" : "" );
+                return context;
+            }
+        }
+    }
+
+    LOG_WARN( "GLX: no core profile context available, falling back to a legacy context" );
+    return glXCreateNewContext( ctx.display, glx_config, GLX_RGBA_TYPE, NULL, True );
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 u8 __namespace( Init ) ( void )
@@ -42,7 +152,20 @@ u8 __namespace( Init ) ( void )
         return False;
     }
     
-    ctx.visual = glXChooseVisual(ctx.display, ctx.screen, glx_attribs);
+    /* The first config is the one the driver ranks best for these attributes */
+    int          count   = 0;
+    GLXFBConfig* configs = glXChooseFBConfig( ctx.display, ctx.screen, glx_attribs, &count );
+    if ( !configs || count == 0 )
+    {
+        LOG_ERROR( "Failed to choose GLX framebuffer config" );
+        if ( configs ) XFree( configs );
+        return False;
+    }
+
+    glx_config = configs[0];
+    XFree( configs );
+
+    ctx.visual = glXGetVisualFromFBConfig( ctx.display, glx_config );
     
     if ( !ctx.visual ) 
     {
@@ -65,7 +188,7 @@ u8 __namespace( CreateContext) ( void )
         return False;
     }
     
-    renderCtx = glXCreateContext( ctx.display, ctx.visual, NULL, GL_TRUE );
+    renderCtx = CreateContext();
     
     if ( !renderCtx )
     {
@@ -81,10 +204,10 @@ u8 __namespace( CreateContext) ( void )
         return False;
     }
 
-     if ( !gladLoadGL() )
-     {
-        fprintf( stderr, "Failed to load OpenGL\n" );
-        return 1;
+    if ( !gladLoadGL() )
+    {
+        LOG_ERROR( "Failed to load OpenGL" );
+        return False;
     }
     
     LOG_INFO( "OpenGL Vendor: %s", glGetString( GL_VENDOR ) );
@@ -0,0 +1,34 @@
+#ifndef __platform_watch_factory_h__
+#define __platform_watch_factory_h__
+
+#include <core/types.h>
+
+#define __namespace( func_name ) platform##_##Watch##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Directory watcher, the platform thread queues changed files and the render thread drains them.
+ * Subdirectories are watched too, including ones created after Init.
+ */
+#define WATCH_PATH_MAX     256
+#define WATCH_QUEUE_LENGTH 64
+
+struct_name ( WatchEvent )
+{
+    i_char path[WATCH_PATH_MAX];    /* watched directory joined with the file name */
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern u8   __namespace( Init )     ( const i_char* directory );
+extern void __namespace( Shutdown ) ( void );
+
+/* A file written and closed or renamed into place, False when the queue is empty */
+extern u8   __namespace( Poll )     ( WatchEvent* event );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+#endif /* __platform_watch_factory_h__ */
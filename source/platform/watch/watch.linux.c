@@ -0,0 +1,221 @@
+#include <platform/watch/factory.h>
+#include <pipe.h>
+#include <core/debug.h>
+#include <core/containers/ring.h>
+
+#if PIPE_LINUX
+
+#define __namespace( func_name ) platform##_##Watch##func_name
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <errno.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#define WATCH_MAX_DIRECTORIES 64
+#define WATCH_READ_BUFFER     4096
+#define WATCH_EVENTS          ( IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE )
+
+/* The directory table is filled before the thread starts and only touched by the thread afterwards */
+static struct
+{
+    Ring        events;         /* WatchEvent, the thread produces and Poll consumes */
+    pthread_t   thread;
+    i32         inotify;
+    i32         wake[2];        /* written by Shutdown to leave the poll */
+    i32         descriptors[WATCH_MAX_DIRECTORIES];
+    i_char      directories[WATCH_MAX_DIRECTORIES][WATCH_PATH_MAX];
+    u32         directoryCount;
+    _Atomic u32 dropped;
+    u8          initialized;
+    u8          running;
+} watch = {0};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static u8 JoinPath( i_char* out, const i_char* directory, const i_char* name )
+{
+    usize directoryLength = strlen( directory );
+    usize nameLength      = strlen( name );
+    if ( directoryLength + 1 + nameLength >= WATCH_PATH_MAX ) return False;
+
+    memcpy( out, directory, directoryLength );
+    out[directoryLength] = '/';
+    memcpy( out + directoryLength + 1, name, nameLength + 1 );
+    return True;
+}
+
+static void AddDirectory( const i_char* path )
+{
+    if ( watch.directoryCount == WATCH_MAX_DIRECTORIES )
+    {
+        LOG_WARN( "Watch: more than %u directories, '%s' is not watched", WATCH_MAX_DIRECTORIES, path );
+        return;
+    }
+
+    usize length = strlen( path );
+    if ( length >= WATCH_PATH_MAX ) return;
+
+    i32 descriptor = inotify_add_watch( watch.inotify, path, WATCH_EVENTS );
+    if ( descriptor < 0 )
+    {
+        LOG_WARN( "Watch: can not watch '%s' (%s)", path, strerror( errno ) );
+        return;
+    }
+
+    u32 slot = watch.directoryCount++;
+    watch.descriptors[slot] = descriptor;
+    memcpy( watch.directories[slot], path, length + 1 );
+
+    DIR* dir = opendir( path );
+    if ( !dir ) return;
+
+    struct dirent* entry;
+    while ( ( entry = readdir( dir ) ) )
+    {
+        if ( entry->d_type != DT_DIR || entry->d_name[0] == '.' ) continue;
+
+        i_char child[WATCH_PATH_MAX];
+        if ( JoinPath( child, path, entry->d_name ) )
+            AddDirectory( child );
+    }
+    closedir( dir );
+}
+
+static const i_char* DirectoryOf( i32 descriptor )
+{
+    for ( u32 i = 0; i < watch.directoryCount; i++ )
+        if ( watch.descriptors[i] == descriptor ) return watch.directories[i];
+    return NULL;
+}
+
+static void Dispatch( const struct inotify_event* event )
+{
+    const i_char* directory = DirectoryOf( event->wd );
+    if ( !directory || !event->len ) return;
+
+    WatchEvent out;
+    if ( !JoinPath( out.path, directory, event->name ) ) return;
+
+    if ( event->mask & IN_ISDIR )
+    {
+        if ( event->mask & ( IN_CREATE | IN_MOVED_TO ) ) AddDirectory( out.path );
+        return;
+    }
+
+    /* Creation alone is not a finished write, the close that follows is */
+    if ( !( event->mask & ( IN_CLOSE_WRITE | IN_MOVED_TO ) ) ) return;
+
+    if ( !core_RingPush( &watch.events, &out ) )
+        atomic_fetch_add( &watch.dropped, 1 );
+}
+
+static void* WatchThread( void* arg )
+{
+    UNUSED( arg );
+
+    _Alignas( struct inotify_event ) i_char buffer[WATCH_READ_BUFFER];
+    struct pollfd fds[2] = {
+        { .fd = watch.inotify, .events = POLLIN },
+        { .fd = watch.wake[0], .events = POLLIN },
+    };
+
+    for ( ;; )
+    {
+        if ( poll( fds, 2, -1 ) < 0 )
+        {
+            if ( errno == EINTR ) continue;
+            break;
+        }
+        if ( fds[1].revents ) break;
+        if ( !( fds[0].revents & POLLIN ) ) continue;
+
+        ssize_t length = read( watch.inotify, buffer, sizeof( buffer ) );
+        if ( length <= 0 ) continue;
+
+        for ( i_char* cursor = buffer; cursor < buffer + length; )
+        {
+            const struct inotify_event* event = ( const struct inotify_event* )cursor;
+            Dispatch( event );
+            cursor += sizeof( struct inotify_event ) + event->len;
+        }
+    }
+    return NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace( Init ) ( const i_char* directory )
+{
+    ASSERT( watch.running != True );
+    CHECK_NULL( directory );
+
+    memset( &watch, 0, sizeof( watch ) );
+    watch.inotify = watch.wake[0] = watch.wake[1] = -1;
+
+    Allocator allocator = core_AllocatorHeap( MEMORY_TAG_CORE );
+    if ( !RING_INIT_TYPE( &watch.events, WatchEvent, WATCH_QUEUE_LENGTH, &allocator ) ) return False;
+    watch.initialized = True;
+
+    watch.inotify = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if ( watch.inotify < 0 || pipe( watch.wake ) != 0 )
+    {
+        LOG_WARN( "Watch: inotify unavailable (%s)", strerror( errno ) );
+        __namespace( Shutdown )();
+        return False;
+    }
+
+    AddDirectory( directory );
+
+    /* Read before the thread starts, it owns the directory table from then on */
+    u32 directories = watch.directoryCount;
+    if ( !directories || pthread_create( &watch.thread, NULL, WatchThread, NULL ) != 0 )
+    {
+        __namespace( Shutdown )();
+        return False;
+    }
+
+    watch.running = True;
+    LOG_INFO( "Watch: '%s' (%u directories)", directory, directories );
+    return True;
+}
+
+void __namespace( Shutdown ) ( void )
+{
+    if ( !watch.initialized ) return;
+
+    if ( watch.running )
+    {
+        ssize_t written = write( watch.wake[1], "", 1 );
+        UNUSED( written );
+        pthread_join( watch.thread, NULL );
+        watch.running = False;
+    }
+
+    if ( watch.inotify >= 0 ) close( watch.inotify );
+    if ( watch.wake[0] >= 0 ) close( watch.wake[0] );
+    if ( watch.wake[1] >= 0 ) close( watch.wake[1] );
+
+    core_RingFree( &watch.events );
+    memset( &watch, 0, sizeof( watch ) );
+}
+
+u8 __namespace( Poll ) ( WatchEvent* event )
+{
+    if ( !watch.running || !event ) return False;
+
+    u32 dropped = atomic_exchange( &watch.dropped, 0 );
+    if ( dropped )
+        LOG_WARN( "Watch: queue full, %u changes dropped", dropped );
+
+    return core_RingPop( &watch.events, event );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+#endif /* PIPE_LINUX */
@@ -0,0 +1,33 @@
+#include <platform/watch/factory.h>
+#include <pipe.h>
+#include <core/debug.h>
+
+#if PIPE_WINDOWS
+
+#define __namespace( func_name ) platform##_##Watch##func_name
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* No ReadDirectoryChangesW backend yet, hot reload stays off on Windows */
+
+u8 __namespace( Init ) ( const i_char* directory )
+{
+    LOG_WARN( "Watch: not supported on Windows, '%s' is not watched", directory ? directory : "" );
+    return False;
+}
+
+void __namespace( Shutdown ) ( void )
+{
+}
+
+u8 __namespace( Poll ) ( WatchEvent* event )
+{
+    UNUSED( event );
+    return False;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+#endif /* PIPE_WINDOWS */
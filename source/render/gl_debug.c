@@ -0,0 +1,225 @@
+// gl_debug.c
+#include "gl_debug.h"
+
+#ifdef GLX_OPENGL
+
+#include <glad/glad.h>
+#include <core/debug.h>
+#include <core/profiler.h>
+#include <core/containers/hashmap.h>
+
+#define __namespace(func_name) renderer_GlDebug##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define GL_DEBUG_TABLE_CAPACITY 64
+
+typedef struct
+{
+    u64 windowStart;
+    u32 count;          /* logged in the current window */
+    u32 suppressed;
+} DebugRepeat;
+
+static struct
+{
+    HashMap repeats;    /* source << 32 | id -> DebugRepeat */
+    u32     ignored[GL_DEBUG_MAX_IGNORED];
+    u32     ignoredCount;
+    u8      groups;     /* KHR_debug present, independent of the callback */
+    u8      active;
+} glDebug = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* SourceName(GLenum source)
+{
+    switch (source) {
+        case GL_DEBUG_SOURCE_API:             return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "window";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY:     return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION:     return "application";
+        default:                              return "other";
+    }
+}
+
+static const char* TypeName(GLenum type)
+{
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR:               return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "undefined";
+        case GL_DEBUG_TYPE_PORTABILITY:         return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE:         return "performance";
+        case GL_DEBUG_TYPE_MARKER:              return "marker";
+        default:                                return "other";
+    }
+}
+
+static u8 IsIgnored(GLuint id)
+{
+    for (u32 i = 0; i < glDebug.ignoredCount; i++)
+        if (glDebug.ignored[i] == id) return True;
+    return False;
+}
+
+/* True when the message may be logged, summarises the repeats of the previous window first */
+static u8 RateLimit(GLenum source, GLuint id)
+{
+    u64 key = (u64)source << 32 | id;
+    u64 now = core_ProfilerNow();
+
+    DebugRepeat* repeat = HASHMAP_GET_TYPE(&glDebug.repeats, DebugRepeat, key);
+    if (!repeat) {
+        repeat = (DebugRepeat*)core_HashMapInsert(&glDebug.repeats, key, NULL);
+        if (!repeat) return True;
+        repeat->windowStart = now;
+    }
+
+    if (now - repeat->windowStart >= GL_DEBUG_RATE_WINDOW) {
+        if (repeat->suppressed)
+            LOG_WARN("GL %s %u: %u repeats suppressed", SourceName(source), id, repeat->suppressed);
+        repeat->windowStart = now;
+        repeat->count       = 0;
+        repeat->suppressed  = 0;
+    }
+
+    if (repeat->count >= GL_DEBUG_RATE_LIMIT) {
+        repeat->suppressed++;
+        return False;
+    }
+    repeat->count++;
+    return True;
+}
+
+static void APIENTRY Callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+    const GLchar* message, const void* user)
+{
+    UNUSED(user);
+
+    /* Our own group markers come back as messages */
+    if (source == GL_DEBUG_SOURCE_APPLICATION && (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP))
+        return;
+    if (IsIgnored(id) || !RateLimit(source, id)) return;
+
+    DebugLevel level = DEBUG_LEVEL_DEBUG;
+    switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH:   level = DEBUG_LEVEL_ERROR; break;
+        case GL_DEBUG_SEVERITY_MEDIUM: level = DEBUG_LEVEL_WARN;  break;
+        case GL_DEBUG_SEVERITY_LOW:    level = DEBUG_LEVEL_INFO;  break;
+    }
+
+    debug_log(level, "GL %s %s %u: %.*s", SourceName(source), TypeName(type), id, (int)length, message);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace(Init)(void)
+{
+    if (glDebug.active) return True;
+
+    glDebug.groups = GLAD_GL_VERSION_4_3 || GLAD_GL_KHR_debug;
+    if (!glDebug.groups) return False;
+
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) return False;
+
+    Allocator allocator = core_AllocatorHeap(MEMORY_TAG_RENDER);
+    if (!HASHMAP_INIT_TYPE(&glDebug.repeats, DebugRepeat, GL_DEBUG_TABLE_CAPACITY, &allocator)) return False;
+
+    /* Synchronous keeps the callback on this thread, with the offending call on the stack */
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(Callback, NULL);
+    __namespace(SetMinSeverity)(GL_DEBUG_SEVERITY_LOW);
+
+    glDebug.active = True;
+    LOG_INFO("GL debug output enabled");
+    return True;
+}
+
+void __namespace(Shutdown)(void)
+{
+    if (!glDebug.active) return;
+
+    glDebugMessageCallback(NULL, NULL);
+    glDisable(GL_DEBUG_OUTPUT);
+
+    /* Repeats of a window that never closed are only counted so far, report them before they are lost */
+    u32          cursor = 0;
+    u64          key;
+    DebugRepeat* repeat;
+    while (core_HashMapNext(&glDebug.repeats, &cursor, &key, (void**)&repeat)) {
+        if (repeat->suppressed)
+            LOG_WARN("GL %s %u: %u repeats suppressed", SourceName((GLenum)(key >> 32)), (u32)key, repeat->suppressed);
+    }
+    core_HashMapFree(&glDebug.repeats);
+    glDebug.active       = False;
+    glDebug.ignoredCount = 0;
+}
+
+u8 __namespace(Active)(void)
+{
+    return glDebug.active;
+}
+
+void __namespace(SetMinSeverity)(u32 severity)
+{
+    if (!glDebug.active) return;
+
+    /* Ordered from most to least severe */
+    static const GLenum severities[] = {
+        GL_DEBUG_SEVERITY_HIGH, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_NOTIFICATION
+    };
+
+    GLboolean enabled = GL_TRUE;
+    for (u32 i = 0; i < ARRAY_SIZE(severities); i++) {
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severities[i], 0, NULL, enabled);
+        if (severities[i] == severity) enabled = GL_FALSE;
+    }
+}
+
+void __namespace(Ignore)(u32 id)
+{
+    if (IsIgnored(id)) return;
+
+    if (glDebug.ignoredCount == GL_DEBUG_MAX_IGNORED) {
+        LOG_WARN("GL debug: more than %u ignored ids, %u is still reported", GL_DEBUG_MAX_IGNORED, id);
+        return;
+    }
+    glDebug.ignored[glDebug.ignoredCount++] = id;
+}
+
+void __namespace(PushGroup)(const char* name)
+{
+    if (glDebug.groups) glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+void __namespace(PopGroup)(void)
+{
+    if (glDebug.groups) glPopDebugGroup();
+}
+
+void __namespace(CheckError)(const char* file, i32 line)
+{
+    if (glDebug.active) return;
+
+    GLenum error;
+    while ((error = glGetError()) != GL_NO_ERROR) {
+        const char* name = "Unknown error";
+        switch (error) {
+            case GL_INVALID_ENUM:                  name = "GL_INVALID_ENUM"; break;
+            case GL_INVALID_VALUE:                 name = "GL_INVALID_VALUE"; break;
+            case GL_INVALID_OPERATION:             name = "GL_INVALID_OPERATION"; break;
+            case GL_OUT_OF_MEMORY:                 name = "GL_OUT_OF_MEMORY"; break;
+            case GL_INVALID_FRAMEBUFFER_OPERATION: name = "GL_INVALID_FRAMEBUFFER_OPERATION"; break;
+        }
+        LOG_ERROR("OpenGL Error: %s at %s:%d", name, file, line);
+    }
+}
+
+#undef __namespace
+
+#endif /* GLX_OPENGL */
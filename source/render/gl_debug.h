@@ -0,0 +1,55 @@
+#ifndef __gl_debug_h__
+#define __gl_debug_h__
+
+#include <core/types.h>
+
+#define __namespace( func_name ) renderer##_##GlDebug##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Driver messages through a KHR_debug callback instead of polling glGetError. The callback is only installed on a
+ * debug context (DEBUG_OPENGL builds) and runs synchronously on the GL thread. Repeats of the same message are
+ * limited to GL_DEBUG_RATE_LIMIT per GL_DEBUG_RATE_WINDOW, the rest are counted and reported as a summary.
+ */
+#define GL_DEBUG_RATE_LIMIT   4
+#define GL_DEBUG_RATE_WINDOW  1000000000ull     /* ns */
+#define GL_DEBUG_MAX_IGNORED  32
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef GLX_OPENGL
+
+/* False when the context is not a debug context or KHR_debug is missing, groups may still work */
+u8   __namespace( Init )           ( void );
+void __namespace( Shutdown )       ( void );
+u8   __namespace( Active )         ( void );
+
+/* GL_DEBUG_SEVERITY_*, messages below are dropped by the driver. Notifications are off by default */
+void __namespace( SetMinSeverity ) ( u32 severity );
+
+/* Messages with this id are dropped whatever their source */
+void __namespace( Ignore )         ( u32 id );
+
+/* Names a range of GL work for the driver and for capture tools, no-op without KHR_debug */
+void __namespace( PushGroup )      ( const char* name );
+void __namespace( PopGroup )       ( void );
+
+/* Polls glGetError, skipped once the callback reports errors as they happen */
+void __namespace( CheckError )     ( const char* file, i32 line );
+
+#ifdef DEBUG_OPENGL
+    #define CHECK_GL_ERROR() renderer_GlDebugCheckError( __FILE__, __LINE__ )
+#else
+    #define CHECK_GL_ERROR() ( ( void )0 )
+#endif
+
+#endif /* GLX_OPENGL */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __gl_debug_h__ */
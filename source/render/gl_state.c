@@ -0,0 +1,268 @@
+// gl_state.c
+#include "gl_state.h"
+
+#ifdef GLX_OPENGL
+
+#include <glad/glad.h>
+#include <string.h>
+
+#define __namespace(func_name) renderer_GlState##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* No object or enum uses this value, a shadow holding it never matches */
+#define GL_STATE_UNKNOWN 0xFFFFFFFFu
+
+enum { BUFFER_ARRAY = 0, BUFFER_ELEMENT, BUFFER_UNIFORM, BUFFER_STORAGE, BUFFER_INDIRECT, BUFFER_TARGET_COUNT };
+enum { INDEXED_UNIFORM = 0, INDEXED_STORAGE, INDEXED_TARGET_COUNT };
+enum { CAPABILITY_DEPTH_TEST = 0, CAPABILITY_CULL_FACE, CAPABILITY_BLEND, CAPABILITY_COUNT };
+
+typedef struct
+{
+    u32   buffer;
+    usize offset;
+    usize size;
+} IndexedBinding;
+
+static struct
+{
+    u32            program;
+    u32            vertexArray;
+    u32            buffers[BUFFER_TARGET_COUNT];
+    IndexedBinding indexed[INDEXED_TARGET_COUNT][GL_STATE_MAX_INDEXED_BINDINGS];
+
+    u32            activeUnit;
+    u32            textures[GL_STATE_MAX_TEXTURE_UNITS];
+    u32            textureTargets[GL_STATE_MAX_TEXTURE_UNITS];
+
+    u32            capabilities[CAPABILITY_COUNT];
+    u32            depthFunc;
+    u32            depthMask;
+    u32            cullFace;
+    u32            frontFace;
+    u32            blendSource;
+    u32            blendDestination;
+
+    GlStateStats   frame;
+    GlStateStats   last;
+    u8             initialized;
+} state = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline void EnsureInit(void)
+{
+    if (!state.initialized) __namespace(Reset)();
+}
+
+/* Updates the shadow and counts the call, False when it would not change anything */
+static inline u8 Changed(u32* shadow, u32 value)
+{
+    EnsureInit();
+
+    if (*shadow == value) {
+        state.frame.filtered++;
+        return False;
+    }
+    *shadow = value;
+    state.frame.issued++;
+    return True;
+}
+
+static i32 BufferSlot(u32 target)
+{
+    switch (target) {
+        case GL_ARRAY_BUFFER:          return BUFFER_ARRAY;
+        case GL_ELEMENT_ARRAY_BUFFER:  return BUFFER_ELEMENT;
+        case GL_UNIFORM_BUFFER:        return BUFFER_UNIFORM;
+        case GL_SHADER_STORAGE_BUFFER: return BUFFER_STORAGE;
+        case GL_DRAW_INDIRECT_BUFFER:  return BUFFER_INDIRECT;
+        default:                       return -1;
+    }
+}
+
+static i32 CapabilitySlot(u32 capability)
+{
+    switch (capability) {
+        case GL_DEPTH_TEST: return CAPABILITY_DEPTH_TEST;
+        case GL_CULL_FACE:  return CAPABILITY_CULL_FACE;
+        case GL_BLEND:      return CAPABILITY_BLEND;
+        default:            return -1;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace(Reset)(void)
+{
+    GlStateStats frame = state.frame, last = state.last;
+
+    memset(&state, 0xFF, sizeof(state));
+    state.frame       = frame;
+    state.last        = last;
+    state.initialized = True;
+}
+
+void __namespace(Forget)(u32 name)
+{
+    if (!name || !state.initialized) return;
+
+    if (state.vertexArray == name) {
+        state.vertexArray             = GL_STATE_UNKNOWN;
+        state.buffers[BUFFER_ELEMENT] = GL_STATE_UNKNOWN;
+    }
+
+    for (u32 i = 0; i < BUFFER_TARGET_COUNT; i++)
+        if (state.buffers[i] == name) state.buffers[i] = GL_STATE_UNKNOWN;
+
+    for (u32 t = 0; t < INDEXED_TARGET_COUNT; t++)
+        for (u32 i = 0; i < GL_STATE_MAX_INDEXED_BINDINGS; i++)
+            if (state.indexed[t][i].buffer == name) state.indexed[t][i].buffer = GL_STATE_UNKNOWN;
+
+    for (u32 i = 0; i < GL_STATE_MAX_TEXTURE_UNITS; i++)
+        if (state.textures[i] == name) state.textures[i] = GL_STATE_UNKNOWN;
+}
+
+void __namespace(EndFrame)(void)
+{
+    state.last  = state.frame;
+    state.frame = (GlStateStats){0};
+}
+
+GlStateStats __namespace(GetStats)(void)
+{
+    return state.last;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace(UseProgram)(u32 program)
+{
+    if (Changed(&state.program, program))
+        glUseProgram(program);
+}
+
+void __namespace(BindVertexArray)(u32 vertexArray)
+{
+    if (!Changed(&state.vertexArray, vertexArray)) return;
+
+    glBindVertexArray(vertexArray);
+    state.buffers[BUFFER_ELEMENT] = GL_STATE_UNKNOWN;
+}
+
+void __namespace(BindBuffer)(u32 target, u32 buffer)
+{
+    i32 slot = BufferSlot(target);
+    if (slot < 0) {
+        state.frame.issued++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (Changed(&state.buffers[slot], buffer))
+        glBindBuffer(target, buffer);
+}
+
+void __namespace(BindBufferRange)(u32 target, u32 index, u32 buffer, usize offset, usize size)
+{
+    EnsureInit();
+
+    i32 slot = target == GL_UNIFORM_BUFFER ? INDEXED_UNIFORM : target == GL_SHADER_STORAGE_BUFFER ? INDEXED_STORAGE : -1;
+    IndexedBinding* binding = slot >= 0 && index < GL_STATE_MAX_INDEXED_BINDINGS ? &state.indexed[slot][index] : NULL;
+
+    if (binding && binding->buffer == buffer && binding->offset == offset && binding->size == size) {
+        state.frame.filtered++;
+        return;
+    }
+
+    if (size) glBindBufferRange(target, index, buffer, (GLintptr)offset, (GLsizeiptr)size);
+    else      glBindBufferBase(target, index, buffer);
+    state.frame.issued++;
+
+    if (binding) *binding = (IndexedBinding){ buffer, offset, size };
+
+    /* Indexed binds also replace the generic binding of the target */
+    i32 generic = BufferSlot(target);
+    if (generic >= 0) state.buffers[generic] = buffer;
+}
+
+void __namespace(BindTexture)(u32 unit, u32 target, u32 texture)
+{
+    EnsureInit();
+
+    if (unit >= GL_STATE_MAX_TEXTURE_UNITS) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        state.activeUnit = unit;
+        state.frame.issued += 2;
+        return;
+    }
+
+    if (state.textures[unit] == texture && state.textureTargets[unit] == target) {
+        state.frame.filtered++;
+        return;
+    }
+
+    if (Changed(&state.activeUnit, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+
+    glBindTexture(target, texture);
+    state.textures[unit]       = texture;
+    state.textureTargets[unit] = target;
+    state.frame.issued++;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace(Enable)(u32 capability, u8 enabled)
+{
+    i32 slot = CapabilitySlot(capability);
+    if (slot >= 0 && !Changed(&state.capabilities[slot], enabled != 0)) return;
+    if (slot < 0) state.frame.issued++;
+
+    if (enabled) glEnable(capability);
+    else         glDisable(capability);
+}
+
+void __namespace(DepthFunc)(u32 func)
+{
+    if (Changed(&state.depthFunc, func))
+        glDepthFunc(func);
+}
+
+void __namespace(DepthMask)(u8 write)
+{
+    if (Changed(&state.depthMask, write != 0))
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void __namespace(CullFace)(u32 face)
+{
+    if (Changed(&state.cullFace, face))
+        glCullFace(face);
+}
+
+void __namespace(FrontFace)(u32 mode)
+{
+    if (Changed(&state.frontFace, mode))
+        glFrontFace(mode);
+}
+
+void __namespace(BlendFunc)(u32 source, u32 destination)
+{
+    EnsureInit();
+
+    if (state.blendSource == source && state.blendDestination == destination) {
+        state.frame.filtered++;
+        return;
+    }
+
+    glBlendFunc(source, destination);
+    state.blendSource      = source;
+    state.blendDestination = destination;
+    state.frame.issued++;
+}
+
+#undef __namespace
+
+#endif /* GLX_OPENGL */
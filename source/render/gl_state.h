@@ -0,0 +1,66 @@
+#ifndef __gl_state_h__
+#define __gl_state_h__
+
+#include <core/types.h>
+
+#define __namespace( func_name ) renderer##_##GlState##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Shadow of the bindings and fixed function state the renderer touches. A call whose value matches the shadow is
+ * dropped before it reaches the driver. Every bind in render/ goes through here, code that talks to GL directly
+ * must call Reset afterwards or the shadow lies.
+ */
+#define GL_STATE_MAX_TEXTURE_UNITS     16
+#define GL_STATE_MAX_INDEXED_BINDINGS  16
+
+typedef struct
+{
+    u32 issued;         /* reached the driver */
+    u32 filtered;       /* matched the shadow and were dropped */
+} GlStateStats;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef GLX_OPENGL
+
+/* Marks everything unknown, the next call of each kind is always issued */
+void         __namespace( Reset )           ( void );
+
+/* After deleting a buffer, vertex array or texture. GL unbinds it, the shadow drops every binding with that name */
+void         __namespace( Forget )          ( u32 name );
+
+/* Counters of the frame that just ended, GetStats returns them until the next EndFrame */
+void         __namespace( EndFrame )        ( void );
+GlStateStats __namespace( GetStats )        ( void );
+
+void         __namespace( UseProgram )      ( u32 program );
+
+/* The element buffer binding belongs to the vertex array, changing the array forgets it */
+void         __namespace( BindVertexArray ) ( u32 vertexArray );
+void         __namespace( BindBuffer )      ( u32 target, u32 buffer );
+
+/* Uniform and storage buffer ranges, size 0 binds the whole buffer like glBindBufferBase */
+void         __namespace( BindBufferRange ) ( u32 target, u32 index, u32 buffer, usize offset, usize size );
+
+/* Selects the unit with glActiveTexture only when the binding actually changes */
+void         __namespace( BindTexture )     ( u32 unit, u32 target, u32 texture );
+
+/* GL_DEPTH_TEST, GL_CULL_FACE and GL_BLEND are shadowed, other capabilities always go through */
+void         __namespace( Enable )          ( u32 capability, u8 enabled );
+void         __namespace( DepthFunc )       ( u32 func );
+void         __namespace( DepthMask )       ( u8 write );
+void         __namespace( CullFace )        ( u32 face );
+void         __namespace( FrontFace )       ( u32 mode );
+void         __namespace( BlendFunc )       ( u32 source, u32 destination );
+
+#endif /* GLX_OPENGL */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __gl_state_h__ */
@@ -0,0 +1,354 @@
+// gpu_timer.c
+#include "gpu_timer.h"
+
+#include <core/debug.h>
+#include <core/profiler.h>
+#include <string.h>
+
+#ifdef GLX_OPENGL
+    #include <glad/glad.h>
+#elif defined(GLX_VULKAN)
+    #include <platform/glx/vulkan/helpers.h>
+#endif
+
+#define __namespace(func_name) renderer_GpuTimer##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define GPU_TIMER_CALIBRATE_INTERVAL 64
+
+typedef struct
+{
+    u64         frameIndex;
+    const char* names[GPU_TIMER_MAX_PASSES];
+    u8          depths[GPU_TIMER_MAX_PASSES];
+    u32         count;
+    u8          pending;
+
+    #ifdef GLX_OPENGL
+    u32         queries[GPU_TIMER_MAX_PASSES * 2];
+    u32         lastQuery;      /* issued last, with nesting an outer end comes after the inner ones */
+    #elif defined(GLX_VULKAN)
+    u8          reset;
+    #endif
+} GpuTimerSlot;
+
+static struct
+{
+    GpuTimerSlot slots[GPU_TIMER_LATENCY];
+    GpuTimerSlot* current;
+    u32          stack[GPU_TIMER_MAX_PASSES];
+    u32          stackDepth;
+    u32          overflowDepth; /* passes begun with the stack full, their EndPass pops nothing */
+    u64          dropped;
+    u8           enabled;
+
+    #ifdef GLX_OPENGL
+    i64          gpuToCpu;      /* offset from the GL timestamp clock to the profiler clock */
+    #elif defined(GLX_VULKAN)
+    VkQueryPool     pool;
+    VkCommandBuffer commandBuffer;
+    f64             period;     /* nanoseconds per timestamp tick */
+    #endif
+} gpuTimer = {0};
+
+STATIC_ASSERT( GPU_TIMER_LATENCY < PROFILER_FRAME_HISTORY, gpu_latency_fits_profiler_history );
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Backend
+
+#ifdef GLX_OPENGL
+
+static void Calibrate(void)
+{
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuTimer.gpuToCpu = (i64)core_ProfilerNow() - (i64)gpuNow;
+}
+
+static u8 BackendInit(void)
+{
+    if (!GLAD_GL_VERSION_3_3 && !GLAD_GL_ARB_timer_query) {
+        LOG_WARN("GPU timer: timer queries not supported, GPU zones disabled");
+        return False;
+    }
+
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    if (bits == 0) {
+        LOG_WARN("GPU timer: GL_TIMESTAMP has no counter bits, GPU zones disabled");
+        return False;
+    }
+
+    for (u32 i = 0; i < GPU_TIMER_LATENCY; i++)
+        glGenQueries(GPU_TIMER_MAX_PASSES * 2, gpuTimer.slots[i].queries);
+
+    Calibrate();
+    return True;
+}
+
+static void BackendShutdown(void)
+{
+    for (u32 i = 0; i < GPU_TIMER_LATENCY; i++)
+        glDeleteQueries(GPU_TIMER_MAX_PASSES * 2, gpuTimer.slots[i].queries);
+}
+
+static void BackendBeginFrame(u64 frameIndex)
+{
+    if (frameIndex % GPU_TIMER_CALIBRATE_INTERVAL == 0)
+        Calibrate();
+}
+
+static inline u8 BackendRecording(void)
+{
+    return True;
+}
+
+static void BackendWrite(GpuTimerSlot* slot, u32 query, u8 isEnd)
+{
+    UNUSED(isEnd);
+    glQueryCounter(slot->queries[query], GL_TIMESTAMP);
+    slot->lastQuery = query;
+}
+
+static u8 BackendCollect(GpuTimerSlot* slot, u64* timestamps)
+{
+    /* Queries retire in submission order, the one issued last being ready means all of them are */
+    GLint available = 0;
+    glGetQueryObjectiv(slot->queries[slot->lastQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return False;
+
+    for (u32 i = 0; i < slot->count * 2; i++) {
+        GLuint64 value = 0;
+        glGetQueryObjectui64v(slot->queries[i], GL_QUERY_RESULT, &value);
+        timestamps[i] = (u64)((i64)value + gpuTimer.gpuToCpu);
+    }
+    return True;
+}
+
+#elif defined(GLX_VULKAN)
+
+static u8 BackendInit(void)
+{
+    VkDevice device = vk_get_device();
+    if (device == VK_NULL_HANDLE) {
+        LOG_WARN("GPU timer: no Vulkan device, GPU zones disabled");
+        return False;
+    }
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(vk_get_physical_device(), &props);
+    if (!props.limits.timestampComputeAndGraphics || props.limits.timestampPeriod <= 0.0f) {
+        LOG_WARN("GPU timer: timestamps not supported on graphics queue, GPU zones disabled");
+        return False;
+    }
+    gpuTimer.period = props.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo poolInfo = {0};
+    poolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = GPU_TIMER_LATENCY * GPU_TIMER_MAX_PASSES * 2;
+
+    if (vkCreateQueryPool(device, &poolInfo, NULL, &gpuTimer.pool) != VK_SUCCESS) {
+        LOG_ERROR("GPU timer: failed to create timestamp query pool");
+        return False;
+    }
+    return True;
+}
+
+static void BackendShutdown(void)
+{
+    if (gpuTimer.pool)
+        vkDestroyQueryPool(vk_get_device(), gpuTimer.pool, NULL);
+    gpuTimer.pool = VK_NULL_HANDLE;
+}
+
+static void BackendBeginFrame(u64 frameIndex)
+{
+    UNUSED(frameIndex);
+    gpuTimer.commandBuffer = VK_NULL_HANDLE;
+}
+
+static inline u32 SlotBase(GpuTimerSlot* slot)
+{
+    return (u32)(slot - gpuTimer.slots) * GPU_TIMER_MAX_PASSES * 2;
+}
+
+static inline u8 BackendRecording(void)
+{
+    return gpuTimer.commandBuffer != VK_NULL_HANDLE;
+}
+
+static void BackendWrite(GpuTimerSlot* slot, u32 query, u8 isEnd)
+{
+    if (!slot->reset) {
+        vkCmdResetQueryPool(gpuTimer.commandBuffer, gpuTimer.pool, SlotBase(slot), GPU_TIMER_MAX_PASSES * 2);
+        slot->reset = True;
+    }
+
+    vkCmdWriteTimestamp(gpuTimer.commandBuffer,
+        isEnd ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        gpuTimer.pool, SlotBase(slot) + query);
+}
+
+static u8 BackendCollect(GpuTimerSlot* slot, u64* timestamps)
+{
+    VkResult result = vkGetQueryPoolResults(vk_get_device(), gpuTimer.pool,
+        SlotBase(slot), slot->count * 2,
+        sizeof(u64) * slot->count * 2, timestamps, sizeof(u64),
+        VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) return False;
+
+    /* Without VK_EXT_calibrated_timestamps the first GPU pass is anchored to the CPU frame start */
+    const ProfilerFrame* frame = core_ProfilerGetFrame(slot->frameIndex);
+    u64 anchor = frame ? frame->start : 0;
+    u64 first  = timestamps[0];
+
+    for (u32 i = 0; i < slot->count * 2; i++)
+        timestamps[i] = anchor + (u64)((f64)(timestamps[i] - first) * gpuTimer.period);
+    return True;
+}
+
+void __namespace(SetCommandBuffer)(VkCommandBuffer commandBuffer)
+{
+    gpuTimer.commandBuffer = commandBuffer;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void CollectSlot(GpuTimerSlot* slot, u8 force)
+{
+    if (!slot->pending) return;
+
+    u64 timestamps[GPU_TIMER_MAX_PASSES * 2];
+
+    if (slot->count == 0 || !BackendCollect(slot, timestamps)) {
+        if (!force && slot->count) return;
+
+        /* Slot has to be reused, results never arrived in time */
+        if (slot->count) {
+            gpuTimer.dropped++;
+            LOG_TRACE("GPU timer: dropped results for frame %llu", (unsigned long long)slot->frameIndex);
+        }
+        slot->pending = False;
+        return;
+    }
+
+    for (u32 i = 0; i < slot->count; i++)
+        core_ProfilerSubmitGpuZone(slot->frameIndex, slot->names[i],
+            timestamps[i * 2], timestamps[i * 2 + 1], slot->depths[i]);
+
+    core_ProfilerResolveGpu(slot->frameIndex);
+    slot->pending = False;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace(Init)(void)
+{
+    memset(&gpuTimer, 0, sizeof(gpuTimer));
+
+    gpuTimer.enabled = BackendInit();
+    if (gpuTimer.enabled)
+        LOG_INFO("GPU timer initialized (%u frames latency)", GPU_TIMER_LATENCY);
+
+    return gpuTimer.enabled;
+}
+
+void __namespace(Shutdown)(void)
+{
+    if (gpuTimer.enabled)
+        BackendShutdown();
+    gpuTimer.enabled = False;
+    gpuTimer.current = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace(BeginFrame)(u64 frameIndex)
+{
+    if (!gpuTimer.enabled) return;
+
+    BackendBeginFrame(frameIndex);
+
+    /* Harvest whatever finished, oldest first */
+    for (u32 i = 1; i <= GPU_TIMER_LATENCY; i++) {
+        GpuTimerSlot* slot = &gpuTimer.slots[(frameIndex + i) % GPU_TIMER_LATENCY];
+        CollectSlot(slot, False);
+    }
+
+    GpuTimerSlot* slot = &gpuTimer.slots[frameIndex % GPU_TIMER_LATENCY];
+    CollectSlot(slot, True);
+
+    slot->frameIndex = frameIndex;
+    slot->count      = 0;
+    slot->pending    = True;
+    #ifdef GLX_VULKAN
+    slot->reset      = False;
+    #endif
+
+    gpuTimer.current       = slot;
+    gpuTimer.stackDepth    = 0;
+    gpuTimer.overflowDepth = 0;
+}
+
+void __namespace(EndFrame)(void)
+{
+    if (!gpuTimer.current) return;
+
+    gpuTimer.overflowDepth = 0;
+    while (gpuTimer.stackDepth > 0)
+        __namespace(EndPass)();
+
+    gpuTimer.current = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace(BeginPass)(const char* name)
+{
+    GpuTimerSlot* slot = gpuTimer.current;
+    if (!slot) return;
+
+    /* Too deep to track, count it so the matching EndPass does not end the parent */
+    if (gpuTimer.stackDepth >= GPU_TIMER_MAX_PASSES) {
+        gpuTimer.overflowDepth++;
+        return;
+    }
+
+    /* Keep EndPass balanced even when the pass itself is not recorded */
+    if (slot->count >= GPU_TIMER_MAX_PASSES || !BackendRecording()) {
+        gpuTimer.stack[gpuTimer.stackDepth++] = U32_MAX;
+        return;
+    }
+
+    u32 pass = slot->count++;
+    slot->names[pass]  = name;
+    slot->depths[pass] = (u8)gpuTimer.stackDepth;
+
+    gpuTimer.stack[gpuTimer.stackDepth++] = pass;
+    BackendWrite(slot, pass * 2, False);
+}
+
+void __namespace(EndPass)(void)
+{
+    GpuTimerSlot* slot = gpuTimer.current;
+    if (!slot) return;
+
+    if (gpuTimer.overflowDepth > 0) {
+        gpuTimer.overflowDepth--;
+        return;
+    }
+    if (gpuTimer.stackDepth == 0) return;
+
+    u32 pass = gpuTimer.stack[--gpuTimer.stackDepth];
+    if (pass == U32_MAX) return;
+
+    BackendWrite(slot, pass * 2 + 1, True);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
@@ -0,0 +1,40 @@
+#ifndef __gpu_timer_h__
+#define __gpu_timer_h__
+
+#include <core/types.h>
+
+#ifdef GLX_VULKAN
+    #include <vulkan/vulkan.h>
+#endif
+
+#define __namespace( func_name ) renderer##_##GpuTimer##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define GPU_TIMER_MAX_PASSES 32
+#define GPU_TIMER_LATENCY    4      /* frames in flight before a result is read back */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8   __namespace( Init )       ( void );
+void __namespace( Shutdown )   ( void );
+
+/* Reads back finished frames into the profiler, never waits on the GPU */
+void __namespace( BeginFrame ) ( u64 frameIndex );
+void __namespace( EndFrame )   ( void );
+
+void __namespace( BeginPass )  ( const char* name );
+void __namespace( EndPass )    ( void );
+
+#ifdef GLX_VULKAN
+/* Timestamps are recorded into this command buffer, must be outside a render pass on first use */
+void __namespace( SetCommandBuffer ) ( VkCommandBuffer commandBuffer );
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __gpu_timer_h__ */
@@ -0,0 +1,81 @@
+// hot_reload.c
+#include "hot_reload.h"
+
+#include <core/debug.h>
+#include <render/shader_variant.h>
+#include <platform/watch/factory.h>
+#include <string.h>
+
+#define __namespace(func_name) renderer_HotReload##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Editors save through several events, one frame's worth of changes is reloaded once per file */
+#define HOT_RELOAD_BATCH 16
+
+static const char* sourceExtensions[] = { ".vert", ".frag", ".glsl" };
+
+static struct
+{
+    u8 enabled;
+} hotReload = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static u8 IsShaderSource(const char* path)
+{
+    const char* extension = strrchr(path, '.');
+    if (!extension) return False;
+
+    for (u32 i = 0; i < ARRAY_SIZE(sourceExtensions); i++)
+        if (strcmp(extension, sourceExtensions[i]) == 0) return True;
+    return False;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace(Init)(const char* directory)
+{
+    hotReload.enabled = platform_WatchInit(directory ? directory : HOT_RELOAD_DEFAULT_DIR);
+    if (!hotReload.enabled)
+        LOG_WARN("Hot reload: disabled, shader edits need a restart");
+    return hotReload.enabled;
+}
+
+void __namespace(Shutdown)(void)
+{
+    if (hotReload.enabled) platform_WatchShutdown();
+    hotReload.enabled = False;
+}
+
+u32 __namespace(Update)(ShaderLibrary* lib)
+{
+    if (!hotReload.enabled) return 0;
+
+    WatchEvent batch[HOT_RELOAD_BATCH];
+    u32        count = 0;
+
+    WatchEvent event;
+    while (count < HOT_RELOAD_BATCH && platform_WatchPoll(&event)) {
+        if (!IsShaderSource(event.path)) continue;
+
+        u8 seen = False;
+        for (u32 i = 0; i < count && !seen; i++)
+            seen = strcmp(batch[i].path, event.path) == 0;
+        if (!seen) batch[count++] = event;
+    }
+
+    u32 submitted = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 reloads = renderer_ShaderLibraryReloadFile(lib, batch[i].path) +
+                      renderer_ShaderVariantReloadFile(batch[i].path);
+
+        if (reloads) LOG_INFO("Hot reload: '%s' changed, %u shaders recompiling", batch[i].path, reloads);
+        submitted += reloads;
+    }
+    return submitted;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
@@ -0,0 +1,31 @@
+#ifndef __hot_reload_h__
+#define __hot_reload_h__
+
+#include <core/types.h>
+#include <render/shader.h>
+
+#define __namespace( func_name ) renderer##_##HotReload##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define HOT_RELOAD_DEFAULT_DIR "assets/shaders"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Watches the directory from a platform thread, False when the platform has no watcher */
+u8   __namespace( Init )     ( const char* directory );
+void __namespace( Shutdown ) ( void );
+
+/*
+ * Drains the changes queued since the last call and submits a reload for every library shader and variant set
+ * built from a changed file. Never waits on the compiler, the swap happens in the regular polls.
+ */
+u32  __namespace( Update )   ( ShaderLibrary* lib );
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __hot_reload_h__ */
@@ -0,0 +1,453 @@
+// indirect.c
+#include "indirect.h"
+
+#include <core/debug.h>
+#include <core/memory.h>
+#include <string.h>
+
+#ifdef GLX_OPENGL
+    #include <glad/glad.h>
+    #include <render/gl_state.h>
+#elif defined(GLX_VULKAN)
+    #include <platform/glx/vulkan/helpers.h>
+#endif
+
+#define __namespace(func_name) renderer_Indirect##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+STATIC_ASSERT(sizeof(IndirectDrawData) == 80, indirect_draw_data_matches_std430);
+STATIC_ASSERT(sizeof(IndirectCommand) == 20, indirect_command_matches_the_api);
+
+typedef struct
+{
+    u32 firstIndex;
+    u32 indexCount;
+    i32 baseVertex;
+} IndirectMesh;
+
+/*
+ * Commands and per-draw data are two rings with segments of maxDraws entries, the storage segments start at the
+ * device offset alignment so each can be bound on its own.
+ */
+static struct
+{
+    MeshHandle   geometry;      /* shared vertex and index buffers, its own index count is unused */
+    BufferHandle drawIndices;   /* 0, 1, 2, ... read once per instance */
+    StreamRing   commands;
+    StreamRing   storage;
+
+    IndirectMesh meshes[INDIRECT_MAX_MESHES];
+    u32          meshCount;
+    u32          stride;
+    u32          maxVertices;
+    u32          maxIndices;
+    u32          vertexCount;
+    u32          indexCount;
+
+    u32          maxDraws;
+    u32          align;
+    u32          drawCount;     /* pushed this frame */
+    u32          submitted;     /* draws below this were issued */
+    u8           warnedFull;
+    u8           initialized;
+
+    #ifdef GLX_VULKAN
+    u32                   maxDrawCount; /* commands per call, maxDrawIndirectCount or 1 without multiDrawIndirect */
+    VkDescriptorSetLayout setLayout;
+    VkDescriptorPool      descriptorPool;
+    VkDescriptorSet       descriptorSet;
+    VkCommandBuffer       commandBuffer;
+    VkPipelineLayout      pipelineLayout;
+    #endif
+} indirect = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline u32 AlignUp(u32 value, u32 align)
+{
+    return (value + align - 1) / align * align;
+}
+
+static inline IndirectCommand* CommandData(void)
+{
+    return (IndirectCommand*)renderer_StreamRingData(&indirect.commands);
+}
+
+static inline IndirectDrawData* StorageData(void)
+{
+    return (IndirectDrawData*)renderer_StreamRingData(&indirect.storage);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Backend
+
+#ifdef GLX_OPENGL
+
+static u8 BackendInit(void)
+{
+    if (!GLAD_GL_VERSION_4_3 && !(GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_shader_storage_buffer_object &&
+            GLAD_GL_ARB_base_instance)) {
+        LOG_WARN("Indirect: multi-draw indirect or shader storage buffers not supported");
+        return False;
+    }
+
+    GLint align = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &align);
+    indirect.align = align > 0 ? (u32)align : 256;
+    return True;
+}
+
+/* The draw index is an integer attribute stepping once per instance, so baseInstance selects it */
+static void SetupDrawIndex(u32 vao, u32 drawIndices)
+{
+    if (renderer_ResourceDirectStateAccess()) {
+        glVertexArrayVertexBuffer(vao, INDIRECT_BINDING_DRAW, drawIndices, 0, sizeof(u32));
+        glVertexArrayAttribIFormat(vao, INDIRECT_LOCATION_DRAW, 1, GL_UNSIGNED_INT, 0);
+        glVertexArrayAttribBinding(vao, INDIRECT_LOCATION_DRAW, INDIRECT_BINDING_DRAW);
+        glVertexArrayBindingDivisor(vao, INDIRECT_BINDING_DRAW, 1);
+        glEnableVertexArrayAttrib(vao, INDIRECT_LOCATION_DRAW);
+        return;
+    }
+
+    renderer_GlStateBindVertexArray(vao);
+    renderer_GlStateBindBuffer(GL_ARRAY_BUFFER, drawIndices);
+    glVertexAttribIPointer(INDIRECT_LOCATION_DRAW, 1, GL_UNSIGNED_INT, sizeof(u32), 0);
+    glVertexAttribDivisor(INDIRECT_LOCATION_DRAW, 1);
+    glEnableVertexAttribArray(INDIRECT_LOCATION_DRAW);
+}
+
+static u8 BackendCreate(void)
+{
+    const MeshResource* geometry = renderer_ResourceMeshGet(indirect.geometry);
+
+    SetupDrawIndex(geometry->vao, renderer_ResourceBufferGet(indirect.drawIndices)->glName);
+    return True;
+}
+
+static void BackendDestroy(void) {}
+
+static void Issue(u32 first, u32 count)
+{
+    const MeshResource* geometry = renderer_ResourceMeshGet(indirect.geometry);
+
+    renderer_GlStateBindBufferRange(GL_SHADER_STORAGE_BUFFER, INDIRECT_STORAGE_BINDING, indirect.storage.glName,
+        renderer_StreamRingBase(&indirect.storage), indirect.storage.segmentSize);
+    renderer_GlStateBindVertexArray(geometry->vao);
+    renderer_GlStateBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect.commands.glName);
+
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+        (const void*)(uintptr_t)(renderer_StreamRingBase(&indirect.commands) + first * sizeof(IndirectCommand)),
+        (GLsizei)count, 0);
+}
+
+#elif defined(GLX_VULKAN)
+
+/* The device has to be created with drawIndirectFirstInstance, and multiDrawIndirect when available */
+static u8 BackendInit(void)
+{
+    VkPhysicalDeviceProperties properties;
+    VkPhysicalDeviceFeatures   features;
+    vkGetPhysicalDeviceProperties(vk_get_physical_device(), &properties);
+    vkGetPhysicalDeviceFeatures(vk_get_physical_device(), &features);
+
+    if (!features.drawIndirectFirstInstance) {
+        LOG_WARN("Indirect: drawIndirectFirstInstance not supported, the draw index can not be passed");
+        return False;
+    }
+
+    indirect.maxDrawCount = features.multiDrawIndirect ? MAX(properties.limits.maxDrawIndirectCount, 1u) : 1;
+    indirect.align        = (u32)MAX(properties.limits.minStorageBufferOffsetAlignment, 16);
+    return True;
+}
+
+/* DrawBlock is a dynamic storage buffer, the offset picks the segment */
+static u8 BackendCreate(void)
+{
+    VkDevice device = vk_get_device();
+    const BufferResource* storage = renderer_ResourceBufferGet(indirect.storage.buffer);
+
+    VkDescriptorSetLayoutBinding binding = {
+        .binding         = INDIRECT_STORAGE_BINDING,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_VERTEX_BIT,
+    };
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 1,
+        .pBindings    = &binding,
+    };
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, NULL, &indirect.setLayout) != VK_SUCCESS)
+        return False;
+
+    VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1 };
+    VkDescriptorPoolCreateInfo poolInfo = {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets       = 1,
+        .poolSizeCount = 1,
+        .pPoolSizes    = &poolSize,
+    };
+    if (vkCreateDescriptorPool(device, &poolInfo, NULL, &indirect.descriptorPool) != VK_SUCCESS)
+        return False;
+
+    VkDescriptorSetAllocateInfo allocInfo = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = indirect.descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &indirect.setLayout,
+    };
+    if (vkAllocateDescriptorSets(device, &allocInfo, &indirect.descriptorSet) != VK_SUCCESS)
+        return False;
+
+    VkDescriptorBufferInfo info  = { storage->buffer, 0, indirect.storage.segmentSize };
+    VkWriteDescriptorSet   write = {
+        .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet          = indirect.descriptorSet,
+        .dstBinding      = INDIRECT_STORAGE_BINDING,
+        .descriptorCount = 1,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+        .pBufferInfo     = &info,
+    };
+    vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+    return True;
+}
+
+static void BackendDestroy(void)
+{
+    VkDevice device = vk_get_device();
+
+    if (indirect.descriptorPool) vkDestroyDescriptorPool(device, indirect.descriptorPool, NULL);
+    if (indirect.setLayout) vkDestroyDescriptorSetLayout(device, indirect.setLayout, NULL);
+
+    indirect.descriptorPool = VK_NULL_HANDLE;
+    indirect.setLayout      = VK_NULL_HANDLE;
+    indirect.descriptorSet  = VK_NULL_HANDLE;
+}
+
+static void Issue(u32 first, u32 count)
+{
+    if (!indirect.commandBuffer || !indirect.pipelineLayout) return;
+
+    const MeshResource*   geometry = renderer_ResourceMeshGet(indirect.geometry);
+    const BufferResource* vertices = renderer_ResourceBufferGet(geometry->vertexBuffer);
+    const BufferResource* indices  = renderer_ResourceBufferGet(geometry->indexBuffer);
+    const BufferResource* draws    = renderer_ResourceBufferGet(indirect.drawIndices);
+    const BufferResource* commands = renderer_ResourceBufferGet(indirect.commands.buffer);
+
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(indirect.commandBuffer, 0, 1, &vertices->buffer, &offset);
+    vkCmdBindVertexBuffers(indirect.commandBuffer, INDIRECT_BINDING_DRAW, 1, &draws->buffer, &offset);
+    vkCmdBindIndexBuffer(indirect.commandBuffer, indices->buffer, 0, VK_INDEX_TYPE_UINT32);
+
+    u32 storageOffset = renderer_StreamRingBase(&indirect.storage);
+    vkCmdBindDescriptorSets(indirect.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, indirect.pipelineLayout,
+        1, 1, &indirect.descriptorSet, 1, &storageOffset);
+
+    /* The device caps the draw count of one call, split the batch when it is larger */
+    VkDeviceSize commandOffset = renderer_StreamRingBase(&indirect.commands) +
+        (VkDeviceSize)first * sizeof(IndirectCommand);
+    while (count) {
+        u32 batch = MIN(count, indirect.maxDrawCount);
+        vkCmdDrawIndexedIndirect(indirect.commandBuffer, commands->buffer, commandOffset, batch,
+            sizeof(IndirectCommand));
+        commandOffset += (VkDeviceSize)batch * sizeof(IndirectCommand);
+        count         -= batch;
+    }
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void Release(void)
+{
+    BackendDestroy();
+    renderer_ResourceMeshDestroy(indirect.geometry);
+    renderer_ResourceBufferDestroy(indirect.drawIndices);
+    renderer_StreamRingDestroy(&indirect.commands);
+    renderer_StreamRingDestroy(&indirect.storage);
+    memset(&indirect, 0, sizeof(indirect));
+}
+
+u8 __namespace(Init)(const VertexLayout* layout, u32 maxVertices, u32 maxIndices, u32 maxDraws)
+{
+    if (indirect.initialized) return True;
+    if (!layout || !maxVertices || !maxIndices || !maxDraws || !BackendInit()) return False;
+
+    indirect.stride      = layout->stride;
+    indirect.maxVertices = maxVertices;
+    indirect.maxIndices  = maxIndices;
+    indirect.maxDraws    = maxDraws;
+
+    /* Geometry is filled in by AddMesh */
+    MeshDesc desc = { .vertexCount = maxVertices, .indexCount = maxIndices, .layout = *layout };
+    indirect.geometry = renderer_ResourceMeshCreate(&desc);
+
+    u32* drawIndices = (u32*)core_MemoryAlloc(maxDraws * sizeof(u32), MEMORY_TAG_RENDER);
+    if (drawIndices) {
+        for (u32 i = 0; i < maxDraws; i++) drawIndices[i] = i;
+        indirect.drawIndices = renderer_ResourceBufferCreate(BUFFER_TYPE_VERTEX, drawIndices, maxDraws * sizeof(u32));
+        core_MemoryFree(drawIndices);
+    }
+
+    u32 commandSize = maxDraws * (u32)sizeof(IndirectCommand);
+    u32 storageSize = AlignUp(maxDraws * (u32)sizeof(IndirectDrawData), indirect.align);
+
+    if (RESOURCE_HANDLE_IS_NULL(indirect.geometry) || RESOURCE_HANDLE_IS_NULL(indirect.drawIndices) ||
+        !renderer_StreamRingCreate(&indirect.commands, "Indirect", BUFFER_TYPE_INDIRECT, commandSize) ||
+        !renderer_StreamRingCreate(&indirect.storage, "Indirect", BUFFER_TYPE_STORAGE, storageSize) ||
+        !BackendCreate()) {
+        LOG_ERROR("Indirect: failed to create buffers for %u vertices, %u indices and %u draws",
+            maxVertices, maxIndices, maxDraws);
+        Release();
+        return False;
+    }
+
+    indirect.initialized = True;
+
+    LOG_INFO("Indirect: %u vertices, %u indices, %u segments of %u draws",
+        maxVertices, maxIndices, INDIRECT_FRAMES_IN_FLIGHT, maxDraws);
+    return True;
+}
+
+void __namespace(Shutdown)(void)
+{
+    if (indirect.initialized) Release();
+}
+
+u32 __namespace(AddMesh)(const MeshDesc* desc)
+{
+    if (!indirect.initialized || !desc) return INDIRECT_MESH_INVALID;
+
+    if (desc->layout.stride != indirect.stride) {
+        LOG_WARN("Indirect: mesh stride %u does not match the shared layout (%u)", desc->layout.stride,
+            indirect.stride);
+        return INDIRECT_MESH_INVALID;
+    }
+
+    if (indirect.meshCount == INDIRECT_MAX_MESHES ||
+        desc->vertexCount > indirect.maxVertices - indirect.vertexCount ||
+        desc->indexCount > indirect.maxIndices - indirect.indexCount) {
+        LOG_WARN("Indirect: no room for a mesh of %u vertices and %u indices", desc->vertexCount, desc->indexCount);
+        return INDIRECT_MESH_INVALID;
+    }
+
+    const MeshResource* geometry = renderer_ResourceMeshGet(indirect.geometry);
+    renderer_ResourceBufferUpdate(geometry->vertexBuffer, (usize)indirect.vertexCount * indirect.stride,
+        desc->vertices, (usize)desc->vertexCount * indirect.stride);
+    renderer_ResourceBufferUpdate(geometry->indexBuffer, (usize)indirect.indexCount * sizeof(u32),
+        desc->indices, (usize)desc->indexCount * sizeof(u32));
+
+    /* Indices stay relative to the mesh, baseVertex moves them to where its vertices landed */
+    indirect.meshes[indirect.meshCount] = (IndirectMesh){
+        .firstIndex = indirect.indexCount,
+        .indexCount = desc->indexCount,
+        .baseVertex = (i32)indirect.vertexCount,
+    };
+    indirect.vertexCount += desc->vertexCount;
+    indirect.indexCount  += desc->indexCount;
+    return indirect.meshCount++;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace(BeginFrame)(void)
+{
+    if (!indirect.initialized) return;
+
+    renderer_StreamRingBegin(&indirect.commands);
+    renderer_StreamRingBegin(&indirect.storage);
+
+    indirect.drawCount  = 0;
+    indirect.submitted  = 0;
+    indirect.warnedFull = False;
+}
+
+void __namespace(EndFrame)(void)
+{
+    if (!indirect.initialized) return;
+
+    renderer_StreamRingEnd(&indirect.commands);
+    renderer_StreamRingEnd(&indirect.storage);
+}
+
+u32 __namespace(Push)(u32 mesh, const IndirectDrawData* data)
+{
+    if (!indirect.initialized || mesh >= indirect.meshCount || !data) return INDIRECT_DRAW_INVALID;
+
+    if (indirect.drawCount == indirect.maxDraws) {
+        if (!indirect.warnedFull)
+            LOG_WARN("Indirect: more than %u draws this frame, extra draws are dropped", indirect.maxDraws);
+        indirect.warnedFull = True;
+        return INDIRECT_DRAW_INVALID;
+    }
+
+    /* baseInstance is the draw's slot, the instanced draw index attribute reads it back in the shader */
+    u32 draw = indirect.drawCount++;
+    const IndirectMesh* range = &indirect.meshes[mesh];
+
+    CommandData()[draw] = (IndirectCommand){
+        .indexCount    = range->indexCount,
+        .instanceCount = 1,
+        .firstIndex    = range->firstIndex,
+        .baseVertex    = range->baseVertex,
+        .baseInstance  = draw,
+    };
+    StorageData()[draw] = *data;
+    return draw;
+}
+
+u32 __namespace(Submit)(void)
+{
+    if (!indirect.initialized || indirect.submitted == indirect.drawCount) return 0;
+
+    u32 first = indirect.submitted;
+    u32 count = indirect.drawCount - first;
+
+    renderer_StreamRingUpload(&indirect.commands, first * (u32)sizeof(IndirectCommand),
+        count * (u32)sizeof(IndirectCommand));
+    renderer_StreamRingUpload(&indirect.storage, first * (u32)sizeof(IndirectDrawData),
+        count * (u32)sizeof(IndirectDrawData));
+    Issue(first, count);
+
+    indirect.submitted = indirect.drawCount;
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef GLX_VULKAN
+
+VkDescriptorSetLayout __namespace(GetDescriptorSetLayout)(void)
+{
+    return indirect.setLayout;
+}
+
+void __namespace(VertexInput)(VkVertexInputBindingDescription* binding, VkVertexInputAttributeDescription* attribute)
+{
+    *binding = (VkVertexInputBindingDescription){
+        .binding   = INDIRECT_BINDING_DRAW,
+        .stride    = sizeof(u32),
+        .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE,
+    };
+    *attribute = (VkVertexInputAttributeDescription){
+        .location = INDIRECT_LOCATION_DRAW,
+        .binding  = INDIRECT_BINDING_DRAW,
+        .format   = VK_FORMAT_R32_UINT,
+        .offset   = 0,
+    };
+}
+
+void __namespace(SetCommandBuffer)(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+{
+    indirect.commandBuffer  = commandBuffer;
+    indirect.pipelineLayout = pipelineLayout;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
@@ -0,0 +1,88 @@
+#ifndef __indirect_h__
+#define __indirect_h__
+
+#include <core/types.h>
+#include <core/math.h>
+#include <render/resource.h>
+#include <render/ubo.h>
+
+#ifdef GLX_VULKAN
+    #include <vulkan/vulkan.h>
+#endif
+
+#define __namespace( func_name ) renderer##_##Indirect##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * GPU-driven submission. Meshes added here share one vertex and one index buffer, so every draw of the frame becomes a
+ * DrawElementsIndirectCommand in a streamed command buffer and a shader switch costs one multi-draw call. Per-draw
+ * data sits in a storage buffer indexed by the draw: each command carries its index as baseInstance, and a
+ * per-instance attribute over 0, 1, 2, ... turns it back into a value the shader can read without draw parameters:
+ *
+ *     layout(location = 13) in uint inDrawIndex;
+ *     layout(std430, binding = 0) readonly buffer DrawBlock { DrawData uDraws[]; };
+ */
+#define INDIRECT_FRAMES_IN_FLIGHT  UBO_FRAMES_IN_FLIGHT
+#define INDIRECT_MAX_MESHES        256
+#define INDIRECT_STORAGE_BINDING   0
+#define INDIRECT_BINDING_DRAW      2           /* vertex buffer binding of the draw index, after mesh and instances */
+#define INDIRECT_LOCATION_DRAW     ( VERTEX_LOCATION_INSTANCE + 5 )
+#define INDIRECT_MESH_INVALID      0xFFFFFFFFu
+#define INDIRECT_DRAW_INVALID      0xFFFFFFFFu
+
+/* std430, must match the GLSL DrawData struct */
+typedef struct
+{
+    Mat4 model;
+    Vec4 color;         /* multiplies the vertex color */
+} IndirectDrawData;
+
+/* Laid out as glMultiDrawElementsIndirect and vkCmdDrawIndexedIndirect read it */
+typedef struct
+{
+    u32 indexCount;
+    u32 instanceCount;
+    u32 firstIndex;
+    i32 baseVertex;
+    u32 baseInstance;
+} IndirectCommand;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Every mesh added shares the layout. Capacities are in vertices, indices and draws per frame */
+u8   __namespace( Init )       ( const VertexLayout* layout, u32 maxVertices, u32 maxIndices, u32 maxDraws );
+void __namespace( Shutdown )   ( void );
+
+/* Copies the geometry into the shared buffers, INDIRECT_MESH_INVALID when it does not fit */
+u32  __namespace( AddMesh )    ( const MeshDesc* desc );
+
+/* Moves to the next ring segment, waits only if the GPU still reads it from INDIRECT_FRAMES_IN_FLIGHT frames ago */
+void __namespace( BeginFrame ) ( void );
+void __namespace( EndFrame )   ( void );
+
+/* Queues one draw of the mesh, returns its index in this frame's DrawBlock or INDIRECT_DRAW_INVALID when full */
+u32  __namespace( Push )       ( u32 mesh, const IndirectDrawData* data );
+
+/* Issues every draw pushed since the last submit with the bound shader in one call, returns how many */
+u32  __namespace( Submit )     ( void );
+
+#ifdef GLX_VULKAN
+/* Set 1 of a pipeline layout that reads DrawBlock, set 0 stays the shared uniform blocks */
+VkDescriptorSetLayout __namespace( GetDescriptorSetLayout ) ( void );
+
+/* Binding and attribute to append to the vertex input state of an indirect pipeline */
+void __namespace( VertexInput )      ( VkVertexInputBindingDescription* binding,
+                                       VkVertexInputAttributeDescription* attribute );
+
+/* Submit records into this command buffer against this pipeline layout */
+void __namespace( SetCommandBuffer ) ( VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout );
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __indirect_h__ */
@@ -0,0 +1,260 @@
+// instance.c
+#include "instance.h"
+
+#include <core/debug.h>
+#include <string.h>
+#include <stddef.h>
+
+#ifdef GLX_OPENGL
+    #include <glad/glad.h>
+    #include <render/gl_state.h>
+#elif defined(GLX_VULKAN)
+    #include <platform/glx/vulkan/helpers.h>
+#endif
+
+#define __namespace(func_name) renderer_Instance##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+STATIC_ASSERT(sizeof(InstanceData) == 80, instance_data_is_tightly_packed);
+
+/* The mat4 takes one location per column */
+static const VertexAttribute instanceAttributes[INSTANCE_ATTRIBUTE_COUNT] =
+{
+    { INSTANCE_LOCATION_MODEL + 0, 4, offsetof(InstanceData, model) + 0  },
+    { INSTANCE_LOCATION_MODEL + 1, 4, offsetof(InstanceData, model) + 16 },
+    { INSTANCE_LOCATION_MODEL + 2, 4, offsetof(InstanceData, model) + 32 },
+    { INSTANCE_LOCATION_MODEL + 3, 4, offsetof(InstanceData, model) + 48 },
+    { INSTANCE_LOCATION_COLOR,     4, offsetof(InstanceData, color)      },
+};
+
+/* Ring segments of capacity instances each */
+static struct
+{
+    StreamRing   ring;
+    u32          capacity;
+    u32          count;         /* reserved this frame */
+    u32          uploaded;      /* instances below this are on the GPU */
+    u8           warnedFull;
+    u8           initialized;
+
+    #ifdef GLX_VULKAN
+    VkCommandBuffer commandBuffer;
+    #endif
+} instances = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline u32 SegmentBase(void)
+{
+    return renderer_StreamRingBase(&instances.ring);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Backend
+
+#ifdef GLX_OPENGL
+
+static u8 BackendInit(void)
+{
+    /* Attribute divisors and sync objects */
+    if (!GLAD_GL_VERSION_3_3) {
+        LOG_WARN("Instancing: needs GL 3.3 for instanced attributes");
+        return False;
+    }
+    return True;
+}
+
+/* Format and divisor once per mesh, the buffer offset moves with the segment on every draw */
+static void SetupDirect(MeshResource* mesh)
+{
+    if (mesh->instanced) return;
+
+    for (u32 i = 0; i < INSTANCE_ATTRIBUTE_COUNT; i++) {
+        const VertexAttribute* attribute = &instanceAttributes[i];
+        glEnableVertexArrayAttrib(mesh->vao, attribute->location);
+        glVertexArrayAttribFormat(mesh->vao, attribute->location, (GLint)attribute->components, GL_FLOAT,
+            GL_FALSE, attribute->offset);
+        glVertexArrayAttribBinding(mesh->vao, attribute->location, INSTANCE_BINDING);
+    }
+    glVertexArrayBindingDivisor(mesh->vao, INSTANCE_BINDING, 1);
+    mesh->instanced = True;
+}
+
+/* Without separate bindings each attribute captures the array buffer and its offset */
+static void SetupBound(MeshResource* mesh, usize offset)
+{
+    renderer_GlStateBindBuffer(GL_ARRAY_BUFFER, instances.ring.glName);
+
+    for (u32 i = 0; i < INSTANCE_ATTRIBUTE_COUNT; i++) {
+        const VertexAttribute* attribute = &instanceAttributes[i];
+        glVertexAttribPointer(attribute->location, (GLint)attribute->components, GL_FLOAT, GL_FALSE,
+            sizeof(InstanceData), (void*)(uintptr_t)(offset + attribute->offset));
+
+        if (!mesh->instanced) {
+            glEnableVertexAttribArray(attribute->location);
+            glVertexAttribDivisor(attribute->location, 1);
+        }
+    }
+    mesh->instanced = True;
+}
+
+static void Draw(MeshResource* mesh, u32 first, u32 count)
+{
+    usize offset = SegmentBase() + (usize)first * sizeof(InstanceData);
+
+    if (renderer_ResourceDirectStateAccess()) {
+        SetupDirect(mesh);
+        glVertexArrayVertexBuffer(mesh->vao, INSTANCE_BINDING, instances.ring.glName, (GLintptr)offset,
+            sizeof(InstanceData));
+        renderer_GlStateBindVertexArray(mesh->vao);
+    } else {
+        renderer_GlStateBindVertexArray(mesh->vao);
+        SetupBound(mesh, offset);
+    }
+
+    glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)mesh->indexCount, GL_UNSIGNED_INT, 0, (GLsizei)count);
+}
+
+#elif defined(GLX_VULKAN)
+
+/* The mesh and the instances are bound together in one call */
+STATIC_ASSERT(INSTANCE_BINDING == 1, instance_binding_follows_the_mesh);
+
+static u8 BackendInit(void)
+{
+    return True;
+}
+
+static void Draw(MeshResource* mesh, u32 first, u32 count)
+{
+    if (!instances.commandBuffer) return;
+
+    const BufferResource* vertices = renderer_ResourceBufferGet(mesh->vertexBuffer);
+    const BufferResource* indices  = renderer_ResourceBufferGet(mesh->indexBuffer);
+    const BufferResource* buffer   = renderer_ResourceBufferGet(instances.ring.buffer);
+
+    VkBuffer     buffers[2] = { vertices->buffer, buffer->buffer };
+    VkDeviceSize offsets[2] = { 0, SegmentBase() + (VkDeviceSize)first * sizeof(InstanceData) };
+
+    vkCmdBindVertexBuffers(instances.commandBuffer, 0, 2, buffers, offsets);
+    vkCmdBindIndexBuffer(instances.commandBuffer, indices->buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdDrawIndexed(instances.commandBuffer, mesh->indexCount, count, 0, 0, 0);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace(Init)(u32 capacity)
+{
+    if (instances.initialized) return True;
+    if (!BackendInit()) return False;
+
+    instances.capacity = capacity ? capacity : INSTANCE_DEFAULT_CAPACITY;
+
+    u32 segmentSize = instances.capacity * (u32)sizeof(InstanceData);
+    if (!renderer_StreamRingCreate(&instances.ring, "Instancing", BUFFER_TYPE_INSTANCE, segmentSize)) {
+        LOG_ERROR("Instancing: failed to create the %u byte instance ring", segmentSize * INSTANCE_FRAMES_IN_FLIGHT);
+        memset(&instances, 0, sizeof(instances));
+        return False;
+    }
+
+    instances.initialized = True;
+
+    LOG_INFO("Instancing: %u segments of %u instances", INSTANCE_FRAMES_IN_FLIGHT, instances.capacity);
+    return True;
+}
+
+void __namespace(Shutdown)(void)
+{
+    if (!instances.initialized) return;
+
+    renderer_StreamRingDestroy(&instances.ring);
+    memset(&instances, 0, sizeof(instances));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace(BeginFrame)(void)
+{
+    if (!instances.initialized) return;
+
+    renderer_StreamRingBegin(&instances.ring);
+
+    instances.count      = 0;
+    instances.uploaded   = 0;
+    instances.warnedFull = False;
+}
+
+void __namespace(EndFrame)(void)
+{
+    if (instances.initialized) renderer_StreamRingEnd(&instances.ring);
+}
+
+InstanceData* __namespace(Reserve)(u32 count, u32* first)
+{
+    if (!instances.initialized || !count) return NULL;
+
+    if (count > instances.capacity - instances.count) {
+        if (!instances.warnedFull)
+            LOG_WARN("Instancing: more than %u instances this frame, extra draws are dropped", instances.capacity);
+        instances.warnedFull = True;
+        return NULL;
+    }
+
+    InstanceData* data = (InstanceData*)renderer_StreamRingData(&instances.ring) + instances.count;
+    if (first) *first = instances.count;
+    instances.count += count;
+    return data;
+}
+
+void __namespace(DrawMesh)(MeshHandle handle, u32 first, u32 count)
+{
+    MeshResource* mesh = renderer_ResourceMeshGet(handle);
+    if (!instances.initialized || !mesh || !count || first + count > instances.count) return;
+
+    /* Ranges are usually drawn in the order they were reserved, the uploaded prefix then just grows */
+    if (first + count > instances.uploaded) {
+        u32 begin = first <= instances.uploaded ? instances.uploaded : first;
+        renderer_StreamRingUpload(&instances.ring, begin * (u32)sizeof(InstanceData),
+            (first + count - begin) * (u32)sizeof(InstanceData));
+        if (first <= instances.uploaded) instances.uploaded = first + count;
+    }
+
+    Draw(mesh, first, count);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef GLX_VULKAN
+
+void __namespace(VertexInput)(VkVertexInputBindingDescription* binding,
+    VkVertexInputAttributeDescription attributes[INSTANCE_ATTRIBUTE_COUNT])
+{
+    *binding = (VkVertexInputBindingDescription){
+        .binding   = INSTANCE_BINDING,
+        .stride    = sizeof(InstanceData),
+        .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE,
+    };
+
+    for (u32 i = 0; i < INSTANCE_ATTRIBUTE_COUNT; i++) {
+        attributes[i] = (VkVertexInputAttributeDescription){
+            .location = instanceAttributes[i].location,
+            .binding  = INSTANCE_BINDING,
+            .format   = VK_FORMAT_R32G32B32A32_SFLOAT,
+            .offset   = instanceAttributes[i].offset,
+        };
+    }
+}
+
+void __namespace(SetCommandBuffer)(VkCommandBuffer commandBuffer)
+{
+    instances.commandBuffer = commandBuffer;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
@@ -0,0 +1,70 @@
+#ifndef __instance_h__
+#define __instance_h__
+
+#include <core/types.h>
+#include <core/math.h>
+#include <render/resource.h>
+#include <render/ubo.h>
+
+#ifdef GLX_VULKAN
+    #include <vulkan/vulkan.h>
+#endif
+
+#define __namespace( func_name ) renderer##_##Instance##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Per-instance data streamed through a ring like the uniform blocks, one segment per frame in flight. Instanced
+ * shaders read it as vertex attributes with a divisor of 1:
+ *
+ *     layout(location = 8)  in mat4 inModel;          (8 to 11, one column each)
+ *     layout(location = 12) in vec4 inInstanceColor;
+ *
+ * A mesh drawn N times is one Reserve, N writes and one DrawMesh.
+ */
+#define INSTANCE_FRAMES_IN_FLIGHT  UBO_FRAMES_IN_FLIGHT
+#define INSTANCE_DEFAULT_CAPACITY  16384
+#define INSTANCE_BINDING           1           /* vertex buffer binding, the mesh itself reads binding 0 */
+#define INSTANCE_LOCATION_MODEL    VERTEX_LOCATION_INSTANCE
+#define INSTANCE_LOCATION_COLOR    ( VERTEX_LOCATION_INSTANCE + 4 )
+#define INSTANCE_ATTRIBUTE_COUNT   5
+
+typedef struct
+{
+    Mat4 model;
+    Vec4 color;         /* multiplies the vertex color, white when unused */
+} InstanceData;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Instances per frame, 0 picks INSTANCE_DEFAULT_CAPACITY */
+u8            __namespace( Init )       ( u32 capacity );
+void          __namespace( Shutdown )   ( void );
+
+/* Moves to the next ring segment, waits only if the GPU still reads it from INSTANCE_FRAMES_IN_FLIGHT frames ago */
+void          __namespace( BeginFrame ) ( void );
+void          __namespace( EndFrame )   ( void );
+
+/* Room for count instances in this frame's segment, NULL once the segment is full. first is passed to DrawMesh */
+InstanceData* __namespace( Reserve )    ( u32 count, u32* first );
+
+/* Uploads what was written since the last draw and issues one instanced draw of the mesh */
+void          __namespace( DrawMesh )   ( MeshHandle mesh, u32 first, u32 count );
+
+#ifdef GLX_VULKAN
+/* Binding and attributes to append to the vertex input state of an instanced pipeline */
+void          __namespace( VertexInput ) ( VkVertexInputBindingDescription* binding,
+                                           VkVertexInputAttributeDescription attributes[INSTANCE_ATTRIBUTE_COUNT] );
+
+/* DrawMesh records into this command buffer */
+void          __namespace( SetCommandBuffer ) ( VkCommandBuffer commandBuffer );
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __instance_h__ */
@@ -0,0 +1,346 @@
+// prewarm.c
+#include "prewarm.h"
+
+#include <core/debug.h>
+#include <core/memory.h>
+#include <core/profiler.h>
+#include <core/strid.h>
+#include <core/containers/hashmap.h>
+#include <render/shader_variant.h>
+#include <render/ubo.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef GLX_OPENGL
+    #include <glad/glad.h>
+    #include <render/gl_state.h>
+    #include <render/gl_debug.h>
+#endif
+
+#define __namespace(func_name) renderer_Prewarm##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define PREWARM_POLL_INTERVAL_NS 1000000     /* between completion checks while the driver compiles */
+
+typedef struct
+{
+    VertexLayout layout;
+    MeshHandle   mesh;      /* three vertices of zeros, only alive during Run */
+} PrewarmLayout;
+
+typedef struct
+{
+    Shader*                shader;
+    PrewarmLayout*         layout;  /* NULL compiles without drawing */
+    const RenderStateDesc* state;
+} PrewarmEntry;
+
+static struct
+{
+    HashMap layouts;        /* StringId -> PrewarmLayout */
+    HashMap states;         /* StringId -> RenderStateDesc */
+    u8      initialized;
+} prewarm = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static u8 EnsureInit(void)
+{
+    if (prewarm.initialized) return True;
+
+    Allocator allocator = core_AllocatorHeap(MEMORY_TAG_RENDER);
+    if (!HASHMAP_INIT_TYPE(&prewarm.layouts, PrewarmLayout, 8, &allocator)) return False;
+    if (!HASHMAP_INIT_TYPE(&prewarm.states, RenderStateDesc, 8, &allocator)) {
+        core_HashMapFree(&prewarm.layouts);
+        return False;
+    }
+
+    prewarm.initialized = True;
+    return True;
+}
+
+static inline u8 IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/* Next whitespace separated token on the line, NULL at the end */
+static const char* NextToken(const char** cursor, usize* length)
+{
+    const char* start = *cursor;
+    while (IsBlank(*start)) start++;
+    if (!*start) return NULL;
+
+    const char* end = start;
+    while (*end && !IsBlank(*end)) end++;
+
+    *cursor = end;
+    *length = (usize)(end - start);
+    return start;
+}
+
+/* Value of a "key=value" token, NULL when the token is not that key */
+static const char* TokenValue(const char* token, usize length, const char* key, usize* valueLength)
+{
+    usize keyLength = strlen(key);
+    if (length <= keyLength || memcmp(token, key, keyLength) != 0 || token[keyLength] != '=') return NULL;
+
+    *valueLength = length - keyLength - 1;
+    return token + keyLength + 1;
+}
+
+static u8 ParseLine(const char* manifestPath, const char* line, PrewarmEntry* entry)
+{
+    const char* cursor = line;
+    usize       length;
+    const char* token = NextToken(&cursor, &length);
+    if (!token || *token == '#') return False;
+
+    ShaderVariantSet* set = renderer_ShaderVariantFind(core_StrIdHash(token, length));
+    if (!set) {
+        LOG_WARN("Prewarm '%s': unknown shader '%.*s'", manifestPath, (int)length, token);
+        return False;
+    }
+
+    static const RenderStateDesc opaque = RENDER_STATE_OPAQUE;
+
+    ShaderFeatureMask mask = 0;
+    entry->layout = NULL;
+    entry->state  = &opaque;
+
+    while ((token = NextToken(&cursor, &length))) {
+        usize       valueLength;
+        const char* value;
+
+        if ((value = TokenValue(token, length, "layout", &valueLength))) {
+            entry->layout = HASHMAP_GET_TYPE(&prewarm.layouts, PrewarmLayout, core_StrIdHash(value, valueLength));
+            if (!entry->layout)
+                LOG_WARN("Prewarm '%s': unknown layout '%.*s'", manifestPath, (int)valueLength, value);
+        } else if ((value = TokenValue(token, length, "state", &valueLength))) {
+            const RenderStateDesc* state =
+                HASHMAP_GET_TYPE(&prewarm.states, RenderStateDesc, core_StrIdHash(value, valueLength));
+            if (state) entry->state = state;
+            else LOG_WARN("Prewarm '%s': unknown state '%.*s'", manifestPath, (int)valueLength, value);
+        } else {
+            mask |= renderer_ShaderVariantMask(set, core_StrIdHash(token, length));
+        }
+    }
+
+    entry->shader = renderer_ShaderVariantGet(set, mask);
+    return entry->shader != NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef GLX_OPENGL
+
+static u8 EnsureMesh(PrewarmLayout* layout)
+{
+    if (!RESOURCE_HANDLE_IS_NULL(layout->mesh)) return True;
+
+    static const u32 indices[3] = { 0, 1, 2 };
+
+    void* vertices = core_MemoryCalloc(3, layout->layout.stride, MEMORY_TAG_RENDER);
+    if (!vertices) return False;
+
+    MeshDesc desc = {
+        .vertices    = vertices,
+        .vertexCount = 3,
+        .indices     = indices,
+        .indexCount  = 3,
+        .layout      = layout->layout,
+    };
+    layout->mesh = renderer_ResourceMeshCreate(&desc);
+    core_MemoryFree(vertices);
+
+    return !RESOURCE_HANDLE_IS_NULL(layout->mesh);
+}
+
+static RenderStateDesc CurrentState(void)
+{
+    GLboolean depthWrite = GL_TRUE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthWrite);
+
+    return (RenderStateDesc){
+        .depthTest  = glIsEnabled(GL_DEPTH_TEST),
+        .depthWrite = depthWrite,
+        .cullBack   = glIsEnabled(GL_CULL_FACE),
+        .blend      = glIsEnabled(GL_BLEND),
+    };
+}
+
+/* Draws into a throwaway target, the framebuffer, viewport and fixed function state are restored afterwards */
+static u32 Draw(const PrewarmEntry* entries, u32 count)
+{
+    PROFILE_SCOPE("Prewarm draws");
+    renderer_GlDebugPushGroup("Prewarm");
+
+    GLint viewport[4], framebuffer = 0;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+    RenderStateDesc previous = CurrentState();
+
+    TextureHandle color = renderer_ResourceTextureCreate(PREWARM_TARGET_SIZE, PREWARM_TARGET_SIZE,
+        TEXTURE_FORMAT_RGBA8, NULL);
+    const TextureResource* colorTexture = renderer_ResourceTextureGet(color);
+
+    u32 depth = 0, fbo = 0;
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, PREWARM_TARGET_SIZE, PREWARM_TARGET_SIZE);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    if (colorTexture)
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture->glName, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+    /* Blocks read zeros, the uniform ring is only valid between UboBeginFrame and UboEndFrame */
+    usize        blockSize = MAX(sizeof(FrameBlock), MAX(sizeof(ViewBlock), sizeof(ObjectBlock)));
+    void*        zeros     = core_MemoryCalloc(1, blockSize, MEMORY_TAG_RENDER);
+    BufferHandle blocks    = renderer_ResourceBufferCreate(BUFFER_TYPE_UNIFORM, zeros, blockSize);
+    core_MemoryFree(zeros);
+
+    const BufferResource* blockBuffer = renderer_ResourceBufferGet(blocks);
+    if (blockBuffer)
+        for (u32 i = 0; i < UBO_BINDING_COUNT; i++)
+            renderer_GlStateBindBufferRange(GL_UNIFORM_BUFFER, i, blockBuffer->glName, 0, 0);
+
+    u32 drawn = 0;
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+        glViewport(0, 0, PREWARM_TARGET_SIZE, PREWARM_TARGET_SIZE);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        for (u32 i = 0; i < count; i++) {
+            const PrewarmEntry* entry = &entries[i];
+            if (!entry->layout || renderer_ShaderPoll(entry->shader) != SHADER_STATUS_READY) continue;
+
+            /* A layout the shader can not read would warm up a combination no frame ever draws */
+            if (!renderer_ResourceLayoutValidate(&entry->layout->layout, entry->shader)) continue;
+            if (!EnsureMesh(entry->layout)) continue;
+
+            renderer_ResourceApplyState(entry->state);
+            renderer_ShaderBind(entry->shader);
+            renderer_ResourceMeshDraw(entry->layout->mesh);
+            drawn++;
+        }
+        renderer_ShaderUbind();
+
+        /* The deferred driver work happens here instead of on the first frame that uses it */
+        glFinish();
+    } else {
+        LOG_WARN("Prewarm: offscreen target incomplete, variants are compiled but not drawn");
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, (u32)framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    renderer_ResourceApplyState(&previous);
+
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &depth);
+    renderer_ResourceTextureDestroy(color);
+    renderer_ResourceBufferDestroy(blocks);
+
+    u32            cursor = 0;
+    PrewarmLayout* layout;
+    while (core_HashMapNext(&prewarm.layouts, &cursor, NULL, (void**)&layout)) {
+        renderer_ResourceMeshDestroy(layout->mesh);
+        layout->mesh = (MeshHandle){0};
+    }
+
+    renderer_GlDebugPopGroup();
+    return drawn;
+}
+
+#endif /* GLX_OPENGL */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace(RegisterLayout)(const char* name, const VertexLayout* layout)
+{
+    if (!name || !layout || !layout->stride || !EnsureInit()) return False;
+
+    PrewarmLayout* slot = (PrewarmLayout*)core_HashMapInsert(&prewarm.layouts, core_StrIdIntern(name), NULL);
+    if (!slot) return False;
+
+    slot->layout = *layout;
+    slot->mesh   = (MeshHandle){0};
+    return True;
+}
+
+u8 __namespace(RegisterState)(const char* name, const RenderStateDesc* state)
+{
+    if (!name || !state || !EnsureInit()) return False;
+
+    RenderStateDesc* slot = (RenderStateDesc*)core_HashMapInsert(&prewarm.states, core_StrIdIntern(name), NULL);
+    if (!slot) return False;
+
+    *slot = *state;
+    return True;
+}
+
+void __namespace(Shutdown)(void)
+{
+    if (!prewarm.initialized) return;
+
+    core_HashMapFree(&prewarm.layouts);
+    core_HashMapFree(&prewarm.states);
+    prewarm.initialized = False;
+}
+
+u32 __namespace(Run)(const char* manifestPath)
+{
+    PROFILE_SCOPE("Shader prewarm");
+
+    if (!EnsureInit()) return 0;
+
+    char* text = renderer_ShaderReadSource(manifestPath);
+    if (!text) return 0;
+
+    u64 start = core_ProfilerNow();
+
+    u32 capacity = 1;
+    for (const char* c = text; *c; c++) capacity += *c == '\n';
+
+    PrewarmEntry* entries = (PrewarmEntry*)core_MemoryAlloc(capacity * sizeof(PrewarmEntry), MEMORY_TAG_RENDER);
+    if (!entries) {
+        core_MemoryFree(text);
+        return 0;
+    }
+
+    /* Every variant is submitted before the first wait so parallel compile has all of them at once */
+    u32 count = 0;
+    for (char* line = text; line && *line; ) {
+        char* next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+
+        if (ParseLine(manifestPath, line, &entries[count])) count++;
+        line = next;
+    }
+    core_MemoryFree(text);
+
+    PROFILE_BEGIN("Prewarm compile");
+    /* The driver threads do the work, spinning here would only take a core from them */
+    const struct timespec interval = { 0, PREWARM_POLL_INTERVAL_NS };
+    while (renderer_ShaderVariantPoll() > 0)
+        nanosleep(&interval, NULL);
+    PROFILE_END();
+
+    u32 drawn = 0;
+    #ifdef GLX_OPENGL
+    drawn = Draw(entries, count);
+    #endif
+
+    core_MemoryFree(entries);
+
+    LOG_INFO("Prewarm '%s': %u variants, %u draws in %.2f ms", manifestPath, count, drawn,
+        (core_ProfilerNow() - start) / 1000000.0);
+    return drawn;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
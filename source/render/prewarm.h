@@ -0,0 +1,38 @@
+#ifndef __prewarm_h__
+#define __prewarm_h__
+
+#include <core/types.h>
+#include <render/resource.h>
+
+#define __namespace( func_name ) renderer##_##Prewarm##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Drivers finish a program the first time it is drawn with a given vertex layout and state, which turns the first
+ * frame a material is visible into a spike. Prewarming pays that cost at load with a draw into a tiny offscreen
+ * target for every combination listed in a manifest.
+ */
+#define PREWARM_TARGET_SIZE 4
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Names the manifest refers to with layout= and state=, registering a name again replaces it */
+u8   __namespace( RegisterLayout ) ( const char* name, const VertexLayout* layout );
+u8   __namespace( RegisterState )  ( const char* name, const RenderStateDesc* state );
+void __namespace( Shutdown )       ( void );
+
+/*
+ * One combination per line: the variant set name, its features, then optional "layout=<name>" and "state=<name>".
+ * Blank lines and lines starting with '#' are skipped, a line without a layout is only compiled.
+ * Blocks until every listed variant has linked. Returns the number of offscreen draws issued.
+ */
+u32  __namespace( Run )            ( const char* manifestPath );
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __prewarm_h__ */
@@ -0,0 +1,736 @@
+// resource.c
+#include "resource.h"
+
+#include <core/debug.h>
+#include <core/memory.h>
+#include <string.h>
+
+#ifdef GLX_OPENGL
+    #include <glad/glad.h>
+    #include <render/gl_state.h>
+#elif defined(GLX_VULKAN)
+    #include <platform/glx/vulkan/helpers.h>
+#endif
+
+#define __namespace(func_name) renderer_Resource##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define RESOURCE_INITIAL_CAPACITY 64
+
+static struct
+{
+    HandleTable tables[RESOURCE_TYPE_COUNT];
+    u8          directStateAccess;  /* GL 4.5, objects are created and edited without binding them */
+    u8          initialized;
+} resources = {0};
+
+static const usize itemSizes[RESOURCE_TYPE_COUNT] =
+{
+    sizeof(ShaderResource),
+    sizeof(BufferResource),
+    sizeof(MeshResource),
+    sizeof(TextureResource),
+};
+
+static const char* typeNames[RESOURCE_TYPE_COUNT] = { "shader", "buffer", "mesh", "texture" };
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Backend
+
+#ifdef GLX_OPENGL
+
+static const u32 glBufferTargets[] =
+{
+    GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_ARRAY_BUFFER, GL_DRAW_INDIRECT_BUFFER,
+    GL_SHADER_STORAGE_BUFFER,
+};
+
+static inline u8 IsStreamed(const BufferResource* buffer)
+{
+    return buffer->type != BUFFER_TYPE_VERTEX && buffer->type != BUFFER_TYPE_INDEX;
+}
+
+/* Everything but mesh geometry is rewritten every frame, buffers created without data are filled in later */
+static u32 BufferStorageFlags(const BufferResource* buffer, const void* data)
+{
+    if (IsStreamed(buffer)) return GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT;
+    return data ? 0 : GL_DYNAMIC_STORAGE_BIT;
+}
+
+static u8 CreateBuffer(BufferResource* buffer, const void* data)
+{
+    if (resources.directStateAccess) {
+        glCreateBuffers(1, &buffer->glName);
+        glNamedBufferStorage(buffer->glName, (GLsizeiptr)buffer->size, data, BufferStorageFlags(buffer, data));
+        return buffer->glName != 0;
+    }
+
+    u32 target = glBufferTargets[buffer->type];
+
+    /* An element buffer bound with a vertex array current would be recorded into that array */
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+        renderer_GlStateBindVertexArray(0);
+
+    glGenBuffers(1, &buffer->glName);
+    renderer_GlStateBindBuffer(target, buffer->glName);
+    glBufferData(target, (GLsizeiptr)buffer->size, data,
+        buffer->type == BUFFER_TYPE_UNIFORM ? GL_DYNAMIC_DRAW : IsStreamed(buffer) ? GL_STREAM_DRAW : GL_STATIC_DRAW);
+
+    return buffer->glName != 0;
+}
+
+static void UpdateBuffer(BufferResource* buffer, usize offset, const void* data, usize size)
+{
+    if (resources.directStateAccess) {
+        glNamedBufferSubData(buffer->glName, (GLintptr)offset, (GLsizeiptr)size, data);
+        return;
+    }
+
+    u32 target = glBufferTargets[buffer->type];
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+        renderer_GlStateBindVertexArray(0);
+
+    renderer_GlStateBindBuffer(target, buffer->glName);
+    glBufferSubData(target, (GLintptr)offset, (GLsizeiptr)size, data);
+}
+
+static void DestroyBuffer(BufferResource* buffer)
+{
+    if (!buffer->glName) return;
+
+    glDeleteBuffers(1, &buffer->glName);
+    renderer_GlStateForget(buffer->glName);
+}
+
+/* Every attribute reads from vertex buffer binding 0 */
+static void CreateMeshDirect(MeshResource* mesh, const MeshDesc* desc, u32 vertices, u32 indices)
+{
+    glCreateVertexArrays(1, &mesh->vao);
+    glVertexArrayVertexBuffer(mesh->vao, 0, vertices, 0, (GLsizei)desc->layout.stride);
+    glVertexArrayElementBuffer(mesh->vao, indices);
+
+    for (u32 i = 0; i < desc->layout.count; i++) {
+        const VertexAttribute* attribute = &desc->layout.attributes[i];
+        glEnableVertexArrayAttrib(mesh->vao, attribute->location);
+        glVertexArrayAttribFormat(mesh->vao, attribute->location, (GLint)attribute->components, GL_FLOAT, GL_FALSE,
+            attribute->offset);
+        glVertexArrayAttribBinding(mesh->vao, attribute->location, 0);
+    }
+}
+
+static u8 CreateMesh(MeshResource* mesh, const MeshDesc* desc)
+{
+    const BufferResource* vertices = __namespace(BufferGet)(mesh->vertexBuffer);
+    const BufferResource* indices  = __namespace(BufferGet)(mesh->indexBuffer);
+
+    if (resources.directStateAccess) {
+        CreateMeshDirect(mesh, desc, vertices->glName, indices->glName);
+        return mesh->vao != 0;
+    }
+
+    glGenVertexArrays(1, &mesh->vao);
+    renderer_GlStateBindVertexArray(mesh->vao);
+
+    /* The element binding is VAO state, the array binding is captured by each attribute */
+    renderer_GlStateBindBuffer(GL_ARRAY_BUFFER, vertices->glName);
+    renderer_GlStateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices->glName);
+
+    for (u32 i = 0; i < desc->layout.count; i++) {
+        const VertexAttribute* attribute = &desc->layout.attributes[i];
+        glVertexAttribPointer(attribute->location, (GLint)attribute->components, GL_FLOAT, GL_FALSE,
+            (GLsizei)desc->layout.stride, (void*)(uintptr_t)attribute->offset);
+        glEnableVertexAttribArray(attribute->location);
+    }
+
+    renderer_GlStateBindVertexArray(0);
+
+    return mesh->vao != 0;
+}
+
+static void DestroyMesh(MeshResource* mesh)
+{
+    if (!mesh->vao) return;
+
+    glDeleteVertexArrays(1, &mesh->vao);
+    renderer_GlStateForget(mesh->vao);
+}
+
+static u8 CreateTexture(TextureResource* texture, const void* pixels)
+{
+    u32 internalFormat = texture->format == TEXTURE_FORMAT_R8 ? GL_R8 : GL_RGBA8;
+    u32 format         = texture->format == TEXTURE_FORMAT_R8 ? GL_RED : GL_RGBA;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (resources.directStateAccess) {
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture->glName);
+        glTextureStorage2D(texture->glName, 1, internalFormat, (GLsizei)texture->width, (GLsizei)texture->height);
+        if (pixels)
+            glTextureSubImage2D(texture->glName, 0, 0, 0, (GLsizei)texture->width, (GLsizei)texture->height,
+                format, GL_UNSIGNED_BYTE, pixels);
+        glTextureParameteri(texture->glName, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(texture->glName, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(texture->glName, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(texture->glName, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture->glName != 0;
+    }
+
+    glGenTextures(1, &texture->glName);
+    renderer_GlStateBindTexture(0, GL_TEXTURE_2D, texture->glName);
+    glTexImage2D(GL_TEXTURE_2D, 0, (GLint)internalFormat, (GLsizei)texture->width, (GLsizei)texture->height, 0,
+        format, GL_UNSIGNED_BYTE, pixels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    return texture->glName != 0;
+}
+
+static void DestroyTexture(TextureResource* texture)
+{
+    if (!texture->glName) return;
+
+    glDeleteTextures(1, &texture->glName);
+    renderer_GlStateForget(texture->glName);
+}
+
+#elif defined(GLX_VULKAN)
+
+static const VkBufferUsageFlags vkBufferUsages[] =
+{
+    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+    VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+};
+
+/* Host visible memory, fails when it can not be mapped */
+static u8 WriteMemory(VkDeviceMemory memory, const void* data, usize size)
+{
+    void* mapped;
+    if (vkMapMemory(vk_get_device(), memory, 0, size, 0, &mapped) != VK_SUCCESS) {
+        LOG_ERROR("Failed to map %zu bytes of Vulkan memory", size);
+        return False;
+    }
+
+    memcpy(mapped, data, size);
+    vkUnmapMemory(vk_get_device(), memory);
+    return True;
+}
+
+/* Host visible and holding a copy of data, released by the caller once the transfer is done */
+static u8 CreateStaging(const void* data, usize size, VkBuffer* staging, VkDeviceMemory* memory)
+{
+    if (!vk_create_buffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging, memory))
+        return False;
+
+    if (data && !WriteMemory(*memory, data, size)) {
+        vkDestroyBuffer(vk_get_device(), *staging, NULL);
+        vkFreeMemory(vk_get_device(), *memory, NULL);
+        return False;
+    }
+    return True;
+}
+
+static u8 CreateBuffer(BufferResource* buffer, const void* data)
+{
+    VkDevice device = vk_get_device();
+
+    /* Everything but mesh geometry is rewritten every frame, keep it host visible */
+    if (buffer->type != BUFFER_TYPE_VERTEX && buffer->type != BUFFER_TYPE_INDEX) {
+        if (!vk_create_buffer(buffer->size, vkBufferUsages[buffer->type],
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                &buffer->buffer, &buffer->memory))
+            return False;
+
+        return !data || WriteMemory(buffer->memory, data, buffer->size);
+    }
+
+    VkBuffer       staging;
+    VkDeviceMemory stagingMemory;
+    if (!CreateStaging(data, buffer->size, &staging, &stagingMemory))
+        return False;
+
+    u8 created = vk_create_buffer(buffer->size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | vkBufferUsages[buffer->type],
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &buffer->buffer, &buffer->memory);
+
+    if (created)
+        vk_copy_buffer(staging, buffer->buffer, buffer->size);
+
+    vkDestroyBuffer(device, staging, NULL);
+    vkFreeMemory(device, stagingMemory, NULL);
+    return created;
+}
+
+/* Geometry is device local, it is written through a staging copy */
+static void UpdateBuffer(BufferResource* buffer, usize offset, const void* data, usize size)
+{
+    VkDevice       device = vk_get_device();
+    VkBuffer       staging;
+    VkDeviceMemory stagingMemory;
+    if (!CreateStaging(data, size, &staging, &stagingMemory))
+        return;
+
+    VkBufferCopy    region        = { 0, offset, size };
+    VkCommandBuffer commandBuffer = vk_begin_single_time_commands();
+    vkCmdCopyBuffer(commandBuffer, staging, buffer->buffer, 1, &region);
+    vk_end_single_time_commands(commandBuffer);
+
+    vkDestroyBuffer(device, staging, NULL);
+    vkFreeMemory(device, stagingMemory, NULL);
+}
+
+static void DestroyBuffer(BufferResource* buffer)
+{
+    VkDevice device = vk_get_device();
+    if (buffer->buffer) vkDestroyBuffer(device, buffer->buffer, NULL);
+    if (buffer->memory) vkFreeMemory(device, buffer->memory, NULL);
+}
+
+/* Vertex input lives in the pipeline on Vulkan, a mesh is just its two buffers */
+static u8 CreateMesh(MeshResource* mesh, const MeshDesc* desc)
+{
+    UNUSED(mesh);
+    UNUSED(desc);
+    return True;
+}
+
+static void DestroyMesh(MeshResource* mesh)
+{
+    UNUSED(mesh);
+}
+
+static void TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout from, VkImageLayout to)
+{
+    VkImageMemoryBarrier barrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.oldLayout           = from;
+    barrier.newLayout           = to;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image               = image;
+    barrier.subresourceRange    = (VkImageSubresourceRange){ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    VkPipelineStageFlags source = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    VkPipelineStageFlags target = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    if (to == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+        target                = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    } else if (from == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+        source                = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, source, target, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+static u8 CreateImage(TextureResource* texture, VkFormat format)
+{
+    VkDevice device = vk_get_device();
+
+    VkImageCreateInfo info = { .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    info.imageType     = VK_IMAGE_TYPE_2D;
+    info.format        = format;
+    info.extent        = (VkExtent3D){ texture->width, texture->height, 1 };
+    info.mipLevels     = 1;
+    info.arrayLayers   = 1;
+    info.samples       = VK_SAMPLE_COUNT_1_BIT;
+    info.tiling        = VK_IMAGE_TILING_OPTIMAL;
+    info.usage         = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+    info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device, &info, NULL, &texture->image) != VK_SUCCESS) return False;
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(device, texture->image, &requirements);
+
+    VkMemoryAllocateInfo allocation = { .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocation.allocationSize  = requirements.size;
+    allocation.memoryTypeIndex = vk_find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &allocation, NULL, &texture->memory) != VK_SUCCESS) return False;
+
+    return vkBindImageMemory(device, texture->image, texture->memory, 0) == VK_SUCCESS;
+}
+
+static u8 CreateView(TextureResource* texture, VkFormat format)
+{
+    VkDevice device = vk_get_device();
+
+    VkImageViewCreateInfo view = { .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+    view.image            = texture->image;
+    view.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+    view.format           = format;
+    view.subresourceRange = (VkImageSubresourceRange){ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    if (vkCreateImageView(device, &view, NULL, &texture->view) != VK_SUCCESS) return False;
+
+    VkSamplerCreateInfo sampler = { .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+    sampler.magFilter    = VK_FILTER_LINEAR;
+    sampler.minFilter    = VK_FILTER_LINEAR;
+    sampler.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    return vkCreateSampler(device, &sampler, NULL, &texture->sampler) == VK_SUCCESS;
+}
+
+/* Device local image filled through a staging copy, left in the layout fragment shaders sample from */
+static u8 CreateTexture(TextureResource* texture, const void* pixels)
+{
+    VkFormat format = texture->format == TEXTURE_FORMAT_R8 ? VK_FORMAT_R8_UNORM : VK_FORMAT_R8G8B8A8_UNORM;
+    usize    bytes  = (usize)texture->width * texture->height * (texture->format == TEXTURE_FORMAT_R8 ? 1 : 4);
+
+    if (!CreateImage(texture, format) || !CreateView(texture, format)) return False;
+
+    VkBuffer       staging       = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    if (pixels && !CreateStaging(pixels, bytes, &staging, &stagingMemory))
+        return False;
+
+    VkCommandBuffer commandBuffer = vk_begin_single_time_commands();
+    if (pixels) {
+        TransitionImage(commandBuffer, texture->image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+        VkBufferImageCopy region = {0};
+        region.imageSubresource = (VkImageSubresourceLayers){ VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+        region.imageExtent      = (VkExtent3D){ texture->width, texture->height, 1 };
+        vkCmdCopyBufferToImage(commandBuffer, staging, texture->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &region);
+
+        TransitionImage(commandBuffer, texture->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    } else {
+        TransitionImage(commandBuffer, texture->image, VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    vk_end_single_time_commands(commandBuffer);
+
+    if (pixels) {
+        vkDestroyBuffer(vk_get_device(), staging, NULL);
+        vkFreeMemory(vk_get_device(), stagingMemory, NULL);
+    }
+    return True;
+}
+
+static void DestroyTexture(TextureResource* texture)
+{
+    VkDevice device = vk_get_device();
+    if (texture->sampler) vkDestroySampler(device, texture->sampler, NULL);
+    if (texture->view)    vkDestroyImageView(device, texture->view, NULL);
+    if (texture->image)   vkDestroyImage(device, texture->image, NULL);
+    if (texture->memory)  vkFreeMemory(device, texture->memory, NULL);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace(Init)(void)
+{
+    if (resources.initialized) return True;
+
+    for (u32 type = 0; type < RESOURCE_TYPE_COUNT; type++) {
+        if (!core_HandleTableCreate(&resources.tables[type], itemSizes[type], RESOURCE_INITIAL_CAPACITY,
+                MEMORY_TAG_RENDER)) {
+            __namespace(Shutdown)();
+            return False;
+        }
+    }
+
+    #ifdef GLX_OPENGL
+        resources.directStateAccess = GLAD_GL_VERSION_4_5 || GLAD_GL_ARB_direct_state_access;
+        LOG_INFO("Resources: %s", resources.directStateAccess ? "direct state access" : "bind to edit");
+    #endif
+
+    resources.initialized = True;
+    return True;
+}
+
+void __namespace(Shutdown)(void)
+{
+    /* Meshes first, they release the buffers they own */
+    HandleTable* meshes = &resources.tables[RESOURCE_TYPE_MESH];
+    while (core_HandleCount(meshes))
+        __namespace(MeshDestroy)((MeshHandle){ core_HandleAt(meshes, core_HandleCount(meshes) - 1) });
+
+    for (u32 type = 0; type < RESOURCE_TYPE_COUNT; type++) {
+        HandleTable* table = &resources.tables[type];
+
+        if (table->count && type != RESOURCE_TYPE_SHADER)
+            LOG_WARN("Resources: %u %s(s) still alive at shutdown", table->count, typeNames[type]);
+
+        for (u32 i = 0; i < table->count; i++) {
+            if (type == RESOURCE_TYPE_BUFFER)  DestroyBuffer((BufferResource*)core_HandleItemAt(table, i));
+            if (type == RESOURCE_TYPE_TEXTURE) DestroyTexture((TextureResource*)core_HandleItemAt(table, i));
+        }
+
+        core_HandleTableDestroy(table);
+    }
+
+    resources.initialized = False;
+}
+
+const HandleTable* __namespace(GetTable)(ResourceType type)
+{
+    ASSERT(type < RESOURCE_TYPE_COUNT, "invalid resource type");
+    return &resources.tables[type];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ShaderHandle __namespace(ShaderRegister)(Shader* shader)
+{
+    ShaderHandle handle = {0};
+    if (!shader) return handle;
+
+    ShaderResource* resource;
+    handle.id = core_HandleAlloc(&resources.tables[RESOURCE_TYPE_SHADER], (void**)&resource);
+    if (handle.id) resource->shader = shader;
+    return handle;
+}
+
+Shader* __namespace(ShaderGet)(ShaderHandle handle)
+{
+    ShaderResource* resource = HANDLE_GET_TYPE(&resources.tables[RESOURCE_TYPE_SHADER], ShaderResource, handle.id);
+    return resource ? resource->shader : NULL;
+}
+
+void __namespace(ShaderRelease)(ShaderHandle handle)
+{
+    core_HandleFree(&resources.tables[RESOURCE_TYPE_SHADER], handle.id);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+BufferHandle __namespace(BufferCreate)(BufferType type, const void* data, usize size)
+{
+    BufferHandle handle = {0};
+
+    /* Both backends reject empty buffers, GL_INVALID_VALUE on glNamedBufferStorage */
+    if (!size) {
+        LOG_ERROR("Buffer create with a size of 0");
+        return handle;
+    }
+
+    BufferResource* buffer;
+    handle.id = core_HandleAlloc(&resources.tables[RESOURCE_TYPE_BUFFER], (void**)&buffer);
+    if (!handle.id) return handle;
+
+    buffer->type = type;
+    buffer->size = size;
+
+    if (!CreateBuffer(buffer, data)) {
+        LOG_ERROR("Failed to create %zu byte buffer", size);
+        DestroyBuffer(buffer);
+        core_HandleFree(&resources.tables[RESOURCE_TYPE_BUFFER], handle.id);
+        handle.id = HANDLE_NULL;
+    }
+    return handle;
+}
+
+BufferResource* __namespace(BufferGet)(BufferHandle handle)
+{
+    return HANDLE_GET_TYPE(&resources.tables[RESOURCE_TYPE_BUFFER], BufferResource, handle.id);
+}
+
+void __namespace(BufferUpdate)(BufferHandle handle, usize offset, const void* data, usize size)
+{
+    BufferResource* buffer = __namespace(BufferGet)(handle);
+    if (!buffer || !data || !size) return;
+
+    /* Streamed buffers are mapped for good by whoever rings them, mapping them again here is invalid on Vulkan */
+    if (buffer->type != BUFFER_TYPE_VERTEX && buffer->type != BUFFER_TYPE_INDEX) {
+        LOG_WARN("Buffer update of a streamed buffer, write through its persistent mapping instead");
+        return;
+    }
+
+    if (offset + size > buffer->size) {
+        LOG_WARN("Buffer update of %zu bytes at %zu past the end of a %zu byte buffer", size, offset, buffer->size);
+        return;
+    }
+    UpdateBuffer(buffer, offset, data, size);
+}
+
+void __namespace(BufferDestroy)(BufferHandle handle)
+{
+    BufferResource* buffer = __namespace(BufferGet)(handle);
+    if (!buffer) return;
+
+    DestroyBuffer(buffer);
+    core_HandleFree(&resources.tables[RESOURCE_TYPE_BUFFER], handle.id);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+MeshHandle __namespace(MeshCreate)(const MeshDesc* desc)
+{
+    MeshHandle handle = {0};
+    if (!desc) return handle;
+
+    BufferHandle vertices = __namespace(BufferCreate)(BUFFER_TYPE_VERTEX, desc->vertices,
+        (usize)desc->vertexCount * desc->layout.stride);
+    BufferHandle indices  = __namespace(BufferCreate)(BUFFER_TYPE_INDEX, desc->indices,
+        (usize)desc->indexCount * sizeof(u32));
+
+    MeshResource* mesh = NULL;
+    if (!RESOURCE_HANDLE_IS_NULL(vertices) && !RESOURCE_HANDLE_IS_NULL(indices))
+        handle.id = core_HandleAlloc(&resources.tables[RESOURCE_TYPE_MESH], (void**)&mesh);
+
+    if (mesh) {
+        mesh->vertexBuffer = vertices;
+        mesh->indexBuffer  = indices;
+        mesh->indexCount   = desc->indexCount;
+
+        if (CreateMesh(mesh, desc)) return handle;
+
+        DestroyMesh(mesh);
+        core_HandleFree(&resources.tables[RESOURCE_TYPE_MESH], handle.id);
+        handle.id = HANDLE_NULL;
+    }
+
+    LOG_ERROR("Failed to create mesh (%u vertices, %u indices)", desc->vertexCount, desc->indexCount);
+    __namespace(BufferDestroy)(vertices);
+    __namespace(BufferDestroy)(indices);
+    return handle;
+}
+
+MeshResource* __namespace(MeshGet)(MeshHandle handle)
+{
+    return HANDLE_GET_TYPE(&resources.tables[RESOURCE_TYPE_MESH], MeshResource, handle.id);
+}
+
+void __namespace(MeshDestroy)(MeshHandle handle)
+{
+    MeshResource* mesh = __namespace(MeshGet)(handle);
+    if (!mesh) return;
+
+    BufferHandle vertices = mesh->vertexBuffer;
+    BufferHandle indices  = mesh->indexBuffer;
+
+    DestroyMesh(mesh);
+    core_HandleFree(&resources.tables[RESOURCE_TYPE_MESH], handle.id);
+
+    __namespace(BufferDestroy)(vertices);
+    __namespace(BufferDestroy)(indices);
+}
+
+u8 __namespace(LayoutValidate)(const VertexLayout* layout, const Shader* shader)
+{
+    if (!layout || !shader) return False;
+
+    u8 valid = True;
+
+    for (u32 i = 0; i < shader->reflection.count; i++) {
+        const ShaderBinding* input = &shader->reflection.bindings[i];
+        if (input->kind != SHADER_BINDING_INPUT || input->location >= VERTEX_LOCATION_INSTANCE) continue;
+
+        const VertexAttribute* attribute = NULL;
+        for (u32 a = 0; a < layout->count && !attribute; a++)
+            if (layout->attributes[a].location == (u32)input->location) attribute = &layout->attributes[a];
+
+        /* Matrix inputs span several locations, only the first one is checked */
+        if (!attribute) {
+            LOG_WARN("Shader '%s': input '%s' at location %d is not in the vertex layout",
+                shader->name, core_StrIdName(input->id), input->location);
+            valid = False;
+        } else if (input->components <= 4 && attribute->components != input->components) {
+            LOG_WARN("Shader '%s': input '%s' reads %u components, the vertex layout has %u at location %d",
+                shader->name, core_StrIdName(input->id), input->components, attribute->components, input->location);
+            valid = False;
+        }
+    }
+    return valid;
+}
+
+#ifdef GLX_OPENGL
+u8 __namespace(DirectStateAccess)(void)
+{
+    return resources.directStateAccess;
+}
+
+u32 __namespace(BufferTarget)(BufferType type)
+{
+    return glBufferTargets[type];
+}
+
+void __namespace(MeshDraw)(MeshHandle handle)
+{
+    const MeshResource* mesh = __namespace(MeshGet)(handle);
+    if (!mesh) return;
+
+    /* Stays bound, the next draw of the same mesh skips the bind */
+    renderer_GlStateBindVertexArray(mesh->vao);
+    glDrawElements(GL_TRIANGLES, (GLsizei)mesh->indexCount, GL_UNSIGNED_INT, 0);
+}
+
+void __namespace(ApplyState)(const RenderStateDesc* state)
+{
+    if (!state) return;
+
+    renderer_GlStateEnable(GL_DEPTH_TEST, state->depthTest);
+    if (state->depthTest) renderer_GlStateDepthFunc(GL_LESS);
+    renderer_GlStateDepthMask(state->depthWrite);
+
+    renderer_GlStateEnable(GL_CULL_FACE, state->cullBack);
+    if (state->cullBack) {
+        renderer_GlStateCullFace(GL_BACK);
+        renderer_GlStateFrontFace(GL_CCW);
+    }
+
+    renderer_GlStateEnable(GL_BLEND, state->blend);
+    if (state->blend) renderer_GlStateBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TextureHandle __namespace(TextureCreate)(u32 width, u32 height, TextureFormat format, const void* pixels)
+{
+    TextureHandle handle = {0};
+
+    if (!width || !height) {
+        LOG_ERROR("Texture create with a size of %ux%u", width, height);
+        return handle;
+    }
+
+    TextureResource* texture;
+    handle.id = core_HandleAlloc(&resources.tables[RESOURCE_TYPE_TEXTURE], (void**)&texture);
+    if (!handle.id) return handle;
+
+    texture->width  = width;
+    texture->height = height;
+    texture->format = format;
+
+    if (!CreateTexture(texture, pixels)) {
+        LOG_ERROR("Failed to create %ux%u texture", width, height);
+        DestroyTexture(texture);
+        core_HandleFree(&resources.tables[RESOURCE_TYPE_TEXTURE], handle.id);
+        handle.id = HANDLE_NULL;
+    }
+    return handle;
+}
+
+TextureResource* __namespace(TextureGet)(TextureHandle handle)
+{
+    return HANDLE_GET_TYPE(&resources.tables[RESOURCE_TYPE_TEXTURE], TextureResource, handle.id);
+}
+
+void __namespace(TextureDestroy)(TextureHandle handle)
+{
+    TextureResource* texture = __namespace(TextureGet)(handle);
+    if (!texture) return;
+
+    DestroyTexture(texture);
+    core_HandleFree(&resources.tables[RESOURCE_TYPE_TEXTURE], handle.id);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,185 @@
+#ifndef __resource_h__
+#define __resource_h__
+
+#include <core/types.h>
+#include <core/handle.h>
+#include <render/shader.h>
+
+#ifdef GLX_VULKAN
+    #include <vulkan/vulkan.h>
+#endif
+
+#define __namespace( func_name ) renderer##_##Resource##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Distinct structs so a mesh handle can not be passed where a buffer is expected */
+typedef struct { Handle id; } ShaderHandle;
+typedef struct { Handle id; } BufferHandle;
+typedef struct { Handle id; } MeshHandle;
+typedef struct { Handle id; } TextureHandle;
+
+#define RESOURCE_HANDLE_IS_NULL( handle ) ( ( handle ).id == HANDLE_NULL )
+
+typedef enum
+{
+    RESOURCE_TYPE_SHADER = 0,
+    RESOURCE_TYPE_BUFFER,
+    RESOURCE_TYPE_MESH,
+    RESOURCE_TYPE_TEXTURE,
+    RESOURCE_TYPE_COUNT
+} ResourceType;
+
+typedef enum
+{
+    BUFFER_TYPE_VERTEX = 0,
+    BUFFER_TYPE_INDEX,
+    BUFFER_TYPE_UNIFORM,
+    BUFFER_TYPE_INSTANCE,   /* per-instance vertex data streamed every frame */
+    BUFFER_TYPE_INDIRECT,   /* draw commands read by the GPU */
+    BUFFER_TYPE_STORAGE,    /* shader storage, per-draw data indexed in the shader */
+} BufferType;
+
+typedef enum
+{
+    TEXTURE_FORMAT_RGBA8 = 0,
+    TEXTURE_FORMAT_R8,
+} TextureFormat;
+
+#define VERTEX_LAYOUT_MAX_ATTRIBUTES 8
+
+/* Locations from here on are fed per instance by render/instance.c, mesh layouts stay below */
+#define VERTEX_LOCATION_INSTANCE     8
+
+typedef struct
+{
+    u32 location;
+    u32 components;     /* float components, 1 to 4 */
+    u32 offset;
+} VertexAttribute;
+
+typedef struct
+{
+    VertexAttribute attributes[VERTEX_LAYOUT_MAX_ATTRIBUTES];
+    u32             count;
+    u32             stride;
+} VertexLayout;
+
+/* Fixed function state a draw is issued with, part of what the driver specialises a program for */
+typedef struct
+{
+    u8 depthTest;
+    u8 depthWrite;
+    u8 cullBack;
+    u8 blend;           /* premultiplied alpha */
+} RenderStateDesc;
+
+#define RENDER_STATE_OPAQUE ( (RenderStateDesc){ .depthTest = True, .depthWrite = True, .cullBack = True } )
+
+typedef struct
+{
+    const void*  vertices;
+    u32          vertexCount;
+    const u32*   indices;
+    u32          indexCount;
+    VertexLayout layout;
+} MeshDesc;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    Shader* shader;     /* owned by the shader library, the table only references it */
+} ShaderResource;
+
+typedef struct
+{
+    BufferType type;
+    usize      size;
+
+    #ifdef GLX_OPENGL
+    u32            glName;
+    #elif defined(GLX_VULKAN)
+    VkBuffer       buffer;
+    VkDeviceMemory memory;
+    #endif
+} BufferResource;
+
+typedef struct
+{
+    BufferHandle vertexBuffer;
+    BufferHandle indexBuffer;
+    u32          indexCount;
+
+    #ifdef GLX_OPENGL
+    u32          vao;
+    u8           instanced;     /* instance attributes set up on the vao */
+    #endif
+} MeshResource;
+
+typedef struct
+{
+    u32           width;
+    u32           height;
+    TextureFormat format;
+
+    #ifdef GLX_OPENGL
+    u32            glName;
+    #elif defined(GLX_VULKAN)
+    VkImage        image;
+    VkDeviceMemory memory;
+    VkImageView    view;
+    VkSampler      sampler;       /* linear, clamped, the same state the GL path sets */
+    #endif
+} TextureResource;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8                 __namespace( Init )     ( void );
+void               __namespace( Shutdown ) ( void );
+
+/* Dense table for linear iteration, items move when a resource is destroyed */
+const HandleTable* __namespace( GetTable ) ( ResourceType type );
+
+ShaderHandle       __namespace( ShaderRegister ) ( Shader* shader );
+Shader*            __namespace( ShaderGet )      ( ShaderHandle handle );
+void               __namespace( ShaderRelease )  ( ShaderHandle handle );
+
+BufferHandle       __namespace( BufferCreate )   ( BufferType type, const void* data, usize size );
+BufferResource*    __namespace( BufferGet )      ( BufferHandle handle );
+
+/* Writes into a vertex or index buffer, typically one created without data. Not for ranges the GPU may still be
+ * reading. Streamed buffers are written through the mapping of the module that rings them and are refused here */
+void               __namespace( BufferUpdate )   ( BufferHandle handle, usize offset, const void* data, usize size );
+void               __namespace( BufferDestroy )  ( BufferHandle handle );
+
+/* The mesh owns the vertex and index buffers it creates */
+MeshHandle         __namespace( MeshCreate )     ( const MeshDesc* desc );
+MeshResource*      __namespace( MeshGet )        ( MeshHandle handle );
+void               __namespace( MeshDestroy )    ( MeshHandle handle );
+
+/* Every vertex input below VERTEX_LOCATION_INSTANCE has an attribute at its location with as many components */
+u8                 __namespace( LayoutValidate ) ( const VertexLayout* layout, const Shader* shader );
+
+#ifdef GLX_OPENGL
+/* GL 4.5 or ARB_direct_state_access, buffers then have immutable storage and are written by name */
+u8                 __namespace( DirectStateAccess ) ( void );
+
+/* The bind target of a buffer type, for code that binds before writing */
+u32                __namespace( BufferTarget )   ( BufferType type );
+
+void               __namespace( MeshDraw )       ( MeshHandle handle );
+void               __namespace( ApplyState )     ( const RenderStateDesc* state );
+#endif
+
+TextureHandle      __namespace( TextureCreate )  ( u32 width, u32 height, TextureFormat format, const void* pixels );
+TextureResource*   __namespace( TextureGet )     ( TextureHandle handle );
+void               __namespace( TextureDestroy ) ( TextureHandle handle );
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __resource_h__ */
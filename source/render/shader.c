@@ -3,203 +3,631 @@
 
 #include <glad/glad.h>
 #include <core/debug.h>
+#include <core/memory.h>
+#include <core/pool.h>
+#include <render/ubo.h>
+#include <render/shader_cache.h>
+#include <render/shader_source.h>
+#include <render/gl_state.h>
+#ifdef GLX_VULKAN
+    #include <platform/glx/vulkan/helpers.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define __namespace(func_name) renderer_Shader##func_name
 
+#define SHADER_POOL_SLAB        32
+#define SHADER_LIBRARY_CAPACITY 16
+
+/* Shaders come from a pool, released once the last one is gone */
+static struct {
+    Pool shaders;
+    u8   initialized;
+} shaderPools = {0};
+
+static struct {
+    Shader* fallback;       /* bound in place of programs that are still compiling or failed */
+    u8      parallel;
+    u8      probed;
+} compiler = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static u8 AcquirePools(void)
+{
+    if (shaderPools.initialized) return True;
+
+    if (!POOL_CREATE_TYPE(&shaderPools.shaders, Shader, SHADER_POOL_SLAB, MEMORY_TAG_SHADER, POOL_FLAG_NONE))
+        return False;
+
+    shaderPools.initialized = True;
+    return True;
+}
+
+static void ReleasePoolsIfEmpty(void)
+{
+    if (!shaderPools.initialized) return;
+    if (core_PoolLiveCount(&shaderPools.shaders)) return;
+
+    core_PoolDestroy(&shaderPools.shaders);
+    shaderPools.initialized = False;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static u32 CompileShader(const char* source, u32 type)
+/* Asks the driver for its own compile threads, after this a status query no longer blocks on finished work */
+static void ProbeParallelCompile(void)
 {
-    u32 shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
+    if (compiler.probed) return;
+    compiler.probed = True;
+
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        compiler.parallel = True;
+    } else if (GLAD_GL_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+        compiler.parallel = True;
+    }
 
+    LOG_INFO("Shader compile: %s", compiler.parallel ? "parallel" : "serial, async programs finish on first poll");
+}
+
+static u32 SubmitStage(const char* source, u32 type)
+{
+    u32 stage = glCreateShader(type);
+    glShaderSource(stage, 1, &source, NULL);
+    glCompileShader(stage);
+    return stage;
+}
+
+static u8 CheckStage(u32 stage, u32 type)
+{
     i32 success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(stage, GL_COMPILE_STATUS, &success);
     if (!success) {
         char infoLog[512];
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        glGetShaderInfoLog(stage, 512, NULL, infoLog);
         printf("ERROR::SHADER::%s::COMPILATION_FAILED\n%s\n",
             (type == GL_VERTEX_SHADER) ? "VERTEX" : "FRAGMENT", infoLog);
-        glDeleteShader(shader);
-        return 0;
     }
-    return shader;
+    return success != 0;
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void ReleaseStages(u32 stages[2])
+{
+    for (u32 i = 0; i < 2; i++) {
+        if (stages[i]) glDeleteShader(stages[i]);
+        stages[i] = 0;
+    }
+}
 
-static u32 CreateProgram(u32 vertex, u32 fragment)
+/* Compile and link are only queued here, nothing reads a status until the program is finished */
+static u32 SubmitProgram(u32 stages[2], const char* vertexSrc, const char* fragmentSrc)
 {
+    ProbeParallelCompile();
+
+    stages[0] = SubmitStage(vertexSrc, GL_VERTEX_SHADER);
+    stages[1] = SubmitStage(fragmentSrc, GL_FRAGMENT_SHADER);
+
     u32 program = glCreateProgram();
-    glAttachShader(program, vertex);
-    glAttachShader(program, fragment);
+    glAttachShader(program, stages[0]);
+    glAttachShader(program, stages[1]);
+    if (renderer_ShaderCacheEnabled())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
 
-    i32 success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) 
-    {
-        char infoLog[512];
-        glGetProgramInfoLog(program, 512, NULL, infoLog);
-        printf("ERROR::SHADER::PROGRAM::LINKING_FAILED\n%s\n", infoLog);
-        glDeleteProgram(program);
-        return 0;
+    return program;
+}
+
+static u8 IsComplete(u32 program)
+{
+    if (!compiler.parallel) return True;
+
+    i32 complete = 0;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete != 0;
+}
+
+/* First status query of a submitted program, blocks only if the driver is not done with it yet */
+static u8 CheckProgram(const char* name, u32 stages[2], u32 program)
+{
+    u8 compiled = CheckStage(stages[0], GL_VERTEX_SHADER);
+    compiled    = CheckStage(stages[1], GL_FRAGMENT_SHADER) && compiled;
+
+    i32 linked = 0;
+    if (compiled) {
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            char infoLog[512];
+            glGetProgramInfoLog(program, 512, NULL, infoLog);
+            printf("ERROR::SHADER::PROGRAM::LINKING_FAILED\n%s\n", infoLog);
+        }
     }
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    return program;
+    ReleaseStages(stages);
+
+    if (!linked) LOG_ERROR("Shader '%s' failed to build", name);
+    return linked != 0;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static i32 GetUniformLocation( u32 program, const char* name )
+static u32 UniformTypeSize(u32 type)
 {
-    i32 loc = glGetUniformLocation(program, name);
-    //if ( loc == -1 )
-    //{
-    //    LOG_WARN( "Warning: uniform '%s' not found in shader\n", name );
-    //}
-    return loc;
+    switch (type) {
+        case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+        case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE: case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_SHADOW:
+            return 4;
+        case GL_FLOAT_VEC2: case GL_INT_VEC2: return 8;
+        case GL_FLOAT_VEC3: case GL_INT_VEC3: return 12;
+        case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_FLOAT_MAT2: return 16;
+        case GL_FLOAT_MAT3: return 36;
+        case GL_FLOAT_MAT4: return 64;
+        default: return 0;
+    }
+}
+
+/* Built from the reflection at link, setters never ask the driver for a location again */
+static u8 BuildUniforms(Shader* shader)
+{
+    const ShaderReflection* reflection = &shader->reflection;
+
+    u32 active = 0;
+    for (u32 i = 0; i < reflection->count; i++)
+        active += reflection->bindings[i].location >= 0 && reflection->bindings[i].kind != SHADER_BINDING_INPUT;
+
+    Allocator allocator = core_AllocatorHeap(MEMORY_TAG_SHADER);
+    if (!HASHMAP_INIT_TYPE(&shader->uniformTable, u32, active, &allocator))
+        return False;
+
+    if (!active) return True;
+
+    shader->uniformList = (ShaderUniform*)core_MemoryCalloc(active, sizeof(ShaderUniform), MEMORY_TAG_SHADER);
+    if (!shader->uniformList) return False;
+
+    u32 shadowBytes = 0;
+
+    for (u32 i = 0; i < reflection->count; i++) {
+        const ShaderBinding* binding = &reflection->bindings[i];
+        if (binding->location < 0 || binding->kind == SHADER_BINDING_INPUT) continue;
+
+        ShaderUniform* uniform = &shader->uniformList[shader->uniformCount];
+        uniform->id       = binding->id;
+        uniform->location = binding->location;
+        uniform->type     = binding->type;
+        uniform->count    = (i32)binding->count;
+        uniform->bytes    = UniformTypeSize(binding->type) * binding->count;
+        uniform->offset   = shadowBytes;
+        shadowBytes      += (uniform->bytes + 15u) & ~15u;
+
+        u32* index = (u32*)core_HashMapInsert(&shader->uniformTable, uniform->id, NULL);
+        if (index) *index = shader->uniformCount;
+        shader->uniformCount++;
+    }
+
+    if (shadowBytes) {
+        shader->shadow = (u8*)core_MemoryAlloc(shadowBytes, MEMORY_TAG_SHADER);
+        if (!shader->shadow) return False;
+    }
+    return True;
+}
+
+static void ReleaseUniforms(Shader* shader)
+{
+    renderer_ShaderReflectFree(&shader->reflection);
+    core_HashMapFree(&shader->uniformTable);
+    core_MemoryFree(shader->uniformList);
+    core_MemoryFree(shader->shadow);
+    shader->uniformList  = NULL;
+    shader->uniformCount = 0;
+    shader->shadow       = NULL;
+}
+
+/* Returns the location to upload to, or -1 when the program already has this value */
+static i32 ShadowUpdate(Shader* shader, UniformHandle handle, const void* value, u32 bytes)
+{
+    if (!shader || !UNIFORM_HANDLE_IS_VALID(handle) || (u32)handle.index >= shader->uniformCount) return -1;
+
+    ShaderUniform* uniform = &shader->uniformList[handle.index];
+
+    /* Unknown types or a setter that does not match the declared type always go through */
+    if (uniform->bytes != bytes) return uniform->location;
+
+    u8* shadow = shader->shadow + uniform->offset;
+    if (uniform->cached && memcmp(shadow, value, bytes) == 0) return -1;
+
+    memcpy(shadow, value, bytes);
+    uniform->cached = True;
+    return uniform->location;
+}
+
+static inline UniformHandle UniformByName(Shader* shader, const char* name)
+{
+    if (!shader || !name) return UNIFORM_HANDLE_INVALID;
+    return __namespace(GetUniform)(shader, core_StrIdHash(name, strlen(name)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-Shader* __namespace(Create)(const char* name, const char* vertexSrc, const char* fragmentSrc)
+/* Shared by the source and the cache path once the program is linked */
+static u8 SetupProgram(Shader* shader)
 {
-    u32 vertex = CompileShader(vertexSrc, GL_VERTEX_SHADER);
-    if (!vertex) return NULL;
+    /* Programs only exist on GL, Vulkan shaders are reflected from their modules in LoadModules */
+    #ifdef GLX_OPENGL
+    renderer_UboBindProgramBlocks(shader->programID);
+    u8 reflected = renderer_ShaderReflectProgram(shader->programID, &shader->reflection);
+    #else
+    u8 reflected = False;
+    #endif
+
+    if (!reflected || !BuildUniforms(shader)) {
+        LOG_ERROR("Shader '%s': failed to build the uniform table", shader->name);
+        shader->status = SHADER_STATUS_FAILED;
+        return False;
+    }
 
-    u32 fragment = CompileShader(fragmentSrc, GL_FRAGMENT_SHADER);
-    if (!fragment) {
-        glDeleteShader(vertex);
-        return NULL;
+    shader->status = SHADER_STATUS_READY;
+    return True;
+}
+
+static u8 FinishProgram(Shader* shader)
+{
+    if (!CheckProgram(shader->name, shader->stages, shader->programID)) {
+        glDeleteProgram(shader->programID);
+        shader->programID = 0;
+        shader->status    = SHADER_STATUS_FAILED;
+        return False;
     }
 
-    u32 program = CreateProgram(vertex, fragment);
-    if (!program) return NULL;
+    renderer_ShaderCacheStore(shader->cacheKey, shader->programID);
+    return SetupProgram(shader);
+}
+
+/* The old program is only released once its replacement is known to be good */
+static u8 SwapProgram(Shader* shader, u32 program, u64 cacheKey)
+{
+    if (shader->programID) glDeleteProgram(shader->programID);
+    ReleaseUniforms(shader);
 
-    Shader* shader = (Shader*)malloc(sizeof(Shader));
     shader->programID = program;
+    shader->cacheKey  = cacheKey;
+    return SetupProgram(shader);
+}
+
+static void DiscardReload(Shader* shader)
+{
+    if (shader->reload.program) glDeleteProgram(shader->reload.program);
+    ReleaseStages(shader->reload.stages);
+    shader->reload.program = 0;
+}
+
+static u8 FinishReload(Shader* shader)
+{
+    u32 program = shader->reload.program;
+    u64 key     = shader->reload.cacheKey;
+    shader->reload.program = 0;
+
+    if (!CheckProgram(shader->name, shader->reload.stages, program)) {
+        glDeleteProgram(program);
+        LOG_WARN("Shader '%s': reload failed, keeping the previous program", shader->name);
+        return False;
+    }
+
+    renderer_ShaderCacheStore(key, program);
+    if (!SwapProgram(shader, program, key)) return False;
+
+    LOG_INFO("Shader '%s' reloaded", shader->name);
+    return True;
+}
+
+Shader* __namespace(CreateAsync)(const char* name, const char* vertexSrc, const char* fragmentSrc)
+{
+    Shader* shader = AcquirePools() ? POOL_ALLOC_ZERO_TYPE(&shaderPools.shaders, Shader) : NULL;
+    if (!shader) return NULL;
+
     shader->name = name;
+    shader->id = core_StrIdIntern(name);
 
-    // Cache common uniforms
-    shader->uniforms.mvp          = GetUniformLocation(program, "uMVP");
-    shader->uniforms.model        = GetUniformLocation(program, "uModel");
-    shader->uniforms.view         = GetUniformLocation(program, "uView");
-    shader->uniforms.projection   = GetUniformLocation(program, "uProjection");
-    shader->uniforms.normalMatrix = GetUniformLocation(program, "uNormalMatrix");
-    shader->uniforms.color        = GetUniformLocation(program, "uColor");
-    shader->uniforms.texture0     = GetUniformLocation(program, "uTexture0");
-    shader->uniforms.cameraPos    = GetUniformLocation(program, "uCameraPos");
+    /* A cached binary skips compile and link, a stale one falls through to the source path */
+    shader->cacheKey  = renderer_ShaderCacheKey(vertexSrc, fragmentSrc, NULL);
+    shader->programID = renderer_ShaderCacheLoad(shader->cacheKey);
+
+    if (shader->programID) {
+        SetupProgram(shader);
+    } else {
+        shader->programID = SubmitProgram(shader->stages, vertexSrc, fragmentSrc);
+        shader->status    = SHADER_STATUS_PENDING;
+    }
 
     return shader;
 }
 
+Shader* __namespace(Create)(const char* name, const char* vertexSrc, const char* fragmentSrc)
+{
+    Shader* shader = __namespace(CreateAsync)(name, vertexSrc, fragmentSrc);
+    if (!shader) return NULL;
+
+    if (shader->status == SHADER_STATUS_PENDING)
+        FinishProgram(shader);
+
+    if (shader->status != SHADER_STATUS_READY) {
+        __namespace(Destroy)(shader);
+        return NULL;
+    }
+    return shader;
+}
+
+ShaderStatus __namespace(Poll)(Shader* shader)
+{
+    if (!shader) return SHADER_STATUS_FAILED;
+
+    if (shader->status == SHADER_STATUS_PENDING && IsComplete(shader->programID))
+        FinishProgram(shader);
+
+    if (shader->reload.program && IsComplete(shader->reload.program))
+        FinishReload(shader);
+
+    return shader->status;
+}
+
+u8 __namespace(Reload)(Shader* shader, const char* vertexSrc, const char* fragmentSrc)
+{
+    if (!shader || !vertexSrc || !fragmentSrc) return False;
+
+    /* A newer edit supersedes a reload that is still compiling */
+    DiscardReload(shader);
+
+    /* Nothing usable is drawing yet, the replacement becomes the first build */
+    if (shader->status == SHADER_STATUS_PENDING) {
+        glDeleteProgram(shader->programID);
+        ReleaseStages(shader->stages);
+        shader->programID = 0;
+        shader->status    = SHADER_STATUS_FAILED;
+    }
+
+    u64 key    = renderer_ShaderCacheKey(vertexSrc, fragmentSrc, NULL);
+    u32 cached = renderer_ShaderCacheLoad(key);
+    if (cached) return SwapProgram(shader, cached, key);
+
+    shader->reload.program  = SubmitProgram(shader->reload.stages, vertexSrc, fragmentSrc);
+    shader->reload.cacheKey = key;
+    return True;
+}
+
+u8 __namespace(ReloadFromFile)(Shader* shader)
+{
+    if (!shader || !shader->sourcePaths[0] || !shader->sourcePaths[1]) return False;
+
+    char* vertexSrc   = renderer_ShaderSourceLoad(shader->sourcePaths[0]);
+    char* fragmentSrc = vertexSrc ? renderer_ShaderSourceLoad(shader->sourcePaths[1]) : NULL;
+
+    u8 submitted = vertexSrc && fragmentSrc && __namespace(Reload)(shader, vertexSrc, fragmentSrc);
+
+    core_MemoryFree(vertexSrc);
+    core_MemoryFree(fragmentSrc);
+    return submitted;
+}
+
+u8 __namespace(UsesFile)(const Shader* shader, const char* path)
+{
+    if (!shader || !path) return False;
+
+    for (u32 i = 0; i < 2; i++)
+        if (shader->sourcePaths[i] && renderer_ShaderSourceDependsOn(shader->sourcePaths[i], path)) return True;
+    return False;
+}
+
+void __namespace(SetFallback)(Shader* shader)
+{
+    compiler.fallback = shader;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-Shader* __namespace(LoadFromFile)(const char* name, const char* vertPath, const char* fragPath)
+char* __namespace(ReadSource)(const char* path)
+{
+    return renderer_ShaderSourceRead(path);
+}
+
+typedef Shader* (*ShaderCreateFn)(const char* name, const char* vertexSrc, const char* fragmentSrc);
+
+static char* CopyPath(const char* path)
+{
+    usize length = strlen(path);
+    char* copy = (char*)core_MemoryAlloc(length + 1, MEMORY_TAG_SHADER);
+    if (copy) memcpy(copy, path, length + 1);
+    return copy;
+}
+
+static Shader* LoadFiles(const char* name, const char* vertPath, const char* fragPath, ShaderCreateFn create)
 {
-    FILE* f;
-    char* buffer = NULL;
-    long length;
-
-    // Load vertex
-    f = fopen(vertPath, "rb");
-    if (!f) { printf("Failed to open vertex shader: %s\n", vertPath); return NULL; }
-    fseek(f, 0, SEEK_END);
-    length = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    buffer = (char*)malloc(length + 1);
-    fread(buffer, 1, length, f);
-    buffer[length] = '\0';
-    fclose(f);
-    const char* vertexSrc = buffer;
-
-    // Load fragment
-    f = fopen(fragPath, "rb");
-    if (!f) { printf("Failed to open fragment shader: %s\n", fragPath); free(buffer); return NULL; }
-    fseek(f, 0, SEEK_END);
-    length = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    char* fragBuffer = (char*)malloc(length + 1);
-    fread(fragBuffer, 1, length, f);
-    fragBuffer[length] = '\0';
-    fclose(f);
-    const char* fragmentSrc = fragBuffer;
-
-    Shader* shader = __namespace(Create)(name, vertexSrc, fragmentSrc);
-
-    free(buffer);
-    free(fragBuffer);
+    char* vertexSrc = renderer_ShaderSourceLoad(vertPath);
+    if (!vertexSrc) return NULL;
+
+    char* fragmentSrc = renderer_ShaderSourceLoad(fragPath);
+    if (!fragmentSrc) {
+        core_MemoryFree(vertexSrc);
+        return NULL;
+    }
+
+    Shader* shader = create(name, vertexSrc, fragmentSrc);
+
+    /* Kept so the shader can be rebuilt when one of its files changes */
+    if (shader) {
+        shader->sourcePaths[0] = CopyPath(vertPath);
+        shader->sourcePaths[1] = CopyPath(fragPath);
+    }
+
+    core_MemoryFree(vertexSrc);
+    core_MemoryFree(fragmentSrc);
     return shader;
 }
 
+#ifdef GLX_VULKAN
+/* Each stage is reflected into the same table, the vertex one adds the inputs */
+static u8 LoadModule(Shader* shader, u32 stage, const char* path)
+{
+    usize length = 0;
+    u32*  words  = (u32*)renderer_ShaderSourceReadBinary(path, &length);
+    if (!words) return False;
+
+    VkShaderModuleCreateInfo info = { .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+    info.codeSize = length;
+    info.pCode    = words;
+
+    u8 loaded = length % sizeof(u32) == 0 &&
+        renderer_ShaderReflectSpirv(words, length / sizeof(u32), &shader->reflection) &&
+        vkCreateShaderModule(vk_get_device(), &info, NULL, &shader->modules[stage]) == VK_SUCCESS;
+
+    core_MemoryFree(words);
+    return loaded;
+}
+
+/* Vulkan takes SPIR-V built from the GLSL, the modules are ready as soon as they are created */
+static Shader* LoadModules(const char* name, const char* vertPath, const char* fragPath)
+{
+    Shader* shader = AcquirePools() ? POOL_ALLOC_ZERO_TYPE(&shaderPools.shaders, Shader) : NULL;
+    if (!shader) return NULL;
+
+    shader->name = name;
+    shader->id   = core_StrIdIntern(name);
+
+    if (!LoadModule(shader, 0, vertPath) || !LoadModule(shader, 1, fragPath) || !BuildUniforms(shader)) {
+        LOG_ERROR("Shader '%s': can not load SPIR-V from '%s' and '%s'", name, vertPath, fragPath);
+        __namespace(Destroy)(shader);
+        return NULL;
+    }
+
+    shader->sourcePaths[0] = CopyPath(vertPath);
+    shader->sourcePaths[1] = CopyPath(fragPath);
+    return shader;
+}
+#endif
+
+Shader* __namespace(LoadFromFile)(const char* name, const char* vertPath, const char* fragPath)
+{
+    #ifdef GLX_VULKAN
+    return LoadModules(name, vertPath, fragPath);
+    #else
+    return LoadFiles(name, vertPath, fragPath, __namespace(Create));
+    #endif
+}
+
+/* The sources are handed to GL before this returns, only the compile itself is deferred */
+Shader* __namespace(LoadFromFileAsync)(const char* name, const char* vertPath, const char* fragPath)
+{
+    return LoadFiles(name, vertPath, fragPath, __namespace(CreateAsync));
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void __namespace(Bind)(Shader* shader)
+Shader* __namespace(Bind)(Shader* shader)
 {
+    if (shader && shader->status == SHADER_STATUS_PENDING)
+        __namespace(Poll)(shader);
+
+    if (!shader || shader->status != SHADER_STATUS_READY)
+        shader = compiler.fallback;
+
+    #ifdef GLX_OPENGL
     if (shader && shader->programID)
-        glUseProgram(shader->programID);
+        renderer_GlStateUseProgram(shader->programID);
+    #endif
+    return shader;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void __namespace(Ubind)(void)
 {
-    glUseProgram(0);
+    #ifdef GLX_OPENGL
+    renderer_GlStateUseProgram(0);
+    #endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void __namespace(SetInt)(Shader* shader, const char* name, i32 value)
+UniformHandle __namespace(GetUniform)(Shader* shader, StringId id)
 {
-    if (shader && shader->programID)
-        glUniform1i(GetUniformLocation(shader->programID, name), value);
+    if (!shader) return UNIFORM_HANDLE_INVALID;
+
+    const u32* index = HASHMAP_GET_TYPE(&shader->uniformTable, u32, id);
+    return index ? (UniformHandle){ (i32)*index } : UNIFORM_HANDLE_INVALID;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void __namespace(SetFloat)(Shader* shader, const char* name, f32 value)
+void __namespace(SetUniformInt)(Shader* shader, UniformHandle handle, i32 value)
 {
-    if (shader && shader->programID)
-        glUniform1f(GetUniformLocation(shader->programID, name), value);
+    i32 location = ShadowUpdate(shader, handle, &value, sizeof(value));
+    if (location >= 0) glUniform1i(location, value);
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void __namespace(SetUniformFloat)(Shader* shader, UniformHandle handle, f32 value)
+{
+    i32 location = ShadowUpdate(shader, handle, &value, sizeof(value));
+    if (location >= 0) glUniform1f(location, value);
+}
 
-void __namespace(SetVec2)(Shader* shader, const char* name, Vec2 value)
+void __namespace(SetUniformVec2)(Shader* shader, UniformHandle handle, Vec2 value)
 {
-    if (shader && shader->programID)
-        glUniform2f(GetUniformLocation(shader->programID, name), value.x, value.y);
+    i32 location = ShadowUpdate(shader, handle, &value, sizeof(value));
+    if (location >= 0) glUniform2f(location, value.x, value.y);
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void __namespace(SetUniformVec3)(Shader* shader, UniformHandle handle, Vec3 value)
+{
+    i32 location = ShadowUpdate(shader, handle, &value, sizeof(value));
+    if (location >= 0) glUniform3f(location, value.x, value.y, value.z);
+}
 
-void __namespace(SetVec3)(Shader* shader, const char* name, Vec3 value)
+void __namespace(SetUniformVec4)(Shader* shader, UniformHandle handle, Vec4 value)
 {
-    if (shader && shader->programID)
-        glUniform3f(GetUniformLocation(shader->programID, name), value.x, value.y, value.z);
+    i32 location = ShadowUpdate(shader, handle, &value, sizeof(value));
+    if (location >= 0) glUniform4f(location, value.x, value.y, value.z, value.w);
+}
+
+void __namespace(SetUniformMat4)(Shader* shader, UniformHandle handle, const Mat4* value)
+{
+    i32 location = ShadowUpdate(shader, handle, value->m, sizeof(value->m));
+    if (location >= 0) glUniformMatrix4fv(location, 1, GL_FALSE, value->m);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void __namespace(SetVec4)(Shader* shader, const char* name, Vec4 value)
+/* Name setters hash the name and go through the uniform table, prefer resolving a handle once */
+
+void __namespace(SetInt)(Shader* shader, const char* name, i32 value)
 {
-    if (shader && shader->programID)
-        glUniform4f(GetUniformLocation(shader->programID, name), value.x, value.y, value.z, value.w);
+    __namespace(SetUniformInt)(shader, UniformByName(shader, name), value);
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void __namespace(SetFloat)(Shader* shader, const char* name, f32 value)
+{
+    __namespace(SetUniformFloat)(shader, UniformByName(shader, name), value);
+}
+
+void __namespace(SetVec2)(Shader* shader, const char* name, Vec2 value)
+{
+    __namespace(SetUniformVec2)(shader, UniformByName(shader, name), value);
+}
+
+void __namespace(SetVec3)(Shader* shader, const char* name, Vec3 value)
+{
+    __namespace(SetUniformVec3)(shader, UniformByName(shader, name), value);
+}
+
+void __namespace(SetVec4)(Shader* shader, const char* name, Vec4 value)
+{
+    __namespace(SetUniformVec4)(shader, UniformByName(shader, name), value);
+}
 
 void __namespace(SetMat4)(Shader* shader, const char* name, const Mat4* value)
 {
-    if (shader && shader->programID)
-        glUniformMatrix4fv(GetUniformLocation(shader->programID, name), 1, GL_FALSE, value->m);
+    __namespace(SetUniformMat4)(shader, UniformByName(shader, name), value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -218,8 +646,7 @@ void __namespace(SetMvp)(Shader* shader, const Mat4* model, const Mat4* view, co
     Mat4 viewProj = core_MathMat4Multiply(*proj, *view);
     Mat4 mvp = core_MathMat4Multiply(viewProj, *model);
 
-    if (shader->uniforms.mvp != -1)
-        glUniformMatrix4fv(shader->uniforms.mvp, 1, GL_FALSE, mvp.m);
+    __namespace(SetUniformMat4)(shader, __namespace(GetUniform)(shader, SID("uMVP")), &mvp);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -228,20 +655,18 @@ void __namespace(SetMatrices)(Shader* shader, const Mat4* model, const Mat4* vie
 {
     if (!shader || !shader->programID) return;
 
-    if (shader->uniforms.model != -1)
-        glUniformMatrix4fv(shader->uniforms.model, 1, GL_FALSE, model->m);
-    if (shader->uniforms.view != -1)
-        glUniformMatrix4fv(shader->uniforms.view, 1, GL_FALSE, view->m);
-    if (shader->uniforms.projection != -1)
-        glUniformMatrix4fv(shader->uniforms.projection, 1, GL_FALSE, proj->m);
+    __namespace(SetUniformMat4)(shader, __namespace(GetUniform)(shader, SID("uModel")), model);
+    __namespace(SetUniformMat4)(shader, __namespace(GetUniform)(shader, SID("uView")), view);
+    __namespace(SetUniformMat4)(shader, __namespace(GetUniform)(shader, SID("uProjection")), proj);
 
     // Normal matrix (inverse transpose of model)
-    if (shader->uniforms.normalMatrix != -1) {
+    UniformHandle normalMatrix = __namespace(GetUniform)(shader, SID("uNormalMatrix"));
+    if (UNIFORM_HANDLE_IS_VALID(normalMatrix)) {
         // Simplified: assume model is rigid (no non-uniform scale)
         Mat4 normal = *model;
         normal.m[12] = normal.m[13] = normal.m[14] = 0;
         // In real engine, compute inverse transpose
-        glUniformMatrix4fv(shader->uniforms.normalMatrix, 1, GL_FALSE, normal.m);
+        __namespace(SetUniformMat4)(shader, normalMatrix, &normal);
     }
 }
 
@@ -252,63 +677,146 @@ void __namespace(Destroy)(Shader* shader)
     if (shader) {
         if (shader->programID)
             glDeleteProgram(shader->programID);
-        free(shader);
+        #ifdef GLX_VULKAN
+        for (u32 i = 0; i < 2; i++)
+            if (shader->modules[i]) vkDestroyShaderModule(vk_get_device(), shader->modules[i], NULL);
+        #endif
+        ReleaseStages(shader->stages);
+        DiscardReload(shader);
+        ReleaseUniforms(shader);
+        core_MemoryFree(shader->sourcePaths[0]);
+        core_MemoryFree(shader->sourcePaths[1]);
+        if (compiler.fallback == shader)
+            compiler.fallback = NULL;
+        core_PoolFree(&shaderPools.shaders, shader);
+        ReleasePoolsIfEmpty();
     }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-typedef struct ShaderNode {
-    Shader* shader;
-    struct ShaderNode* next;
-} ShaderNode;
-
+/* Lookup goes through the table, iteration and polling walk the dense array in insertion order */
 struct ShaderLibrary {
-    ShaderNode* head;
+    HashMap  table;         /* StringId -> u32 index into shaders */
+    Shader** shaders;
+    u32      count;
+    u32      capacity;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 ShaderLibrary* __namespace(LibraryCreate)(void)
 {
-    ShaderLibrary* lib = (ShaderLibrary*)malloc(sizeof(ShaderLibrary));
-    lib->head = NULL;
+    ShaderLibrary* lib = (ShaderLibrary*)core_MemoryCalloc(1, sizeof(ShaderLibrary), MEMORY_TAG_SHADER);
+    if (!lib) return NULL;
+
+    Allocator allocator = core_AllocatorHeap(MEMORY_TAG_SHADER);
+    if (!HASHMAP_INIT_TYPE(&lib->table, u32, SHADER_LIBRARY_CAPACITY, &allocator)) {
+        core_MemoryFree(lib);
+        return NULL;
+    }
     return lib;
 }
 
-void __namespace(LibraryAdd)(ShaderLibrary* lib, Shader* shader)
+Shader* __namespace(LibraryAdd)(ShaderLibrary* lib, Shader* shader)
 {
-    if (!lib || !shader) return;
+    if (!lib || !shader) return NULL;
+
+    u8   inserted;
+    u32* index = (u32*)core_HashMapInsert(&lib->table, shader->id, &inserted);
+    if (!index) return NULL;
+
+    /*
+     * Same name again moves the new program into the existing Shader, pointers and handles to it stay valid.
+     * The old contents leave through the incoming struct.
+     */
+    if (!inserted) {
+        Shader* previous = lib->shaders[*index];
+        if (previous != shader) {
+            Shader replaced = *previous;
+            *previous = *shader;
+            *shader   = replaced;
+
+            if (compiler.fallback == shader) compiler.fallback = previous;
+            __namespace(Destroy)(shader);
+        }
+        return previous;
+    }
+
+    if (lib->count == lib->capacity) {
+        u32      capacity = lib->capacity ? lib->capacity * 2 : SHADER_LIBRARY_CAPACITY;
+        Shader** shaders  = (Shader**)core_MemoryRealloc(lib->shaders, capacity * sizeof(Shader*), MEMORY_TAG_SHADER);
+        if (!shaders) {
+            core_HashMapRemove(&lib->table, shader->id);
+            return NULL;
+        }
+        lib->shaders  = shaders;
+        lib->capacity = capacity;
+    }
 
-    ShaderNode* node = (ShaderNode*)malloc(sizeof(ShaderNode));
-    node->shader = shader;
-    node->next = lib->head;
-    lib->head = node;
+    *index = lib->count;
+    lib->shaders[lib->count++] = shader;
+    return shader;
 }
 
 Shader* __namespace(LibraryGet)(ShaderLibrary* lib, const char* name)
+{
+    if (!name) return NULL;
+    return __namespace(LibraryGetById)(lib, core_StrIdHash(name, strlen(name)));
+}
+
+Shader* __namespace(LibraryGetById)(ShaderLibrary* lib, StringId id)
 {
     if (!lib) return NULL;
-    ShaderNode* current = lib->head;
-    while (current) {
-        if (strcmp(current->shader->name, name) == 0)
-            return current->shader;
-        current = current->next;
-    }
-    return NULL;
+
+    const u32* index = HASHMAP_GET_TYPE(&lib->table, u32, id);
+    return index ? lib->shaders[*index] : NULL;
+}
+
+u32 __namespace(LibraryCount)(const ShaderLibrary* lib)
+{
+    return lib ? lib->count : 0;
+}
+
+u8 __namespace(LibraryNext)(const ShaderLibrary* lib, u32* cursor, Shader** shader)
+{
+    if (!lib || !cursor || *cursor >= lib->count) return False;
+
+    *shader = lib->shaders[(*cursor)++];
+    return True;
+}
+
+u32 __namespace(LibraryReloadFile)(ShaderLibrary* lib, const char* path)
+{
+    if (!lib || !path) return 0;
+
+    u32 submitted = 0;
+    for (u32 i = 0; i < lib->count; i++)
+        if (__namespace(UsesFile)(lib->shaders[i], path))
+            submitted += __namespace(ReloadFromFile)(lib->shaders[i]);
+    return submitted;
+}
+
+u32 __namespace(LibraryPoll)(ShaderLibrary* lib)
+{
+    if (!lib) return 0;
+
+    u32 pending = 0;
+    for (u32 i = 0; i < lib->count; i++)
+        pending += __namespace(Poll)(lib->shaders[i]) == SHADER_STATUS_PENDING;
+    return pending;
 }
 
 void __namespace(LibraryDestroy)(ShaderLibrary* lib)
 {
     if (!lib) return;
-    ShaderNode* current = lib->head;
-    while (current) {
-        ShaderNode* next = current->next;
-        __namespace(Destroy)(current->shader);
-        free(current);
-        current = next;
-    }
-    free(lib);
+
+    for (u32 i = 0; i < lib->count; i++)
+        __namespace(Destroy)(lib->shaders[i]);
+
+    core_HashMapFree(&lib->table);
+    core_MemoryFree(lib->shaders);
+    core_MemoryFree(lib);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -318,17 +826,22 @@ static const char* basic_vert =
     "layout(location = 0) in vec3 aPosition;\n"
     "layout(location = 1) in vec3 aNormal;\n"
     "layout(location = 2) in vec3 aColor;\n"
-    "uniform mat4 uMVP;\n"
-    "uniform mat4 uModel;\n"
+    "layout(std140) uniform ObjectBlock\n"
+    "{\n"
+    "    mat4 model;\n"
+    "    mat4 mvp;\n"
+    "    mat4 normalMatrix;\n"
+    "    vec4 color;\n"
+    "} uObject;\n"
     "out vec3 vColor;\n"
     "out vec3 vNormal;\n"
     "out vec3 vFragPos;\n"
     "void main()\n"
     "{\n"
-    "    gl_Position = uMVP * vec4(aPosition, 1.0);\n"
-    "    vColor = aColor;\n"
-    "    vNormal = mat3(uModel) * aNormal;\n"
-    "    vFragPos = vec3(uModel * vec4(aPosition, 1.0));\n"
+    "    gl_Position = uObject.mvp * vec4(aPosition, 1.0);\n"
+    "    vColor = aColor * uObject.color.rgb;\n"
+    "    vNormal = mat3(uObject.normalMatrix) * aNormal;\n"
+    "    vFragPos = vec3(uObject.model * vec4(aPosition, 1.0));\n"
     "}\n";
 
 static const char* basic_frag = 
@@ -3,28 +3,72 @@
 
 #include <core/types.h>
 #include <core/math.h>
+#include <core/strid.h>
+#include <core/containers/hashmap.h>
+#include <render/shader_reflect.h>
+
+#ifdef GLX_VULKAN
+    #include <vulkan/vulkan.h>
+#endif
 
 #define __namespace( func_name ) renderer##_##Shader##func_name
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/* Resolved once per shader, index into Shader.uniformList */
+typedef struct { i32 index; } UniformHandle;
+
+#define UNIFORM_HANDLE_INVALID ((UniformHandle){ -1 })
+#define UNIFORM_HANDLE_IS_VALID( handle ) ( ( handle ).index >= 0 )
+
+typedef enum
+{
+    SHADER_STATUS_READY = 0,
+    SHADER_STATUS_PENDING,      /* submitted to the driver, not linked yet */
+    SHADER_STATUS_FAILED,
+} ShaderStatus;
+
 typedef struct
 {
-    u32         programID;
-    const char* name;
-    
-    struct 
+    StringId id;
+    i32      location;
+    u32      type;          /* GL type enum */
+    i32      count;         /* array length, 1 for plain uniforms */
+    u32      offset;        /* into the shadow copy */
+    u32      bytes;         /* 0 when the type is not shadowed */
+    u8       cached;        /* shadow holds the value the program has */
+} ShaderUniform;
+
+typedef struct
+{
+    u32            programID;
+    const char*    name;
+    StringId       id;
+    ShaderStatus   status;
+    u32            stages[2];       /* vertex and fragment objects while the program is pending */
+    u64            cacheKey;
+    char*          sourcePaths[2];  /* files the shader was loaded from, NULL when built from strings */
+
+    /* Replacement program compiling behind the current one, Poll swaps it in once it links */
+    struct
     {
-        i32 mvp;
-        i32 model;
-        i32 view;
-        i32 projection;
-        i32 normalMatrix;
-        i32 color;
-        i32 texture0;
-        i32 cameraPos;
-    } uniforms;
-    
+        u32 program;
+        u32 stages[2];
+        u64 cacheKey;
+    } reload;
+
+    #ifdef GLX_VULKAN
+    VkShaderModule modules[2];      /* vertex and fragment SPIR-V, pipelines are built against them */
+    #endif
+
+    /* Inputs, uniforms, blocks and samplers of the linked program, or of the SPIR-V modules on Vulkan */
+    ShaderReflection reflection;
+
+    /* Uniforms and samplers from the reflection with a shadow copy each, id -> index into uniformList */
+    HashMap        uniformTable;
+    ShaderUniform* uniformList;
+    u32            uniformCount;
+    u8*            shadow;
 } Shader;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -32,7 +76,30 @@ typedef struct
 Shader* __namespace( Create )        ( const char* name, const char* vertexSrc, const char* fragmentSrc );
 Shader* __namespace( LoadFromFile )  ( const char* name, const char* vertPath, const char* fragPath );
 
-void __namespace( Bind  )            ( Shader* shader );
+/* Whole file as a NUL terminated string (MEMORY_TAG_ASSET), free with core_MemoryFree. Includes are not expanded */
+char*   __namespace( ReadSource )    ( const char* path );
+
+/* Submits compile and link and returns a pending shader, NULL only when the shader can not be allocated */
+Shader* __namespace( CreateAsync )       ( const char* name, const char* vertexSrc, const char* fragmentSrc );
+Shader* __namespace( LoadFromFileAsync ) ( const char* name, const char* vertPath, const char* fragPath );
+
+/* Finishes the program once the driver reports completion, never waits with parallel compile available */
+ShaderStatus __namespace( Poll )     ( Shader* shader );
+
+/*
+ * Compiles new sources behind the current program, which keeps drawing until Poll sees the replacement link.
+ * A build that fails is dropped and the old program stays. Uniform values are reset by the swap.
+ */
+u8      __namespace( Reload )         ( Shader* shader, const char* vertexSrc, const char* fragmentSrc );
+u8      __namespace( ReloadFromFile ) ( Shader* shader );
+/* True when path is one of the shader's files or something they include */
+u8      __namespace( UsesFile )       ( const Shader* shader, const char* path );
+
+/* Bound instead of a shader that is still pending or failed */
+void    __namespace( SetFallback )   ( Shader* shader );
+
+/* Returns the shader actually bound, the fallback while the requested one is not ready */
+Shader* __namespace( Bind  )         ( Shader* shader );
 void __namespace( Ubind )            ( void );
 
 void __namespace( SetInt   )         ( Shader* shader, const char* name, i32 value );
@@ -43,6 +110,15 @@ void __namespace( SetVec4  )         ( Shader* shader, const char* name, Vec4 va
 void __namespace( SetMat4  )         ( Shader* shader, const char* name, const Mat4* value );
 void __namespace( SetColor )         ( Shader* shader, const char* name, Vec3 value );
 
+/* Handle setters, the shader must be bound. Uploads are skipped when the value did not change */
+UniformHandle __namespace( GetUniform )    ( Shader* shader, StringId id );
+void __namespace( SetUniformInt   )  ( Shader* shader, UniformHandle handle, i32 value );
+void __namespace( SetUniformFloat )  ( Shader* shader, UniformHandle handle, f32 value );
+void __namespace( SetUniformVec2  )  ( Shader* shader, UniformHandle handle, Vec2 value );
+void __namespace( SetUniformVec3  )  ( Shader* shader, UniformHandle handle, Vec3 value );
+void __namespace( SetUniformVec4  )  ( Shader* shader, UniformHandle handle, Vec4 value );
+void __namespace( SetUniformMat4  )  ( Shader* shader, UniformHandle handle, const Mat4* value );
+
 void __namespace( SetMvp      )      ( Shader* shader, const Mat4* model, const Mat4* view, const Mat4* proj );
 void __namespace( SetMatrices )      ( Shader* shader, const Mat4* model, const Mat4* view, const Mat4* proj );
 
@@ -51,10 +127,29 @@ void __namespace( Destroy )          ( Shader* shader );
 
 typedef struct ShaderLibrary ShaderLibrary;
 
+/* The library owns its shaders, they are destroyed with it */
 ShaderLibrary* __namespace( LibraryCreate )         ( void );
-void           __namespace( LibraryAdd )            ( ShaderLibrary* lib, Shader* shader );
-Shader*        __namespace( LibraryGet )            ( ShaderLibrary* lib, const char* name );
 void           __namespace( LibraryDestroy )        ( ShaderLibrary* lib );
+
+/*
+ * A name already in the library keeps its Shader: the new program is moved into it and the passed shader is
+ * destroyed. Returns the shader the library holds, NULL when it could not be added
+ */
+Shader*        __namespace( LibraryAdd )            ( ShaderLibrary* lib, Shader* shader );
+
+/* Constant time, no string compares */
+Shader*        __namespace( LibraryGet )            ( ShaderLibrary* lib, const char* name );
+Shader*        __namespace( LibraryGetById )        ( ShaderLibrary* lib, StringId id );
+
+/* Insertion order, start with *cursor = 0. Adding while iterating is fine, replaced shaders are not revisited */
+u32            __namespace( LibraryCount )          ( const ShaderLibrary* lib );
+u8             __namespace( LibraryNext )           ( const ShaderLibrary* lib, u32* cursor, Shader** shader );
+
+/* Starts a reload of every shader loaded from path, returns how many were submitted */
+u32            __namespace( LibraryReloadFile )     ( ShaderLibrary* lib, const char* path );
+
+/* Polls every pending shader, returns how many are still compiling */
+u32            __namespace( LibraryPoll )           ( ShaderLibrary* lib );
 void           __namespace( LibraryLoadDefaults )   ( ShaderLibrary* lib );
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
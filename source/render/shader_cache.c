@@ -0,0 +1,270 @@
+// shader_cache.c
+#include "shader_cache.h"
+
+#include <pipe.h>
+#include <glad/glad.h>
+#include <core/debug.h>
+#include <core/memory.h>
+#include <stdio.h>
+#include <string.h>
+
+#if PIPE_LINUX
+    #include <sys/stat.h>
+    #include <errno.h>
+#elif PIPE_WINDOWS
+    #include <direct.h>
+    #include <errno.h>
+#endif
+
+#define __namespace(func_name) renderer_ShaderCache##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define SHADER_CACHE_MAGIC    0x43485343u   /* "CSHC" */
+#define SHADER_CACHE_VERSION  1u
+#define SHADER_CACHE_PATH_MAX 512
+#define SHADER_CACHE_MAX_BLOB MB(16)
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME  0x100000001b3ull
+
+/* Written in front of every binary, the driver hash catches entries from another GPU or driver update */
+typedef struct
+{
+    u32 magic;
+    u32 version;
+    u64 key;
+    u64 driverHash;
+    u32 format;
+    u32 length;
+} ShaderCacheHeader;
+
+static struct
+{
+    char             directory[SHADER_CACHE_PATH_MAX - 32];     /* room left for the entry name */
+    u64              driverHash;
+    ShaderCacheStats stats;
+    u8               enabled;
+} cache = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static u64 HashBytes(u64 hash, const void* data, usize length)
+{
+    const u8* bytes = (const u8*)data;
+    for (usize i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/* The terminator is hashed too, so "ab" + "c" and "a" + "bc" do not collide */
+static u64 HashString(u64 hash, const char* str)
+{
+    if (!str) str = "";
+    return HashBytes(hash, str, strlen(str) + 1);
+}
+
+static void EntryPath(char* path, u64 key)
+{
+    snprintf(path, SHADER_CACHE_PATH_MAX, "%s/%016llx.bin", cache.directory, (unsigned long long)key);
+}
+
+static u8 MakeDirectory(const char* path)
+{
+    #if PIPE_LINUX
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+    #elif PIPE_WINDOWS
+    return _mkdir(path) == 0 || errno == EEXIST;
+    #else
+    UNUSED(path);
+    return False;
+    #endif
+}
+
+/* Creates every missing component of the path */
+static u8 MakeDirectories(const char* directory)
+{
+    char path[SHADER_CACHE_PATH_MAX];
+    snprintf(path, sizeof(path), "%s", directory);
+
+    for (char* c = path + 1; *c; c++) {
+        if (*c != '/' && *c != '\\') continue;
+        *c = '\0';
+        if (!MakeDirectory(path)) return False;
+        *c = '/';
+    }
+    return MakeDirectory(path);
+}
+
+static void Discard(const char* path)
+{
+    cache.stats.stale++;
+    remove(path);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace(Init)(const char* directory)
+{
+    memset(&cache, 0, sizeof(cache));
+
+    if (!GLAD_GL_VERSION_4_1 && !GLAD_GL_ARB_get_program_binary) {
+        LOG_WARN("Shader cache: program binaries not supported, compiling from source");
+        return False;
+    }
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        LOG_WARN("Shader cache: driver exposes no program binary formats, compiling from source");
+        return False;
+    }
+
+    snprintf(cache.directory, sizeof(cache.directory), "%s", directory ? directory : SHADER_CACHE_DEFAULT_DIR);
+    if (!MakeDirectories(cache.directory)) {
+        LOG_WARN("Shader cache: can not create '%s', compiling from source", cache.directory);
+        return False;
+    }
+
+    static const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+
+    cache.driverHash = FNV_OFFSET;
+    for (u32 i = 0; i < sizeof(driverStrings) / sizeof(driverStrings[0]); i++)
+        cache.driverHash = HashString(cache.driverHash, (const char*)glGetString(driverStrings[i]));
+
+    cache.enabled = True;
+    LOG_INFO("Shader cache: '%s' (%d binary formats)", cache.directory, formats);
+    return True;
+}
+
+void __namespace(Shutdown)(void)
+{
+    if (cache.enabled)
+        LOG_INFO("Shader cache: %u hits, %u misses, %u stale, %u stored",
+            cache.stats.hits, cache.stats.misses, cache.stats.stale, cache.stats.stores);
+    cache.enabled = False;
+}
+
+u8 __namespace(Enabled)(void)
+{
+    return cache.enabled;
+}
+
+ShaderCacheStats __namespace(GetStats)(void)
+{
+    return cache.stats;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u64 __namespace(Key)(const char* vertexSrc, const char* fragmentSrc, const char* defines)
+{
+    if (!cache.enabled) return SHADER_CACHE_KEY_NONE;
+
+    u64 hash = HashBytes(FNV_OFFSET, &cache.driverHash, sizeof(cache.driverHash));
+    hash = HashString(hash, vertexSrc);
+    hash = HashString(hash, fragmentSrc);
+    hash = HashString(hash, defines);
+
+    return hash == SHADER_CACHE_KEY_NONE ? 1 : hash;
+}
+
+u32 __namespace(Load)(u64 key)
+{
+    if (!cache.enabled || key == SHADER_CACHE_KEY_NONE) return 0;
+
+    char path[SHADER_CACHE_PATH_MAX];
+    EntryPath(path, key);
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        cache.stats.misses++;
+        return 0;
+    }
+
+    ShaderCacheHeader header;
+    u8 valid = fread(&header, sizeof(header), 1, f) == 1 &&
+               header.magic == SHADER_CACHE_MAGIC && header.version == SHADER_CACHE_VERSION &&
+               header.key == key && header.driverHash == cache.driverHash &&
+               header.length > 0 && header.length <= SHADER_CACHE_MAX_BLOB;
+
+    void* blob = valid ? core_MemoryAlloc(header.length, MEMORY_TAG_SHADER) : NULL;
+    if (blob && fread(blob, 1, header.length, f) != header.length) valid = False;
+    fclose(f);
+
+    if (!valid || !blob) {
+        core_MemoryFree(blob);
+        Discard(path);
+        return 0;
+    }
+
+    u32 program = glCreateProgram();
+    glProgramBinary(program, header.format, blob, (GLsizei)header.length);
+    core_MemoryFree(blob);
+
+    /* Drivers reject binaries from an older build of themselves here, the source path takes over */
+    i32 linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        glDeleteProgram(program);
+        Discard(path);
+        return 0;
+    }
+
+    cache.stats.hits++;
+    return program;
+}
+
+void __namespace(Store)(u64 key, u32 program)
+{
+    if (!cache.enabled || key == SHADER_CACHE_KEY_NONE || !program) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0 || (u32)length > SHADER_CACHE_MAX_BLOB) return;
+
+    void* blob = core_MemoryAlloc((usize)length, MEMORY_TAG_SHADER);
+    if (!blob) return;
+
+    ShaderCacheHeader header = {
+        .magic      = SHADER_CACHE_MAGIC,
+        .version    = SHADER_CACHE_VERSION,
+        .key        = key,
+        .driverHash = cache.driverHash,
+    };
+
+    GLsizei written = 0;
+    GLenum  format  = 0;
+    glGetProgramBinary(program, length, &written, &format, blob);
+    header.format = format;
+    header.length = (u32)written;
+
+    /* Written next to the entry and renamed over it, a crash never leaves a torn binary behind */
+    char path[SHADER_CACHE_PATH_MAX], temp[SHADER_CACHE_PATH_MAX + 4];
+    EntryPath(path, key);
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+
+    u8 saved = False;
+    FILE* f = written > 0 ? fopen(temp, "wb") : NULL;
+    if (f) {
+        saved = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                fwrite(blob, 1, header.length, f) == header.length;
+        saved = (fclose(f) == 0) && saved;
+
+        #if PIPE_WINDOWS
+        remove(path);
+        #endif
+        if (saved) saved = rename(temp, path) == 0;
+        if (!saved) remove(temp);
+    }
+    core_MemoryFree(blob);
+
+    if (saved) cache.stats.stores++;
+    else LOG_WARN("Shader cache: failed to write '%s'", path);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
@@ -0,0 +1,45 @@
+#ifndef __shader_cache_h__
+#define __shader_cache_h__
+
+#include <core/types.h>
+
+#define __namespace( func_name ) renderer##_##ShaderCache##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define SHADER_CACHE_DEFAULT_DIR "cache/shaders"
+#define SHADER_CACHE_KEY_NONE    0ull
+
+typedef struct
+{
+    u32 hits;
+    u32 misses;
+    u32 stale;      /* entries rejected by the header check or by the driver */
+    u32 stores;
+} ShaderCacheStats;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Needs a current context, returns False and leaves the cache off when the driver has no binary formats */
+u8   __namespace( Init )     ( const char* directory );
+void __namespace( Shutdown ) ( void );
+u8   __namespace( Enabled )  ( void );
+
+/* Hash of both stages, the define block and the driver vendor, renderer and version */
+u64  __namespace( Key )      ( const char* vertexSrc, const char* fragmentSrc, const char* defines );
+
+/* Linked program from disk, 0 on a miss or when the driver rejects the stored binary */
+u32  __namespace( Load )     ( u64 key );
+
+/* The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set */
+void __namespace( Store )    ( u64 key, u32 program );
+
+ShaderCacheStats __namespace( GetStats ) ( void );
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __shader_cache_h__ */
@@ -0,0 +1,464 @@
+// shader_reflect.c
+#include "shader_reflect.h"
+
+#include <core/debug.h>
+#include <core/memory.h>
+#include <string.h>
+
+#ifdef GLX_OPENGL
+    #include <glad/glad.h>
+#endif
+
+#define __namespace(func_name) renderer_ShaderReflect##func_name
+
+#define REFLECT_INITIAL_CAPACITY 8
+#define REFLECT_NAME_MAX         128
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static ShaderBinding* Push(ShaderReflection* reflection, ShaderBindingKind kind, StringId id)
+{
+    if (__namespace(Find)(reflection, kind, id) >= 0) return NULL;
+
+    if (reflection->count == reflection->capacity) {
+        u32 capacity = reflection->capacity ? reflection->capacity * 2 : REFLECT_INITIAL_CAPACITY;
+        ShaderBinding* bindings = (ShaderBinding*)core_MemoryRealloc(reflection->bindings,
+            capacity * sizeof(ShaderBinding), MEMORY_TAG_SHADER);
+        if (!bindings) return NULL;
+
+        reflection->bindings = bindings;
+        reflection->capacity = capacity;
+    }
+
+    ShaderBinding* binding = &reflection->bindings[reflection->count++];
+    memset(binding, 0, sizeof(*binding));
+    binding->id       = id;
+    binding->kind     = kind;
+    binding->location = -1;
+    binding->binding  = -1;
+    binding->count    = 1;
+    return binding;
+}
+
+i32 __namespace(Find)(const ShaderReflection* reflection, ShaderBindingKind kind, StringId id)
+{
+    if (!reflection) return -1;
+
+    for (u32 i = 0; i < reflection->count; i++)
+        if (reflection->bindings[i].id == id && reflection->bindings[i].kind == kind) return (i32)i;
+    return -1;
+}
+
+void __namespace(Free)(ShaderReflection* reflection)
+{
+    if (!reflection) return;
+
+    core_MemoryFree(reflection->bindings);
+    memset(reflection, 0, sizeof(*reflection));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef GLX_OPENGL
+
+/* Arrays are reported as name[0], lookups use the base name */
+static StringId InternName(char* name, i32 length)
+{
+    if (length > 3 && strcmp(name + length - 3, "[0]") == 0)
+        name[length - 3] = '\0';
+    return core_StrIdIntern(name);
+}
+
+static u32 TypeComponents(u32 type)
+{
+    switch (type) {
+        case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL: return 1;
+        case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: return 2;
+        case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: return 3;
+        case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_FLOAT_MAT2: return 4;
+        case GL_FLOAT_MAT3: return 9;
+        case GL_FLOAT_MAT4: return 16;
+        default: return 0;
+    }
+}
+
+static u8 IsSampler(u32 type)
+{
+    switch (type) {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D:
+            return True;
+        default:
+            return False;
+    }
+}
+
+/* Samplers report the unit they read from, set by layout(binding) or left at 0 */
+static void AddUniform(u32 program, ShaderReflection* reflection, char* name, i32 length, u32 type, i32 location,
+    i32 size)
+{
+    if (location < 0) return;
+
+    u8 sampler = IsSampler(type);
+    ShaderBinding* binding = Push(reflection, sampler ? SHADER_BINDING_SAMPLER : SHADER_BINDING_UNIFORM,
+        InternName(name, length));
+    if (!binding) return;
+
+    binding->type       = type;
+    binding->location   = location;
+    binding->components = TypeComponents(type);
+    binding->count      = (u32)size;
+
+    if (sampler) glGetUniformiv(program, location, &binding->binding);
+}
+
+static void AddInput(ShaderReflection* reflection, char* name, i32 length, u32 type, i32 location, i32 size)
+{
+    /* Built-ins such as gl_VertexID have no location */
+    if (location < 0) return;
+
+    ShaderBinding* binding = Push(reflection, SHADER_BINDING_INPUT, InternName(name, length));
+    if (!binding) return;
+
+    binding->type       = type;
+    binding->location   = location;
+    binding->components = TypeComponents(type);
+    binding->count      = (u32)size;
+}
+
+static void AddBlock(ShaderReflection* reflection, char* name, i32 length, i32 bindingPoint, i32 bytes)
+{
+    ShaderBinding* binding = Push(reflection, SHADER_BINDING_BLOCK, InternName(name, length));
+    if (!binding) return;
+
+    binding->binding = bindingPoint;
+    binding->count   = (u32)bytes;
+}
+
+static void ReflectInterface(u32 program, ShaderReflection* reflection)
+{
+    char  name[REFLECT_NAME_MAX];
+    GLint active = 0, length = 0;
+
+    static const GLenum inputProps[] = { GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE };
+    glGetProgramInterfaceiv(program, GL_PROGRAM_INPUT, GL_ACTIVE_RESOURCES, &active);
+    for (i32 i = 0; i < active; i++) {
+        GLint values[ARRAY_SIZE(inputProps)];
+        glGetProgramResourceName(program, GL_PROGRAM_INPUT, (u32)i, sizeof(name), &length, name);
+        glGetProgramResourceiv(program, GL_PROGRAM_INPUT, (u32)i, ARRAY_SIZE(inputProps), inputProps,
+            ARRAY_SIZE(values), NULL, values);
+        AddInput(reflection, name, length, (u32)values[0], values[1], values[2]);
+    }
+
+    /* Block members carry a block index and are reached through the block instead */
+    static const GLenum uniformProps[] = { GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE, GL_BLOCK_INDEX };
+    glGetProgramInterfaceiv(program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &active);
+    for (i32 i = 0; i < active; i++) {
+        GLint values[ARRAY_SIZE(uniformProps)];
+        glGetProgramResourceiv(program, GL_UNIFORM, (u32)i, ARRAY_SIZE(uniformProps), uniformProps,
+            ARRAY_SIZE(values), NULL, values);
+        if (values[3] != -1) continue;
+
+        glGetProgramResourceName(program, GL_UNIFORM, (u32)i, sizeof(name), &length, name);
+        AddUniform(program, reflection, name, length, (u32)values[0], values[1], values[2]);
+    }
+
+    static const GLenum blockProps[] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+    glGetProgramInterfaceiv(program, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &active);
+    for (i32 i = 0; i < active; i++) {
+        GLint values[ARRAY_SIZE(blockProps)];
+        glGetProgramResourceName(program, GL_UNIFORM_BLOCK, (u32)i, sizeof(name), &length, name);
+        glGetProgramResourceiv(program, GL_UNIFORM_BLOCK, (u32)i, ARRAY_SIZE(blockProps), blockProps,
+            ARRAY_SIZE(values), NULL, values);
+        AddBlock(reflection, name, length, values[0], values[1]);
+    }
+}
+
+static void ReflectLegacy(u32 program, ShaderReflection* reflection)
+{
+    char    name[REFLECT_NAME_MAX];
+    GLint   active = 0, size = 0;
+    GLsizei length = 0;
+    GLenum  type   = 0;
+
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &active);
+    for (i32 i = 0; i < active; i++) {
+        glGetActiveAttrib(program, (u32)i, sizeof(name), &length, &size, &type, name);
+        AddInput(reflection, name, length, type, glGetAttribLocation(program, name), size);
+    }
+
+    /* Block members have no location and are skipped by AddUniform */
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &active);
+    for (i32 i = 0; i < active; i++) {
+        glGetActiveUniform(program, (u32)i, sizeof(name), &length, &size, &type, name);
+        AddUniform(program, reflection, name, length, type, glGetUniformLocation(program, name), size);
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &active);
+    for (i32 i = 0; i < active; i++) {
+        GLint bindingPoint = 0, bytes = 0;
+        glGetActiveUniformBlockName(program, (u32)i, sizeof(name), &length, name);
+        glGetActiveUniformBlockiv(program, (u32)i, GL_UNIFORM_BLOCK_BINDING, &bindingPoint);
+        glGetActiveUniformBlockiv(program, (u32)i, GL_UNIFORM_BLOCK_DATA_SIZE, &bytes);
+        AddBlock(reflection, name, length, bindingPoint, bytes);
+    }
+}
+
+u8 __namespace(Program)(u32 program, ShaderReflection* reflection)
+{
+    if (!program || !reflection) return False;
+
+    if (GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_program_interface_query)
+        ReflectInterface(program, reflection);
+    else
+        ReflectLegacy(program, reflection);
+    return True;
+}
+
+#endif /* GLX_OPENGL */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define SPIRV_MAGIC       0x07230203u
+#define SPIRV_HEADER      5
+#define SPIRV_TYPE_DEPTH  8
+
+/* The subset of the SPIR-V grammar reflection reads */
+enum
+{
+    SPIRV_OP_NAME              = 5,
+    SPIRV_OP_ENTRY_POINT       = 15,
+    SPIRV_OP_TYPE_INT          = 21,
+    SPIRV_OP_TYPE_FLOAT        = 22,
+    SPIRV_OP_TYPE_VECTOR       = 23,
+    SPIRV_OP_TYPE_MATRIX       = 24,
+    SPIRV_OP_TYPE_SAMPLED      = 27,
+    SPIRV_OP_TYPE_ARRAY        = 28,
+    SPIRV_OP_TYPE_STRUCT       = 30,
+    SPIRV_OP_TYPE_POINTER      = 32,
+    SPIRV_OP_CONSTANT          = 43,
+    SPIRV_OP_VARIABLE          = 59,
+    SPIRV_OP_DECORATE          = 71,
+    SPIRV_OP_MEMBER_DECORATE   = 72,
+
+    SPIRV_DECORATION_BLOCK        = 2,
+    SPIRV_DECORATION_BUFFER_BLOCK = 3,
+    SPIRV_DECORATION_ARRAY_STRIDE = 6,
+    SPIRV_DECORATION_BUILT_IN     = 11,
+    SPIRV_DECORATION_LOCATION     = 30,
+    SPIRV_DECORATION_BINDING      = 33,
+    SPIRV_DECORATION_SET          = 34,
+    SPIRV_DECORATION_OFFSET       = 35,
+
+    SPIRV_STORAGE_UNIFORM_CONSTANT = 0,
+    SPIRV_STORAGE_INPUT            = 1,
+    SPIRV_STORAGE_UNIFORM          = 2,
+    SPIRV_STORAGE_STORAGE_BUFFER   = 12,
+
+    SPIRV_MODEL_VERTEX = 0,
+};
+
+/* Per result id, the instruction that defined it and the decorations that matter here */
+typedef struct
+{
+    const u32*  inst;
+    const char* name;
+    i32         location;
+    i32         binding;
+    u32         set;
+    u32         arrayStride;
+    u32         lastOffset;     /* structs, the member at the highest offset ends the block */
+    u32         lastMember;
+    u8          block;
+    u8          builtIn;
+} SpirvId;
+
+static u32 SpirvComponents(const SpirvId* ids, u32 bound, u32 type, u32 depth)
+{
+    if (type >= bound || !ids[type].inst || depth > SPIRV_TYPE_DEPTH) return 0;
+
+    const u32* inst = ids[type].inst;
+    switch (inst[0] & 0xFFFF) {
+        case SPIRV_OP_TYPE_INT:
+        case SPIRV_OP_TYPE_FLOAT:  return 1;
+        case SPIRV_OP_TYPE_VECTOR: return inst[3] * SpirvComponents(ids, bound, inst[2], depth + 1);
+        case SPIRV_OP_TYPE_MATRIX: return inst[3] * SpirvComponents(ids, bound, inst[2], depth + 1);
+        case SPIRV_OP_TYPE_ARRAY:  return SpirvComponents(ids, bound, inst[2], depth + 1);
+        default:                   return 0;
+    }
+}
+
+static u32 SpirvArrayLength(const SpirvId* ids, u32 bound, u32 type)
+{
+    if (type >= bound || !ids[type].inst || (ids[type].inst[0] & 0xFFFF) != SPIRV_OP_TYPE_ARRAY) return 1;
+
+    u32 length = ids[type].inst[3];
+    if (length >= bound || !ids[length].inst || (ids[length].inst[0] & 0xFFFF) != SPIRV_OP_CONSTANT) return 1;
+    return ids[length].inst[3];
+}
+
+/* Bytes under std140, matrix columns take a full vec4 each */
+static u32 SpirvSize(const SpirvId* ids, u32 bound, u32 type, u32 depth)
+{
+    if (type >= bound || !ids[type].inst || depth > SPIRV_TYPE_DEPTH) return 0;
+
+    const SpirvId* id   = &ids[type];
+    const u32*     inst = id->inst;
+    u16            wordCount = (u16)(inst[0] >> 16);
+
+    switch (inst[0] & 0xFFFF) {
+        case SPIRV_OP_TYPE_INT:
+        case SPIRV_OP_TYPE_FLOAT:  return inst[2] / 8;
+        case SPIRV_OP_TYPE_VECTOR: return inst[3] * SpirvSize(ids, bound, inst[2], depth + 1);
+        case SPIRV_OP_TYPE_MATRIX: return inst[3] * MAX(16u, SpirvSize(ids, bound, inst[2], depth + 1));
+        case SPIRV_OP_TYPE_ARRAY: {
+            u32 stride = id->arrayStride ? id->arrayStride : SpirvSize(ids, bound, inst[2], depth + 1);
+            return SpirvArrayLength(ids, bound, type) * stride;
+        }
+        case SPIRV_OP_TYPE_STRUCT:
+            if (2 + id->lastMember >= wordCount) return 0;
+            return id->lastOffset + SpirvSize(ids, bound, inst[2 + id->lastMember], depth + 1);
+        default:
+            return 0;
+    }
+}
+
+/* Pointer types point at their pointee, arrays of resources at their element */
+static u32 SpirvPointee(const SpirvId* ids, u32 bound, u32 pointer)
+{
+    if (pointer >= bound || !ids[pointer].inst || (ids[pointer].inst[0] & 0xFFFF) != SPIRV_OP_TYPE_POINTER) return 0;
+    return ids[pointer].inst[3];
+}
+
+static u32 SpirvElement(const SpirvId* ids, u32 bound, u32 type)
+{
+    if (type < bound && ids[type].inst && (ids[type].inst[0] & 0xFFFF) == SPIRV_OP_TYPE_ARRAY)
+        return ids[type].inst[2];
+    return type;
+}
+
+static void SpirvAddVariable(const SpirvId* ids, u32 bound, const u32* inst, u8 vertex,
+    ShaderReflection* reflection)
+{
+    u32 id = inst[2], storage = inst[3];
+    if (id >= bound) return;
+
+    const SpirvId* variable = &ids[id];
+    u32 type    = SpirvPointee(ids, bound, inst[1]);
+    u32 element = SpirvElement(ids, bound, type);
+    if (!type || element >= bound || !ids[element].inst) return;
+
+    u32 elementOp = ids[element].inst[0] & 0xFFFF;
+
+    if (storage == SPIRV_STORAGE_INPUT) {
+        if (!vertex || variable->builtIn || variable->location < 0 || !variable->name) return;
+
+        ShaderBinding* binding = Push(reflection, SHADER_BINDING_INPUT, core_StrIdIntern(variable->name));
+        if (!binding) return;
+
+        binding->location   = variable->location;
+        binding->components = SpirvComponents(ids, bound, type, 0);
+        binding->count      = SpirvArrayLength(ids, bound, type);
+        return;
+    }
+
+    u8 buffer = (storage == SPIRV_STORAGE_UNIFORM && ids[element].block) || storage == SPIRV_STORAGE_STORAGE_BUFFER;
+    u8 sampler = storage == SPIRV_STORAGE_UNIFORM_CONSTANT && elementOp == SPIRV_OP_TYPE_SAMPLED;
+    if (!buffer && !sampler) return;
+
+    /* Blocks go by their type name like GL reports them, the instance name is the fallback */
+    const char* name = buffer && ids[element].name ? ids[element].name : variable->name;
+    if (!name) return;
+
+    ShaderBinding* binding = Push(reflection, buffer ? SHADER_BINDING_BLOCK : SHADER_BINDING_SAMPLER,
+        core_StrIdIntern(name));
+    if (!binding) return;
+
+    binding->binding = variable->binding;
+    binding->set     = variable->set;
+    binding->count   = buffer ? SpirvSize(ids, bound, element, 0) : SpirvArrayLength(ids, bound, type);
+}
+
+u8 __namespace(Spirv)(const u32* words, usize wordCount, ShaderReflection* reflection)
+{
+    if (!words || !reflection || wordCount < SPIRV_HEADER || words[0] != SPIRV_MAGIC) {
+        LOG_WARN("Shader reflect: not a SPIR-V module");
+        return False;
+    }
+
+    u32 bound = words[3];
+    SpirvId* ids = (SpirvId*)core_MemoryCalloc(bound, sizeof(SpirvId), MEMORY_TAG_SHADER);
+    if (!ids) return False;
+
+    for (u32 i = 0; i < bound; i++)
+        ids[i].location = ids[i].binding = -1;
+
+    u8 vertex = False;
+
+    /* Names and decorations come before the types and variables, one pass fills the id table */
+    usize cursor = SPIRV_HEADER;
+    while (cursor < wordCount) {
+        const u32* inst = words + cursor;
+        u16 op = (u16)(inst[0] & 0xFFFF), count = (u16)(inst[0] >> 16);
+        if (!count || cursor + count > wordCount) break;
+        cursor += count;
+
+        u32 target = count > 1 ? inst[1] : bound;
+
+        switch (op) {
+            case SPIRV_OP_ENTRY_POINT:
+                vertex |= inst[1] == SPIRV_MODEL_VERTEX;
+                break;
+
+            case SPIRV_OP_NAME:
+                /* Literal strings are NUL padded to the word, a count of 2 is an empty name */
+                if (target < bound && count > 2) ids[target].name = (const char*)(inst + 2);
+                break;
+
+            case SPIRV_OP_DECORATE:
+                if (target >= bound || count < 3) break;
+                switch (inst[2]) {
+                    case SPIRV_DECORATION_BLOCK:
+                    case SPIRV_DECORATION_BUFFER_BLOCK: ids[target].block = True; break;
+                    case SPIRV_DECORATION_BUILT_IN:     ids[target].builtIn = True; break;
+                    case SPIRV_DECORATION_LOCATION:     if (count > 3) ids[target].location = (i32)inst[3]; break;
+                    case SPIRV_DECORATION_BINDING:      if (count > 3) ids[target].binding = (i32)inst[3]; break;
+                    case SPIRV_DECORATION_SET:          if (count > 3) ids[target].set = inst[3]; break;
+                    case SPIRV_DECORATION_ARRAY_STRIDE: if (count > 3) ids[target].arrayStride = inst[3]; break;
+                }
+                break;
+
+            case SPIRV_OP_MEMBER_DECORATE:
+                if (target < bound && count > 4 && inst[3] == SPIRV_DECORATION_OFFSET &&
+                    inst[4] >= ids[target].lastOffset) {
+                    ids[target].lastOffset = inst[4];
+                    ids[target].lastMember = inst[2];
+                }
+                break;
+
+            case SPIRV_OP_TYPE_INT: case SPIRV_OP_TYPE_FLOAT: case SPIRV_OP_TYPE_VECTOR: case SPIRV_OP_TYPE_MATRIX:
+            case SPIRV_OP_TYPE_SAMPLED: case SPIRV_OP_TYPE_ARRAY: case SPIRV_OP_TYPE_STRUCT:
+            case SPIRV_OP_TYPE_POINTER:
+                if (target < bound) ids[target].inst = inst;
+                break;
+
+            /* Result id comes second for constants and variables */
+            case SPIRV_OP_CONSTANT:
+            case SPIRV_OP_VARIABLE:
+                if (count > 3 && inst[2] < bound) ids[inst[2]].inst = inst;
+                break;
+        }
+    }
+
+    for (u32 i = 0; i < bound; i++)
+        if (ids[i].inst && (ids[i].inst[0] & 0xFFFF) == SPIRV_OP_VARIABLE)
+            SpirvAddVariable(ids, bound, ids[i].inst, vertex, reflection);
+
+    core_MemoryFree(ids);
+    return True;
+}
+
+#undef __namespace
@@ -0,0 +1,66 @@
+#ifndef __shader_reflect_h__
+#define __shader_reflect_h__
+
+#include <core/types.h>
+#include <core/strid.h>
+
+#define __namespace( func_name ) renderer##_##ShaderReflect##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * What a program reads, gathered once when it links (GL) or from its SPIR-V modules (Vulkan). Draw code resolves
+ * a binding to its index or slot at load and never asks the driver by name afterwards.
+ */
+typedef enum
+{
+    SHADER_BINDING_UNIFORM = 0,     /* default block uniform outside any buffer */
+    SHADER_BINDING_BLOCK,           /* uniform or storage buffer */
+    SHADER_BINDING_SAMPLER,
+    SHADER_BINDING_INPUT,           /* vertex stage input */
+} ShaderBindingKind;
+
+typedef struct
+{
+    StringId          id;           /* interned, block bindings use the block name */
+    ShaderBindingKind kind;
+    u32               type;         /* GL type enum, 0 when reflected from SPIR-V or for blocks */
+    i32               location;     /* uniforms, samplers and inputs, -1 otherwise */
+    i32               binding;      /* buffer binding point or sampler unit, -1 otherwise */
+    u32               set;          /* descriptor set, 0 outside SPIR-V */
+    u32               components;   /* scalars per element, 0 for blocks and samplers */
+    u32               count;        /* array length, byte size for blocks */
+} ShaderBinding;
+
+typedef struct
+{
+    ShaderBinding* bindings;
+    u32            count;
+    u32            capacity;
+} ShaderReflection;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef GLX_OPENGL
+/* Program interface queries on GL 4.3, the older per kind queries otherwise. Appends to reflection */
+u8   __namespace( Program ) ( u32 program, ShaderReflection* reflection );
+#endif
+
+/*
+ * Appends what one module declares. Inputs are only taken from vertex entry points and a binding another stage
+ * already added is kept once, so every stage of a pipeline can go through the same reflection.
+ */
+u8   __namespace( Spirv )   ( const u32* words, usize wordCount, ShaderReflection* reflection );
+
+/* Index into reflection->bindings, -1 when the shader does not use it */
+i32  __namespace( Find )    ( const ShaderReflection* reflection, ShaderBindingKind kind, StringId id );
+
+void __namespace( Free )    ( ShaderReflection* reflection );
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __shader_reflect_h__ */
@@ -0,0 +1,424 @@
+// shader_source.c
+#include "shader_source.h"
+
+#include <pipe.h>
+#include <core/debug.h>
+#include <core/memory.h>
+#include <core/strid.h>
+#include <core/containers/hashmap.h>
+#include <stdio.h>
+#include <string.h>
+
+#if PIPE_LINUX
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+#endif
+
+#define __namespace(func_name) renderer_ShaderSource##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    const char* data;
+    usize       length;
+} MappedFile;
+
+/* Files a root pulled in on its last Load, the root itself is not listed */
+typedef struct
+{
+    StringId* includes;
+    u32       count;
+} SourceNode;
+
+typedef struct
+{
+    char*    text;
+    usize    length;
+    usize    capacity;
+
+    StringId files[SHADER_SOURCE_MAX_INCLUDES + 1];     /* [0] is the root */
+    u32      fileCount;
+    u32      depth;
+} Expansion;
+
+static struct
+{
+    HashMap graph;          /* StringId of the root path -> SourceNode */
+    u8      initialized;
+} sources = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Empty files map to an empty string, mmap refuses zero lengths */
+static u8 MapFile(const char* path, MappedFile* file)
+{
+    file->data   = "";
+    file->length = 0;
+
+    #if PIPE_LINUX
+    i32 fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return False;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return False;
+    }
+
+    if (info.st_size > 0) {
+        void* data = mmap(NULL, (usize)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return False;
+        }
+        file->data   = (const char*)data;
+        file->length = (usize)info.st_size;
+    }
+    close(fd);
+
+    #elif PIPE_WINDOWS
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return False;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return False;
+    }
+
+    if (size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        void*  data    = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (mapping) CloseHandle(mapping);
+        if (!data) {
+            CloseHandle(handle);
+            return False;
+        }
+        file->data   = (const char*)data;
+        file->length = (usize)size.QuadPart;
+    }
+    CloseHandle(handle);
+    #endif
+
+    core_MemoryTrack(MEMORY_TAG_ASSET, (i64)file->length);
+    return True;
+}
+
+static void UnmapFile(MappedFile* file)
+{
+    if (!file->length) return;
+
+    core_MemoryTrack(MEMORY_TAG_ASSET, -(i64)file->length);
+
+    #if PIPE_LINUX
+    munmap((void*)file->data, file->length);
+    #elif PIPE_WINDOWS
+    UnmapViewOfFile(file->data);
+    #endif
+
+    file->data   = "";
+    file->length = 0;
+}
+
+/* Lexical only: backslashes become slashes, "." and "dir/.." components are dropped */
+static u8 NormalizePath(const char* path, char* out)
+{
+    usize length = 0;
+    u32   parts[SHADER_SOURCE_PATH_MAX / 2];    /* start of each component kept so far */
+    u32   partCount = 0;
+    u32   fixedParts = 0;                       /* leading ".." that can not be collapsed */
+
+    if (*path == '/' || *path == '\\') out[length++] = '/';
+
+    for (const char* cursor = path; *cursor; ) {
+        while (*cursor == '/' || *cursor == '\\') cursor++;
+        if (!*cursor) break;
+
+        const char* end = cursor;
+        while (*end && *end != '/' && *end != '\\') end++;
+        usize partLength = (usize)(end - cursor);
+
+        if (partLength == 1 && cursor[0] == '.') {
+            cursor = end;
+            continue;
+        }
+
+        if (partLength == 2 && cursor[0] == '.' && cursor[1] == '.' && partCount > fixedParts) {
+            length = parts[--partCount];
+            cursor = end;
+            continue;
+        }
+
+        if (partCount == ARRAY_SIZE(parts) || length + partLength + 2 > SHADER_SOURCE_PATH_MAX) return False;
+
+        parts[partCount++] = (u32)length;
+        if (partLength == 2 && cursor[0] == '.' && cursor[1] == '.') fixedParts = partCount;
+
+        if (length && out[length - 1] != '/') out[length++] = '/';
+        memcpy(out + length, cursor, partLength);
+        length += partLength;
+        cursor = end;
+    }
+
+    out[length] = '\0';
+    return True;
+}
+
+static inline StringId PathId(const char* normalized)
+{
+    return core_StrIdHash(normalized, strlen(normalized));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static u8 Append(Expansion* expansion, const char* data, usize length)
+{
+    if (expansion->length + length + 1 > expansion->capacity) {
+        usize capacity = MAX(expansion->capacity * 2, expansion->length + length + 1);
+        char* text = (char*)core_MemoryRealloc(expansion->text, capacity, MEMORY_TAG_ASSET);
+        if (!text) return False;
+        expansion->text     = text;
+        expansion->capacity = capacity;
+    }
+
+    memcpy(expansion->text + expansion->length, data, length);
+    expansion->length += length;
+    expansion->text[expansion->length] = '\0';
+    return True;
+}
+
+static u8 AppendLine(Expansion* expansion, u32 line, u32 file)
+{
+    char directive[48];
+    i32  length = snprintf(directive, sizeof(directive), "#line %u %u\n", line, file);
+
+    /* The included file may end without a newline of its own */
+    if (expansion->length && expansion->text[expansion->length - 1] != '\n' && !Append(expansion, "\n", 1))
+        return False;
+    return Append(expansion, directive, (usize)length);
+}
+
+static inline u8 IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/* File name of an include directive on this line, NULL when the line is anything else */
+static const char* IncludeName(const char* line, const char* end, usize* length)
+{
+    while (line < end && IsBlank(*line)) line++;
+    if (line == end || *line++ != '#') return NULL;
+    while (line < end && IsBlank(*line)) line++;
+
+    if ((usize)(end - line) < 8 || memcmp(line, "include", 7) != 0) return NULL;
+    line += 7;
+    while (line < end && IsBlank(*line)) line++;
+
+    if (line == end || (*line != '"' && *line != '<')) return NULL;
+    char close = *line == '"' ? '"' : '>';
+
+    const char* start = ++line;
+    while (line < end && *line != close) line++;
+    if (line == end || line == start) return NULL;
+
+    *length = (usize)(line - start);
+    return start;
+}
+
+/* Resolved against the directory of the including file */
+static u8 ResolveInclude(const char* from, const char* name, usize nameLength, char* out)
+{
+    char        joined[SHADER_SOURCE_PATH_MAX];
+    const char* slash           = strrchr(from, '/');
+    usize       directoryLength = slash ? (usize)(slash - from) + 1 : 0;
+
+    if (directoryLength + nameLength >= sizeof(joined)) return False;
+    memcpy(joined, from, directoryLength);
+    memcpy(joined + directoryLength, name, nameLength);
+    joined[directoryLength + nameLength] = '\0';
+
+    return NormalizePath(joined, out);
+}
+
+static u8 Expand(Expansion* expansion, const char* path, u32 fileIndex)
+{
+    if (expansion->depth == SHADER_SOURCE_MAX_DEPTH) {
+        LOG_ERROR("Shader source: includes nested deeper than %u at '%s'", SHADER_SOURCE_MAX_DEPTH, path);
+        return False;
+    }
+
+    MappedFile file;
+    if (!MapFile(path, &file)) {
+        LOG_ERROR("Shader source: can not open '%s'", path);
+        return False;
+    }
+
+    expansion->depth++;
+
+    u8          ok     = True;
+    u32         line   = 1;
+    const char* cursor = file.data;
+    const char* end    = file.data + file.length;
+
+    while (ok && cursor < end) {
+        const char* lineEnd = (const char*)memchr(cursor, '\n', (usize)(end - cursor));
+        const char* next    = lineEnd ? lineEnd + 1 : end;
+
+        usize       nameLength;
+        const char* name = IncludeName(cursor, lineEnd ? lineEnd : end, &nameLength);
+
+        if (!name) {
+            ok = Append(expansion, cursor, (usize)(next - cursor));
+        } else {
+            char resolved[SHADER_SOURCE_PATH_MAX];
+            if (!ResolveInclude(path, name, nameLength, resolved)) {
+                LOG_ERROR("Shader source: include path too long in '%s':%u", path, line);
+                ok = False;
+                break;
+            }
+
+            StringId includeId = PathId(resolved);
+            u8       seen      = False;
+            for (u32 i = 0; i < expansion->fileCount && !seen; i++)
+                seen = expansion->files[i] == includeId;
+
+            /* Already expanded for this root, the directive line is dropped and numbering resumes after it */
+            if (seen) {
+                ok = Append(expansion, "\n", 1);
+            } else if (expansion->fileCount == ARRAY_SIZE(expansion->files)) {
+                LOG_ERROR("Shader source: more than %u includes under '%s'", SHADER_SOURCE_MAX_INCLUDES, path);
+                ok = False;
+            } else {
+                u32 includeIndex = expansion->fileCount;
+                expansion->files[expansion->fileCount++] = includeId;
+
+                ok = AppendLine(expansion, 1, includeIndex) &&
+                     Expand(expansion, resolved, includeIndex) &&
+                     AppendLine(expansion, line + 1, fileIndex);
+            }
+        }
+
+        cursor = next;
+        line++;
+    }
+
+    expansion->depth--;
+    UnmapFile(&file);
+    return ok;
+}
+
+static void RecordIncludes(StringId root, const Expansion* expansion)
+{
+    if (!sources.initialized) {
+        Allocator allocator = core_AllocatorHeap(MEMORY_TAG_SHADER);
+        if (!HASHMAP_INIT_TYPE(&sources.graph, SourceNode, 16, &allocator)) return;
+        sources.initialized = True;
+    }
+
+    SourceNode* node = (SourceNode*)core_HashMapInsert(&sources.graph, root, NULL);
+    if (!node) return;
+
+    core_MemoryFree(node->includes);
+    node->includes = NULL;
+    node->count    = expansion->fileCount - 1;
+
+    if (node->count) {
+        node->includes = (StringId*)core_MemoryAlloc(node->count * sizeof(StringId), MEMORY_TAG_SHADER);
+        if (node->includes) memcpy(node->includes, expansion->files + 1, node->count * sizeof(StringId));
+        else node->count = 0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+char* __namespace(Read)(const char* path)
+{
+    MappedFile file;
+    if (!path || !MapFile(path, &file)) {
+        LOG_ERROR("Shader source: can not open '%s'", path ? path : "");
+        return NULL;
+    }
+
+    char* text = (char*)core_MemoryAlloc(file.length + 1, MEMORY_TAG_ASSET);
+    if (text) {
+        memcpy(text, file.data, file.length);
+        text[file.length] = '\0';
+    }
+
+    UnmapFile(&file);
+    return text;
+}
+
+void* __namespace(ReadBinary)(const char* path, usize* length)
+{
+    MappedFile file;
+    if (!path || !length || !MapFile(path, &file)) {
+        LOG_ERROR("Shader source: can not open '%s'", path ? path : "");
+        return NULL;
+    }
+
+    void* data = file.length ? core_MemoryAlloc(file.length, MEMORY_TAG_ASSET) : NULL;
+    if (data) memcpy(data, file.data, file.length);
+    *length = data ? file.length : 0;
+
+    UnmapFile(&file);
+    return data;
+}
+
+char* __namespace(Load)(const char* path)
+{
+    char normalized[SHADER_SOURCE_PATH_MAX];
+    if (!path || !NormalizePath(path, normalized)) return NULL;
+
+    Expansion expansion = {0};
+    expansion.files[expansion.fileCount++] = PathId(normalized);
+
+    if (!Expand(&expansion, normalized, 0)) {
+        core_MemoryFree(expansion.text);
+        return NULL;
+    }
+
+    /* An empty root still hands back a string */
+    if (!expansion.text && !Append(&expansion, "", 0)) return NULL;
+
+    RecordIncludes(expansion.files[0], &expansion);
+    return expansion.text;
+}
+
+u8 __namespace(DependsOn)(const char* root, const char* file)
+{
+    char rootPath[SHADER_SOURCE_PATH_MAX], filePath[SHADER_SOURCE_PATH_MAX];
+    if (!root || !file || !NormalizePath(root, rootPath) || !NormalizePath(file, filePath)) return False;
+
+    StringId rootId = PathId(rootPath);
+    StringId fileId = PathId(filePath);
+    if (rootId == fileId) return True;
+    if (!sources.initialized) return False;
+
+    const SourceNode* node = HASHMAP_GET_TYPE(&sources.graph, SourceNode, rootId);
+    if (!node) return False;
+
+    for (u32 i = 0; i < node->count; i++)
+        if (node->includes[i] == fileId) return True;
+    return False;
+}
+
+void __namespace(Shutdown)(void)
+{
+    if (!sources.initialized) return;
+
+    u32         cursor = 0;
+    SourceNode* node;
+    while (core_HashMapNext(&sources.graph, &cursor, NULL, (void**)&node))
+        core_MemoryFree(node->includes);
+
+    core_HashMapFree(&sources.graph);
+    sources.initialized = False;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
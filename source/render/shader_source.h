@@ -0,0 +1,42 @@
+#ifndef __shader_source_h__
+#define __shader_source_h__
+
+#include <core/types.h>
+
+#define __namespace( func_name ) renderer##_##ShaderSource##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Sources are read through a read-only mapping. '#include "file"' resolves against the including file's
+ * directory and each file is pulled in once per root, so repeated includes act as guards and cycles stop there.
+ * Included text is wrapped in "#line <line> <file>" directives, file 0 is the root and includes number from 1
+ * in the order they were first reached.
+ */
+#define SHADER_SOURCE_MAX_DEPTH    16
+#define SHADER_SOURCE_MAX_INCLUDES 63
+#define SHADER_SOURCE_PATH_MAX     256
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Whole file as a NUL terminated string (MEMORY_TAG_ASSET), no preprocessing */
+char* __namespace( Read )      ( const char* path );
+
+/* Whole file and its length (MEMORY_TAG_ASSET), for SPIR-V modules */
+void* __namespace( ReadBinary ) ( const char* path, usize* length );
+
+/* Source with every include expanded, replaces the includes recorded for path. NULL when a file is missing */
+char* __namespace( Load )      ( const char* path );
+
+/* True when file is root itself or was included by the last Load of root. Paths are compared normalised */
+u8    __namespace( DependsOn ) ( const char* root, const char* file );
+
+void  __namespace( Shutdown )  ( void );
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __shader_source_h__ */
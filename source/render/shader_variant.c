@@ -0,0 +1,406 @@
+// shader_variant.c
+#include "shader_variant.h"
+
+#include <core/debug.h>
+#include <core/memory.h>
+#include <core/containers/hashmap.h>
+#include <render/shader_source.h>
+#include <string.h>
+
+#define __namespace(func_name) renderer_ShaderVariant##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define FEATURE_PRAGMA "#pragma coda_feature("
+
+typedef struct
+{
+    Shader* shader;
+    char*   name;           /* "set+FEATURE+FEATURE", the shader only references it */
+} VariantEntry;
+
+struct ShaderVariantSet
+{
+    char*    name;
+    StringId id;
+    char*    vertexSrc;
+    char*    fragmentSrc;
+    char*    sourcePaths[2];    /* NULL when created from strings */
+
+    char     features[SHADER_VARIANT_MAX_FEATURES][SHADER_VARIANT_NAME_MAX];
+    StringId featureIds[SHADER_VARIANT_MAX_FEATURES];
+    u32      featureCount;
+
+    HashMap  variants;      /* ShaderFeatureMask -> VariantEntry */
+};
+
+static struct {
+    HashMap sets;           /* StringId -> ShaderVariantSet* */
+    u8      initialized;
+} registry = {0};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static char* CopyString(const char* str, usize length)
+{
+    char* copy = (char*)core_MemoryAlloc(length + 1, MEMORY_TAG_SHADER);
+    if (!copy) return NULL;
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+static inline u8 IsIdentifier(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static inline u8 IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static void ParseFeatures(ShaderVariantSet* set, const char* source)
+{
+    for (const char* found = strstr(source, FEATURE_PRAGMA); found; found = strstr(found + 1, FEATURE_PRAGMA)) {
+        const char* start = found + sizeof(FEATURE_PRAGMA) - 1;
+        while (IsBlank(*start)) start++;
+
+        const char* end = start;
+        while (IsIdentifier(*end)) end++;
+
+        usize length = (usize)(end - start);
+        if (!length || length >= SHADER_VARIANT_NAME_MAX) {
+            LOG_WARN("Shader variants '%s': malformed coda_feature pragma", set->name);
+            continue;
+        }
+
+        StringId id = core_StrIdHash(start, length);
+
+        u8 known = False;
+        for (u32 i = 0; i < set->featureCount && !known; i++)
+            known = set->featureIds[i] == id;
+        if (known) continue;
+
+        if (set->featureCount == SHADER_VARIANT_MAX_FEATURES) {
+            LOG_WARN("Shader variants '%s': more than %u features, the rest are ignored",
+                set->name, SHADER_VARIANT_MAX_FEATURES);
+            return;
+        }
+
+        memcpy(set->features[set->featureCount], start, length);
+        set->features[set->featureCount][length] = '\0';
+        set->featureIds[set->featureCount] = id;
+        set->featureCount++;
+    }
+}
+
+static inline ShaderFeatureMask ValidBits(const ShaderVariantSet* set)
+{
+    return set->featureCount >= 32 ? 0xFFFFFFFFu : (1u << set->featureCount) - 1;
+}
+
+/* #version has to stay the first directive, the defines go on the line after it */
+static char* InjectDefines(const ShaderVariantSet* set, const char* source, ShaderFeatureMask mask)
+{
+    usize sourceLength = strlen(source);
+    usize insertAt     = 0;
+
+    const char* version = strstr(source, "#version");
+    if (version) {
+        const char* lineEnd = strchr(version, '\n');
+        insertAt = lineEnd ? (usize)(lineEnd - source) + 1 : sourceLength;
+    }
+
+    usize definesLength = 0;
+    for (u32 i = 0; i < set->featureCount; i++)
+        if (mask & (1u << i)) definesLength += sizeof("#define  1\n") - 1 + strlen(set->features[i]);
+
+    char* out = (char*)core_MemoryAlloc(sourceLength + definesLength + 2, MEMORY_TAG_SHADER);
+    if (!out) return NULL;
+
+    char* cursor = out;
+    memcpy(cursor, source, insertAt);
+    cursor += insertAt;
+
+    /* A #version on the last line has no newline of its own */
+    if (insertAt && cursor[-1] != '\n') *cursor++ = '\n';
+
+    for (u32 i = 0; i < set->featureCount; i++) {
+        if (!(mask & (1u << i))) continue;
+        usize length = strlen(set->features[i]);
+        memcpy(cursor, "#define ", 8);
+        memcpy(cursor + 8, set->features[i], length);
+        memcpy(cursor + 8 + length, " 1\n", 3);
+        cursor += 8 + length + 3;
+    }
+
+    memcpy(cursor, source + insertAt, sourceLength - insertAt + 1);
+    return out;
+}
+
+static char* VariantName(const ShaderVariantSet* set, ShaderFeatureMask mask)
+{
+    usize length = strlen(set->name);
+    for (u32 i = 0; i < set->featureCount; i++)
+        if (mask & (1u << i)) length += 1 + strlen(set->features[i]);
+
+    char* name = (char*)core_MemoryAlloc(length + 1, MEMORY_TAG_SHADER);
+    if (!name) return NULL;
+
+    strcpy(name, set->name);
+    for (u32 i = 0; i < set->featureCount; i++) {
+        if (!(mask & (1u << i))) continue;
+        strcat(name, "+");
+        strcat(name, set->features[i]);
+    }
+    return name;
+}
+
+static void Register(ShaderVariantSet* set)
+{
+    if (!registry.initialized) {
+        Allocator allocator = core_AllocatorHeap(MEMORY_TAG_SHADER);
+        if (!HASHMAP_INIT_TYPE(&registry.sets, ShaderVariantSet*, 16, &allocator)) return;
+        registry.initialized = True;
+    }
+
+    u8 inserted;
+    ShaderVariantSet** slot = (ShaderVariantSet**)core_HashMapInsert(&registry.sets, set->id, &inserted);
+    if (!slot) return;
+    if (!inserted)
+        LOG_WARN("Shader variants '%s' registered twice, manifests will use the newest", set->name);
+    *slot = set;
+}
+
+static void Unregister(ShaderVariantSet* set)
+{
+    if (!registry.initialized) return;
+
+    ShaderVariantSet** slot = HASHMAP_GET_TYPE(&registry.sets, ShaderVariantSet*, set->id);
+    if (slot && *slot == set)
+        core_HashMapRemove(&registry.sets, set->id);
+
+    if (!registry.sets.count) {
+        core_HashMapFree(&registry.sets);
+        registry.initialized = False;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ShaderVariantSet* __namespace(Create)(const char* name, const char* vertexSrc, const char* fragmentSrc)
+{
+    if (!name || !vertexSrc || !fragmentSrc) return NULL;
+
+    ShaderVariantSet* set = (ShaderVariantSet*)core_MemoryAlloc(sizeof(ShaderVariantSet), MEMORY_TAG_SHADER);
+    if (!set) return NULL;
+    memset(set, 0, sizeof(*set));
+
+    Allocator allocator = core_AllocatorHeap(MEMORY_TAG_SHADER);
+
+    set->name        = CopyString(name, strlen(name));
+    set->vertexSrc   = CopyString(vertexSrc, strlen(vertexSrc));
+    set->fragmentSrc = CopyString(fragmentSrc, strlen(fragmentSrc));
+
+    if (!set->name || !set->vertexSrc || !set->fragmentSrc ||
+        !HASHMAP_INIT_TYPE(&set->variants, VariantEntry, 8, &allocator)) {
+        LOG_ERROR("Shader variants '%s': out of memory", name);
+        __namespace(Destroy)(set);
+        return NULL;
+    }
+
+    set->id = core_StrIdIntern(set->name);
+    ParseFeatures(set, set->vertexSrc);
+    ParseFeatures(set, set->fragmentSrc);
+
+    Register(set);
+    return set;
+}
+
+ShaderVariantSet* __namespace(LoadFromFile)(const char* name, const char* vertPath, const char* fragPath)
+{
+    char* vertexSrc = renderer_ShaderSourceLoad(vertPath);
+    if (!vertexSrc) return NULL;
+
+    char* fragmentSrc = renderer_ShaderSourceLoad(fragPath);
+    if (!fragmentSrc) {
+        core_MemoryFree(vertexSrc);
+        return NULL;
+    }
+
+    ShaderVariantSet* set = __namespace(Create)(name, vertexSrc, fragmentSrc);
+    if (set) {
+        set->sourcePaths[0] = CopyString(vertPath, strlen(vertPath));
+        set->sourcePaths[1] = CopyString(fragPath, strlen(fragPath));
+    }
+
+    core_MemoryFree(vertexSrc);
+    core_MemoryFree(fragmentSrc);
+    return set;
+}
+
+void __namespace(Destroy)(ShaderVariantSet* set)
+{
+    if (!set) return;
+
+    u32           cursor = 0;
+    VariantEntry* entry;
+    while (core_HashMapNext(&set->variants, &cursor, NULL, (void**)&entry)) {
+        renderer_ShaderDestroy(entry->shader);
+        core_MemoryFree(entry->name);
+    }
+    core_HashMapFree(&set->variants);
+
+    Unregister(set);
+
+    core_MemoryFree(set->vertexSrc);
+    core_MemoryFree(set->fragmentSrc);
+    core_MemoryFree(set->sourcePaths[0]);
+    core_MemoryFree(set->sourcePaths[1]);
+    core_MemoryFree(set->name);
+    core_MemoryFree(set);
+}
+
+ShaderVariantSet* __namespace(Find)(StringId id)
+{
+    if (!registry.initialized) return NULL;
+
+    ShaderVariantSet** slot = HASHMAP_GET_TYPE(&registry.sets, ShaderVariantSet*, id);
+    return slot ? *slot : NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ShaderFeatureMask __namespace(Mask)(const ShaderVariantSet* set, StringId feature)
+{
+    if (!set) return 0;
+
+    for (u32 i = 0; i < set->featureCount; i++)
+        if (set->featureIds[i] == feature) return 1u << i;
+
+    LOG_WARN("Shader variants '%s' do not declare feature %s", set->name, core_StrIdName(feature));
+    return 0;
+}
+
+u32 __namespace(FeatureCount)(const ShaderVariantSet* set)
+{
+    return set ? set->featureCount : 0;
+}
+
+Shader* __namespace(Get)(ShaderVariantSet* set, ShaderFeatureMask mask)
+{
+    if (!set) return NULL;
+
+    if (mask & ~ValidBits(set)) {
+        LOG_WARN("Shader variants '%s': mask %08x has undeclared bits", set->name, mask);
+        mask &= ValidBits(set);
+    }
+
+    VariantEntry* entry = HASHMAP_GET_TYPE(&set->variants, VariantEntry, mask);
+    if (entry) return entry->shader;
+
+    char* name        = VariantName(set, mask);
+    char* vertexSrc   = InjectDefines(set, set->vertexSrc, mask);
+    char* fragmentSrc = InjectDefines(set, set->fragmentSrc, mask);
+
+    Shader* shader = NULL;
+    if (name && vertexSrc && fragmentSrc)
+        shader = renderer_ShaderCreateAsync(name, vertexSrc, fragmentSrc);
+
+    core_MemoryFree(vertexSrc);
+    core_MemoryFree(fragmentSrc);
+
+    entry = shader ? (VariantEntry*)core_HashMapInsert(&set->variants, mask, NULL) : NULL;
+    if (!entry) {
+        LOG_ERROR("Shader variants '%s': failed to create variant %08x", set->name, mask);
+        renderer_ShaderDestroy(shader);
+        core_MemoryFree(name);
+        return NULL;
+    }
+
+    entry->shader = shader;
+    entry->name   = name;
+    return shader;
+}
+
+u32 __namespace(Poll)(void)
+{
+    if (!registry.initialized) return 0;
+
+    u32                pending = 0;
+    u32                setCursor = 0;
+    ShaderVariantSet** set;
+    while (core_HashMapNext(&registry.sets, &setCursor, NULL, (void**)&set)) {
+        u32           cursor = 0;
+        VariantEntry* entry;
+        while (core_HashMapNext(&(*set)->variants, &cursor, NULL, (void**)&entry))
+            pending += renderer_ShaderPoll(entry->shader) == SHADER_STATUS_PENDING;
+    }
+    return pending;
+}
+
+/* Masks keep their bits, a feature list that changed order only takes full effect after a restart */
+static u32 ReloadSet(ShaderVariantSet* set)
+{
+    char* vertexSrc   = renderer_ShaderSourceLoad(set->sourcePaths[0]);
+    char* fragmentSrc = vertexSrc ? renderer_ShaderSourceLoad(set->sourcePaths[1]) : NULL;
+    if (!vertexSrc || !fragmentSrc) {
+        core_MemoryFree(vertexSrc);
+        return 0;
+    }
+
+    core_MemoryFree(set->vertexSrc);
+    core_MemoryFree(set->fragmentSrc);
+    set->vertexSrc   = vertexSrc;
+    set->fragmentSrc = fragmentSrc;
+
+    StringId previous[SHADER_VARIANT_MAX_FEATURES];
+    u32      previousCount = set->featureCount;
+    memcpy(previous, set->featureIds, sizeof(previous));
+
+    set->featureCount = 0;
+    ParseFeatures(set, set->vertexSrc);
+    ParseFeatures(set, set->fragmentSrc);
+
+    if (set->featureCount != previousCount || memcmp(previous, set->featureIds, previousCount * sizeof(StringId)))
+        LOG_WARN("Shader variants '%s': feature list changed, existing masks keep their bit positions", set->name);
+
+    u32           submitted = 0;
+    u32           cursor = 0;
+    u64           mask;
+    VariantEntry* entry;
+    while (core_HashMapNext(&set->variants, &cursor, &mask, (void**)&entry)) {
+        char* vertex   = InjectDefines(set, set->vertexSrc, (ShaderFeatureMask)mask & ValidBits(set));
+        char* fragment = InjectDefines(set, set->fragmentSrc, (ShaderFeatureMask)mask & ValidBits(set));
+
+        if (vertex && fragment)
+            submitted += renderer_ShaderReload(entry->shader, vertex, fragment);
+
+        core_MemoryFree(vertex);
+        core_MemoryFree(fragment);
+    }
+    return submitted;
+}
+
+u32 __namespace(ReloadFile)(const char* path)
+{
+    if (!registry.initialized || !path) return 0;
+
+    u32                submitted = 0;
+    u32                cursor = 0;
+    ShaderVariantSet** set;
+    while (core_HashMapNext(&registry.sets, &cursor, NULL, (void**)&set)) {
+        const ShaderVariantSet* current = *set;
+        if (!current->sourcePaths[0] || !current->sourcePaths[1]) continue;
+
+        if (renderer_ShaderSourceDependsOn(current->sourcePaths[0], path) ||
+            renderer_ShaderSourceDependsOn(current->sourcePaths[1], path))
+            submitted += ReloadSet(*set);
+    }
+    return submitted;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
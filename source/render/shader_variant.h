@@ -0,0 +1,56 @@
+#ifndef __shader_variant_h__
+#define __shader_variant_h__
+
+#include <core/types.h>
+#include <core/strid.h>
+#include <render/shader.h>
+
+#define __namespace( func_name ) renderer##_##ShaderVariant##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Sources declare their switches with one line per feature, in either stage:
+ *
+ *     #pragma coda_feature(SKINNING)
+ *
+ * Declaration order gives the bit. A variant is the source with "#define NAME 1" injected after #version for every
+ * bit set in its mask, compiled on first request and kept for the lifetime of the set.
+ */
+#define SHADER_VARIANT_MAX_FEATURES 32
+#define SHADER_VARIANT_NAME_MAX     32
+
+typedef u32 ShaderFeatureMask;
+
+typedef struct ShaderVariantSet ShaderVariantSet;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* The set keeps its own copy of both sources */
+ShaderVariantSet* __namespace( Create )       ( const char* name, const char* vertexSrc, const char* fragmentSrc );
+ShaderVariantSet* __namespace( LoadFromFile ) ( const char* name, const char* vertPath, const char* fragPath );
+void              __namespace( Destroy )      ( ShaderVariantSet* set );
+
+/* Registered sets by name, used by the prewarm manifest */
+ShaderVariantSet* __namespace( Find )         ( StringId id );
+
+/* 0 with a warning when the source does not declare the feature */
+ShaderFeatureMask __namespace( Mask )         ( const ShaderVariantSet* set, StringId feature );
+u32               __namespace( FeatureCount ) ( const ShaderVariantSet* set );
+
+/* Compiles asynchronously on first use, Bind draws with the fallback until the variant links */
+Shader*           __namespace( Get )          ( ShaderVariantSet* set, ShaderFeatureMask mask );
+
+/* Polls the pending variants of every registered set, returns how many are still compiling */
+u32               __namespace( Poll )         ( void );
+
+/* Rereads the sources of every set loaded from path and reloads each variant it has built */
+u32               __namespace( ReloadFile )   ( const char* path );
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __shader_variant_h__ */
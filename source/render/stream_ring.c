@@ -0,0 +1,207 @@
+// stream_ring.c
+#include "stream_ring.h"
+
+#include <core/debug.h>
+#include <core/arena.h>
+#include <string.h>
+
+#ifdef GLX_OPENGL
+    #include <glad/glad.h>
+    #include <render/gl_state.h>
+#elif defined(GLX_VULKAN)
+    #include <platform/glx/vulkan/helpers.h>
+#endif
+
+#define __namespace(func_name) renderer_StreamRing##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define STREAM_RING_FENCE_TIMEOUT 1000000000ull     /* ns per wait, retried while the GPU is still busy */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Backend
+
+#ifdef GLX_OPENGL
+
+static u8 BackendCreate(StreamRing* ring, BufferType type)
+{
+    ring->glName = renderer_ResourceBufferGet(ring->buffer)->glName;
+    ring->target = renderer_ResourceBufferTarget(type);
+    return True;
+}
+
+static void BackendDestroy(StreamRing* ring)
+{
+    for (u32 i = 0; i < STREAM_RING_FRAMES_IN_FLIGHT; i++) {
+        if (ring->fences[i]) glDeleteSync((GLsync)ring->fences[i]);
+        ring->fences[i] = NULL;
+    }
+    ring->staging = NULL;
+}
+
+static void WaitSegment(StreamRing* ring)
+{
+    GLsync fence = (GLsync)ring->fences[ring->segment];
+    if (!fence) return;
+
+    GLenum status;
+    do {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_RING_FENCE_TIMEOUT);
+    } while (status == GL_TIMEOUT_EXPIRED);
+
+    if (status == GL_WAIT_FAILED)
+        LOG_WARN("%s: waiting on segment %u failed", ring->name, ring->segment);
+
+    glDeleteSync(fence);
+    ring->fences[ring->segment] = NULL;
+}
+
+/* The staging copy only lives until the segment is uploaded, so it comes from the frame arena */
+static void BeginSegment(StreamRing* ring)
+{
+    ring->staging = (u8*)core_ArenaFrameAlloc(ring->segmentSize, ARENA_DEFAULT_ALIGN);
+    WaitSegment(ring);
+}
+
+static void EndSegment(StreamRing* ring)
+{
+    ring->fences[ring->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+static inline u8* SegmentData(const StreamRing* ring)
+{
+    return ring->staging;
+}
+
+/* The segment is fenced, so the driver does not need to synchronize the write */
+static void UploadRange(StreamRing* ring, u32 offset, u32 size)
+{
+    GLintptr    bufferOffset = (GLintptr)(renderer_StreamRingBase(ring) + offset);
+    const void* data         = ring->staging + offset;
+
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+
+    /* Written by name when available, the binding of the target is left alone */
+    if (renderer_ResourceDirectStateAccess()) {
+        void* mapped = glMapNamedBufferRange(ring->glName, bufferOffset, (GLsizeiptr)size, access);
+        if (mapped) {
+            memcpy(mapped, data, size);
+            glUnmapNamedBuffer(ring->glName);
+        } else {
+            glNamedBufferSubData(ring->glName, bufferOffset, (GLsizeiptr)size, data);
+        }
+    } else {
+        renderer_GlStateBindBuffer(ring->target, ring->glName);
+        void* mapped = glMapBufferRange(ring->target, bufferOffset, (GLsizeiptr)size, access);
+        if (mapped) {
+            memcpy(mapped, data, size);
+            glUnmapBuffer(ring->target);
+        } else {
+            glBufferSubData(ring->target, bufferOffset, (GLsizeiptr)size, data);
+        }
+    }
+}
+
+#elif defined(GLX_VULKAN)
+
+static u8 BackendCreate(StreamRing* ring, BufferType type)
+{
+    UNUSED(type);
+
+    const BufferResource* buffer = renderer_ResourceBufferGet(ring->buffer);
+    return vkMapMemory(vk_get_device(), buffer->memory, 0, buffer->size, 0, (void**)&ring->mapped) == VK_SUCCESS;
+}
+
+static void BackendDestroy(StreamRing* ring)
+{
+    const BufferResource* buffer = renderer_ResourceBufferGet(ring->buffer);
+    if (ring->mapped && buffer) vkUnmapMemory(vk_get_device(), buffer->memory);
+    ring->mapped = NULL;
+}
+
+/* The frame fence in the caller already keeps the GPU within STREAM_RING_FRAMES_IN_FLIGHT frames */
+static void BeginSegment(StreamRing* ring)
+{
+    UNUSED(ring);
+}
+
+static void EndSegment(StreamRing* ring)
+{
+    UNUSED(ring);
+}
+
+/* Host coherent and persistently mapped, writes land directly */
+static inline u8* SegmentData(const StreamRing* ring)
+{
+    return ring->mapped + renderer_StreamRingBase(ring);
+}
+
+static void UploadRange(StreamRing* ring, u32 offset, u32 size)
+{
+    UNUSED(ring);
+    UNUSED(offset);
+    UNUSED(size);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace(Create)(StreamRing* ring, const char* name, BufferType type, u32 segmentSize)
+{
+    memset(ring, 0, sizeof(*ring));
+    if (!segmentSize) return False;
+
+    ring->name        = name;
+    ring->segmentSize = segmentSize;
+    ring->buffer      = renderer_ResourceBufferCreate(type, NULL,
+        (usize)segmentSize * STREAM_RING_FRAMES_IN_FLIGHT);
+
+    if (RESOURCE_HANDLE_IS_NULL(ring->buffer) || !BackendCreate(ring, type)) {
+        __namespace(Destroy)(ring);
+        return False;
+    }
+
+    /* The first Begin moves to segment 0 */
+    ring->segment = STREAM_RING_FRAMES_IN_FLIGHT - 1;
+    return True;
+}
+
+void __namespace(Destroy)(StreamRing* ring)
+{
+    if (RESOURCE_HANDLE_IS_NULL(ring->buffer)) return;
+
+    BackendDestroy(ring);
+    renderer_ResourceBufferDestroy(ring->buffer);
+    memset(ring, 0, sizeof(*ring));
+}
+
+void __namespace(Begin)(StreamRing* ring)
+{
+    ring->segment = (ring->segment + 1) % STREAM_RING_FRAMES_IN_FLIGHT;
+    BeginSegment(ring);
+}
+
+void __namespace(End)(StreamRing* ring)
+{
+    EndSegment(ring);
+}
+
+u32 __namespace(Base)(const StreamRing* ring)
+{
+    return ring->segment * ring->segmentSize;
+}
+
+u8* __namespace(Data)(const StreamRing* ring)
+{
+    return SegmentData(ring);
+}
+
+void __namespace(Upload)(StreamRing* ring, u32 offset, u32 size)
+{
+    if (size) UploadRange(ring, offset, size);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
@@ -0,0 +1,61 @@
+#ifndef __stream_ring_h__
+#define __stream_ring_h__
+
+#include <core/types.h>
+#include <render/resource.h>
+
+#define __namespace( func_name ) renderer##_##StreamRing##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A buffer rewritten every frame, split into STREAM_RING_FRAMES_IN_FLIGHT segments so the CPU fills one while the GPU
+ * still reads the others. Begin moves to the next segment and waits only if the GPU has not finished with it yet,
+ * End fences the segment once its draws are submitted.
+ *
+ * Data points at the CPU side of the current segment. On GL that is a staging copy taken from the frame arena at
+ * Begin and Upload moves a range of it into the buffer, on Vulkan the buffer is persistently mapped and Upload does
+ * nothing. Begin has to run after core_ArenaFrameBegin.
+ */
+#define STREAM_RING_FRAMES_IN_FLIGHT 3
+
+typedef struct
+{
+    const char*  name;          /* prefix of the log messages */
+    BufferHandle buffer;
+    u32          segmentSize;
+    u32          segment;
+
+    #ifdef GLX_OPENGL
+    u32          glName;
+    u32          target;
+    u8*          staging;       /* frame arena, valid from Begin to the end of the frame */
+    void*        fences[STREAM_RING_FRAMES_IN_FLIGHT];   /* GLsync, opaque so the header stays free of GL */
+    #elif defined(GLX_VULKAN)
+    u8*          mapped;
+    #endif
+} StreamRing;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/* Leaves the ring zeroed on failure, Destroy is safe either way */
+u8     __namespace( Create )  ( StreamRing* ring, const char* name, BufferType type, u32 segmentSize );
+void   __namespace( Destroy ) ( StreamRing* ring );
+
+void   __namespace( Begin )   ( StreamRing* ring );
+void   __namespace( End )     ( StreamRing* ring );
+
+/* Byte offset of the current segment in the buffer */
+u32    __namespace( Base )    ( const StreamRing* ring );
+u8*    __namespace( Data )    ( const StreamRing* ring );
+
+/* offset is relative to the current segment */
+void   __namespace( Upload )  ( StreamRing* ring, u32 offset, u32 size );
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __stream_ring_h__ */
@@ -0,0 +1,355 @@
+// ubo.c
+#include "ubo.h"
+
+#include <core/debug.h>
+#include <render/resource.h>
+#include <string.h>
+
+#ifdef GLX_OPENGL
+    #include <glad/glad.h>
+    #include <render/gl_state.h>
+#elif defined(GLX_VULKAN)
+    #include <platform/glx/vulkan/helpers.h>
+#endif
+
+#define __namespace(func_name) renderer_Ubo##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+STATIC_ASSERT(sizeof(FrameBlock)  == 16,  frame_block_matches_std140);
+STATIC_ASSERT(sizeof(ViewBlock)   == 208, view_block_matches_std140);
+STATIC_ASSERT(sizeof(ObjectBlock) == 208, object_block_matches_std140);
+
+/*
+ * Each ring segment is laid out as [FrameBlock][ViewBlock][ObjectBlock * UBO_MAX_OBJECTS_PER_FRAME], every block at
+ * the device offset alignment.
+ */
+static struct
+{
+    StreamRing   ring;
+    u32          align;
+    u32          objectStride;
+    u32          viewOffset;
+    u32          objectsOffset;
+    u32          objectCount;
+    u32          boundObject;
+    u32          dirtyBegin;    /* written since the last upload, relative to the segment */
+    u32          dirtyEnd;
+    u8           warnedFull;
+    u8           initialized;
+
+    #ifdef GLX_VULKAN
+    VkDescriptorSetLayout setLayout;
+    VkDescriptorPool      descriptorPool;
+    VkDescriptorSet       descriptorSet;
+    VkCommandBuffer       commandBuffer;
+    VkPipelineLayout      pipelineLayout;
+    #endif
+} ubo = {0};
+
+static const u32 blockSizes[UBO_BINDING_COUNT] = { sizeof(FrameBlock), sizeof(ViewBlock), sizeof(ObjectBlock) };
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline u32 AlignUp(u32 value, u32 align)
+{
+    return (value + align - 1) / align * align;
+}
+
+static inline u32 SegmentBase(void)
+{
+    return renderer_StreamRingBase(&ubo.ring);
+}
+
+static void Write(u32 offset, const void* data, u32 size)
+{
+    memcpy(renderer_StreamRingData(&ubo.ring) + offset, data, size);
+    if (ubo.dirtyBegin >= ubo.dirtyEnd) {
+        ubo.dirtyBegin = offset;
+        ubo.dirtyEnd   = offset + size;
+    } else {
+        ubo.dirtyBegin = MIN(ubo.dirtyBegin, offset);
+        ubo.dirtyEnd   = MAX(ubo.dirtyEnd, offset + size);
+    }
+}
+
+static void Upload(void)
+{
+    if (ubo.dirtyBegin >= ubo.dirtyEnd) return;
+
+    renderer_StreamRingUpload(&ubo.ring, ubo.dirtyBegin, ubo.dirtyEnd - ubo.dirtyBegin);
+    ubo.dirtyBegin = ubo.dirtyEnd = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Backend
+
+#ifdef GLX_OPENGL
+
+static u8 BackendInit(void)
+{
+    if (!GLAD_GL_VERSION_3_2 && !(GLAD_GL_ARB_uniform_buffer_object && GLAD_GL_ARB_sync)) {
+        LOG_WARN("UBO: uniform buffers or sync objects not supported");
+        return False;
+    }
+
+    GLint align = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    ubo.align = align > 0 ? (u32)align : 256;
+    return True;
+}
+
+static u8 BackendCreate(void)
+{
+    return True;
+}
+
+static void BackendDestroy(void) {}
+
+static void BindShared(void)
+{
+    renderer_GlStateBindBufferRange(GL_UNIFORM_BUFFER, UBO_BINDING_FRAME, ubo.ring.glName,
+        SegmentBase(), sizeof(FrameBlock));
+    renderer_GlStateBindBufferRange(GL_UNIFORM_BUFFER, UBO_BINDING_VIEW, ubo.ring.glName,
+        SegmentBase() + ubo.viewOffset, sizeof(ViewBlock));
+}
+
+static void BindObjectRange(u32 offset)
+{
+    renderer_GlStateBindBufferRange(GL_UNIFORM_BUFFER, UBO_BINDING_OBJECT, ubo.ring.glName, offset,
+        sizeof(ObjectBlock));
+}
+
+#elif defined(GLX_VULKAN)
+
+static u8 BackendInit(void)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(vk_get_physical_device(), &properties);
+    ubo.align = (u32)MAX(properties.limits.minUniformBufferOffsetAlignment, 16);
+    return True;
+}
+
+/* Every block is a dynamic uniform buffer over the same VkBuffer, the offsets pick the segment and the object */
+static u8 BackendCreate(void)
+{
+    VkDevice device = vk_get_device();
+    const BufferResource* buffer = renderer_ResourceBufferGet(ubo.ring.buffer);
+
+    VkDescriptorSetLayoutBinding bindings[UBO_BINDING_COUNT];
+    for (u32 i = 0; i < UBO_BINDING_COUNT; i++) {
+        bindings[i] = (VkDescriptorSetLayoutBinding){
+            .binding         = i,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        };
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = UBO_BINDING_COUNT,
+        .pBindings    = bindings,
+    };
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, NULL, &ubo.setLayout) != VK_SUCCESS)
+        return False;
+
+    VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, UBO_BINDING_COUNT };
+    VkDescriptorPoolCreateInfo poolInfo = {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets       = 1,
+        .poolSizeCount = 1,
+        .pPoolSizes    = &poolSize,
+    };
+    if (vkCreateDescriptorPool(device, &poolInfo, NULL, &ubo.descriptorPool) != VK_SUCCESS)
+        return False;
+
+    VkDescriptorSetAllocateInfo allocInfo = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = ubo.descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &ubo.setLayout,
+    };
+    if (vkAllocateDescriptorSets(device, &allocInfo, &ubo.descriptorSet) != VK_SUCCESS)
+        return False;
+
+    VkDescriptorBufferInfo infos[UBO_BINDING_COUNT];
+    VkWriteDescriptorSet   writes[UBO_BINDING_COUNT];
+    for (u32 i = 0; i < UBO_BINDING_COUNT; i++) {
+        infos[i]  = (VkDescriptorBufferInfo){ buffer->buffer, 0, blockSizes[i] };
+        writes[i] = (VkWriteDescriptorSet){
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = ubo.descriptorSet,
+            .dstBinding      = i,
+            .descriptorCount = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .pBufferInfo     = &infos[i],
+        };
+    }
+    vkUpdateDescriptorSets(device, UBO_BINDING_COUNT, writes, 0, NULL);
+    return True;
+}
+
+static void BackendDestroy(void)
+{
+    VkDevice device = vk_get_device();
+
+    if (ubo.descriptorPool) vkDestroyDescriptorPool(device, ubo.descriptorPool, NULL);
+    if (ubo.setLayout) vkDestroyDescriptorSetLayout(device, ubo.setLayout, NULL);
+
+    ubo.descriptorPool = VK_NULL_HANDLE;
+    ubo.setLayout      = VK_NULL_HANDLE;
+    ubo.descriptorSet  = VK_NULL_HANDLE;
+}
+
+static void BindShared(void) {}
+
+static void BindObjectRange(u32 offset)
+{
+    if (!ubo.commandBuffer || !ubo.pipelineLayout) return;
+
+    u32 offsets[UBO_BINDING_COUNT] = { SegmentBase(), SegmentBase() + ubo.viewOffset, offset };
+    vkCmdBindDescriptorSets(ubo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, ubo.pipelineLayout,
+        0, 1, &ubo.descriptorSet, UBO_BINDING_COUNT, offsets);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8 __namespace(Init)(void)
+{
+    if (ubo.initialized) return True;
+    if (!BackendInit()) return False;
+
+    ubo.objectStride  = AlignUp(sizeof(ObjectBlock), ubo.align);
+    ubo.viewOffset    = AlignUp(sizeof(FrameBlock), ubo.align);
+    ubo.objectsOffset = ubo.viewOffset + AlignUp(sizeof(ViewBlock), ubo.align);
+
+    u32 segmentSize = AlignUp(ubo.objectsOffset + ubo.objectStride * UBO_MAX_OBJECTS_PER_FRAME, ubo.align);
+
+    if (!renderer_StreamRingCreate(&ubo.ring, "UBO", BUFFER_TYPE_UNIFORM, segmentSize) || !BackendCreate()) {
+        LOG_ERROR("UBO: failed to create the %u byte uniform ring", segmentSize * UBO_FRAMES_IN_FLIGHT);
+        BackendDestroy();
+        renderer_StreamRingDestroy(&ubo.ring);
+        return False;
+    }
+
+    ubo.boundObject = UBO_OBJECT_INVALID;
+    ubo.initialized = True;
+
+    LOG_INFO("UBO: %u segments of %u bytes, %u byte alignment", UBO_FRAMES_IN_FLIGHT, segmentSize, ubo.align);
+    return True;
+}
+
+void __namespace(Shutdown)(void)
+{
+    if (!ubo.initialized) return;
+
+    BackendDestroy();
+    renderer_StreamRingDestroy(&ubo.ring);
+    memset(&ubo, 0, sizeof(ubo));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void __namespace(BeginFrame)(const FrameBlock* frame)
+{
+    if (!ubo.initialized) return;
+
+    renderer_StreamRingBegin(&ubo.ring);
+
+    ubo.objectCount = 0;
+    ubo.boundObject = UBO_OBJECT_INVALID;
+    ubo.warnedFull  = False;
+
+    if (frame) Write(0, frame, sizeof(*frame));
+    BindShared();
+}
+
+void __namespace(EndFrame)(void)
+{
+    if (!ubo.initialized) return;
+
+    Upload();
+    renderer_StreamRingEnd(&ubo.ring);
+}
+
+void __namespace(SetView)(const ViewBlock* view)
+{
+    if (!ubo.initialized || !view) return;
+    Write(ubo.viewOffset, view, sizeof(*view));
+}
+
+u32 __namespace(PushObject)(const ObjectBlock* object)
+{
+    if (!ubo.initialized || !object) return UBO_OBJECT_INVALID;
+
+    if (ubo.objectCount == UBO_MAX_OBJECTS_PER_FRAME) {
+        if (!ubo.warnedFull)
+            LOG_WARN("UBO: more than %u objects this frame, extra draws keep the last bound object",
+                UBO_MAX_OBJECTS_PER_FRAME);
+        ubo.warnedFull = True;
+        return UBO_OBJECT_INVALID;
+    }
+
+    u32 local = ubo.objectsOffset + ubo.objectCount++ * ubo.objectStride;
+    Write(local, object, sizeof(*object));
+    return SegmentBase() + local;
+}
+
+void __namespace(Flush)(void)
+{
+    if (ubo.initialized) Upload();
+}
+
+void __namespace(BindObject)(u32 offset)
+{
+    if (!ubo.initialized || offset == UBO_OBJECT_INVALID || offset == ubo.boundObject) return;
+
+    Upload();
+    BindObjectRange(offset);
+    ubo.boundObject = offset;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef GLX_OPENGL
+
+static const char* blockNames[UBO_BINDING_COUNT] = { "FrameBlock", "ViewBlock", "ObjectBlock" };
+
+void __namespace(BindProgramBlocks)(u32 program)
+{
+    for (u32 binding = 0; binding < UBO_BINDING_COUNT; binding++) {
+        u32 index = glGetUniformBlockIndex(program, blockNames[binding]);
+        if (index == GL_INVALID_INDEX) continue;
+
+        GLint size = 0;
+        glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+        if ((u32)size > blockSizes[binding])
+            LOG_WARN("UBO: block '%s' is %d bytes in the shader but %u on the CPU",
+                blockNames[binding], size, blockSizes[binding]);
+
+        glUniformBlockBinding(program, index, binding);
+    }
+}
+
+#elif defined(GLX_VULKAN)
+
+VkDescriptorSetLayout __namespace(GetDescriptorSetLayout)(void)
+{
+    return ubo.setLayout;
+}
+
+void __namespace(SetCommandBuffer)(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+{
+    ubo.commandBuffer  = commandBuffer;
+    ubo.pipelineLayout = pipelineLayout;
+    ubo.boundObject    = UBO_OBJECT_INVALID;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
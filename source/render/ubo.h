@@ -0,0 +1,91 @@
+#ifndef __ubo_h__
+#define __ubo_h__
+
+#include <core/types.h>
+#include <core/math.h>
+#include <render/stream_ring.h>
+
+#ifdef GLX_VULKAN
+    #include <vulkan/vulkan.h>
+#endif
+
+#define __namespace( func_name ) renderer##_##Ubo##func_name
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Binding points shared by GL and Vulkan. GLSL declares the blocks with layout(std140, binding = N), on Vulkan the
+ * three bindings live in descriptor set 0 as dynamic uniform buffers so one shader source serves both backends.
+ */
+#define UBO_BINDING_FRAME  0
+#define UBO_BINDING_VIEW   1
+#define UBO_BINDING_OBJECT 2
+#define UBO_BINDING_COUNT  3
+
+#define UBO_FRAMES_IN_FLIGHT      STREAM_RING_FRAMES_IN_FLIGHT
+#define UBO_MAX_OBJECTS_PER_FRAME 1024
+#define UBO_OBJECT_INVALID        0xFFFFFFFFu
+
+/* std140 layouts, must match the GLSL blocks. vec3 members are padded out to a Vec4 */
+typedef struct
+{
+    f32 time;
+    f32 deltaTime;
+    u32 frameIndex;
+    u32 _pad0;
+} FrameBlock;
+
+typedef struct
+{
+    Mat4 view;
+    Mat4 projection;
+    Mat4 viewProjection;
+    Vec4 cameraPos;
+} ViewBlock;
+
+typedef struct
+{
+    Mat4 model;
+    Mat4 mvp;
+    Mat4 normalMatrix;
+    Vec4 color;
+} ObjectBlock;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+u8   __namespace( Init )       ( void );
+void __namespace( Shutdown )   ( void );
+
+/* Moves to the next ring segment, waits only if the GPU still reads it from UBO_FRAMES_IN_FLIGHT frames ago */
+void __namespace( BeginFrame ) ( const FrameBlock* frame );
+void __namespace( EndFrame )   ( void );
+
+void __namespace( SetView )    ( const ViewBlock* view );
+
+/* Copies the block into this frame's segment, returns its offset or UBO_OBJECT_INVALID when the segment is full */
+u32  __namespace( PushObject ) ( const ObjectBlock* object );
+
+/* Uploads everything written since the last flush in one call, BindObject flushes on its own when needed */
+void __namespace( Flush )      ( void );
+
+/* One ranged bind per draw, repeated binds of the same offset are dropped */
+void __namespace( BindObject ) ( u32 offset );
+
+#ifdef GLX_OPENGL
+/* Points the known blocks of a linked program at the shared binding points, for GLSL without binding qualifiers */
+void __namespace( BindProgramBlocks ) ( u32 program );
+#elif defined(GLX_VULKAN)
+/* Set 0 of every pipeline layout that reads the shared blocks */
+VkDescriptorSetLayout __namespace( GetDescriptorSetLayout ) ( void );
+
+/* BindObject records into this command buffer against this pipeline layout */
+void __namespace( SetCommandBuffer ) ( VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout );
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#undef __namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#endif /* __ubo_h__ */